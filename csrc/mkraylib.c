@@ -0,0 +1,1224 @@
+/* @(#) mkraylib.c 2026-10-19 */
+/***************************************************************
+** Generate the pForth words for raylib from "raylib.h".
+**
+**     mkraylib path/to/raylib.h > pf_raylib_api.h
+**
+** The output is included several times, with one of these
+** defined to select a part:
+**
+**     PF_RAYLIB_TYPES    - resource types for "pf_raylib.h"
+**     PF_RAYLIB_IDS      - primitive IDs for "pf_guts.h"
+**     PF_RAYLIB_ENTRIES  - dictionary entries for "pfcompil.c"
+**     PF_RAYLIB_CASES    - cases for pfCatch() in "pf_inner.c"
+**
+** PF_RAYLIB_API_HASH is always defined. It is a hash of the names
+** and types of the functions, in order, so it changes whenever the
+** primitive IDs or their stack effects change. It is saved in the
+** dictionary, see "pf_save.c".
+**
+** Every RLAPI function becomes a word with the same name in
+** Forth style, so DrawCircleV is DRAW-CIRCLE-V. Every enum value
+** becomes a constant with the C name. Parameters are passed like this:
+**
+**     int, unsigned, enum   - one cell
+**     bool                  - flag, returned as TRUE or FALSE
+**     float, double         - FP stack
+**     const char *          - c-addr u, returned as c-addr u
+**     other pointers        - address
+**     Color                 - r g b a, the fields as cells
+**     Vector2, Rectangle    - the fields on the FP stack
+**     resources             - handle, see below
+**     other structs         - address of the struct
+**
+** A struct that has a function "void UnloadName(Name x)" is a
+** resource, like Image, Texture2D, Font, Shader or Sound. They are
+** kept in handle tables, see "pf_raylib.h", and Forth gets a
+** handle. A pointer to a resource is passed as a handle too, unless
+** it is an array followed by a count. The Unload function makes the
+** handle invalid. Using an invalid handle THROWs THROW_RAYLIB_HANDLE.
+**
+** Any other struct returned by address is in memory from ALLOCATE.
+** Use FREE when it is no longer needed.
+** Functions with callbacks or variable arguments are left out.
+** So are names too long for the dictionary.
+**
+** Permission to use, copy, modify, and/or distribute this
+** software for any purpose with or without fee is hereby granted.
+**
+** THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+** WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+** THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+** CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+** FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+** CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+** OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**
+***************************************************************/
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Must match MASK_NAME_SIZE in "pf_guts.h". */
+#define MAX_FORTH_NAME   (31)
+/* Must match PF_RAYLIB_MAX_STRINGS in "pf_raylib.h". */
+#define MAX_STRINGS      (4)
+
+#define MAX_NAME         (64)
+#define MAX_TYPE         (128)
+#define MAX_PARAMS       (16)
+#define MAX_FIELDS       (4)
+#define MAX_LINE         (256)
+
+/* How a value is passed. */
+typedef enum
+{
+    K_BAD,       /* Not supported. */
+    K_VOID,
+    K_INT,
+    K_BOOL,
+    K_FLOAT,
+    K_POINTER,
+    K_STRING,    /* c-addr u */
+    K_BYTES,     /* Struct of up to 4 unsigned chars, as cells. */
+    K_FLOATS,    /* Struct of up to 4 floats, on the FP stack. */
+    K_STRUCT     /* Address of a struct. */
+} Kind;
+
+typedef struct
+{
+    char  Name[MAX_NAME];
+    int   NumFields;
+    char  Fields[MAX_FIELDS][MAX_NAME];
+    Kind  StructKind;  /* K_BYTES, K_FLOATS, K_STRUCT or K_BAD if opaque. */
+    int   IsResource;
+    int   ResourceType;
+} StructInfo;
+
+typedef struct
+{
+    char  Name[MAX_NAME];
+    char  Type[MAX_TYPE];   /* C type as written, "const char *" */
+    char  Base[MAX_TYPE];   /* Without const and stars, "char" */
+    int   Stars;
+    int   IsConst;
+    Kind  ValueKind;
+    const StructInfo *Struct;
+    int   IsHandle;         /* Resource passed as a handle. */
+} Value;
+
+typedef struct
+{
+    char   Name[MAX_NAME];
+    char   ForthName[2 * MAX_NAME];
+    Value  Result;
+    int    NumParams;
+    Value  Params[MAX_PARAMS];
+    int    UsesFloat;
+    int    Unloads;         /* Makes the handle in Params[0] invalid. */
+} Function;
+
+typedef struct
+{
+    char  Name[MAX_NAME];
+    long  Number;
+} Constant;
+
+/* A growable array. */
+typedef struct
+{
+    void *Data;
+    int   Count;
+    int   Max;
+    int   Size;
+} List;
+
+static List gTokens    = { NULL, 0, 0, sizeof(char *) };
+static List gStructs   = { NULL, 0, 0, sizeof(StructInfo) };
+static List gAliases   = { NULL, 0, 0, 2 * MAX_NAME };
+static List gNames     = { NULL, 0, 0, MAX_NAME };  /* Enums, passed as int. */
+static List gFunctions = { NULL, 0, 0, sizeof(Function) };
+static List gConstants = { NULL, 0, 0, sizeof(Constant) };
+static List gSkipped   = { NULL, 0, 0, MAX_LINE };
+static int  gNumResources;
+
+/***************************************************************/
+static void *ListAdd( List *list )
+{
+    char *item;
+    if( list->Count == list->Max )
+    {
+        list->Max = (list->Max == 0) ? 64 : list->Max * 2;
+        list->Data = realloc( list->Data, (size_t) list->Max * (size_t) list->Size );
+        if( list->Data == NULL )
+        {
+            fprintf( stderr, "mkraylib: out of memory\n" );
+            exit( 1 );
+        }
+    }
+    item = (char *) list->Data + (size_t) list->Count++ * (size_t) list->Size;
+    memset( item, 0, (size_t) list->Size );
+    return item;
+}
+
+#define LIST_AT(list,type,i)  (((type *) (list).Data)[i])
+
+static const char *Tok( int i )
+{
+    return (i < gTokens.Count) ? LIST_AT(gTokens, char *, i) : "";
+}
+
+static int IsTok( int i, const char *s )
+{
+    return strcmp( Tok( i ), s ) == 0;
+}
+
+static int IsIdent( const char *s )
+{
+    return isalpha( (unsigned char) *s ) || (*s == '_');
+}
+
+static void CopyName( char *dst, const char *src, size_t size )
+{
+    size_t len = strlen( src );
+    if( len >= size ) len = size - 1;
+    memcpy( dst, src, len );
+    dst[len] = '\0';
+}
+
+static void AddName( List *list, const char *Name )
+{
+    CopyName( (char *) ListAdd( list ), Name, MAX_NAME );
+}
+
+static int HasName( const List *list, const char *Name )
+{
+    int i;
+    for( i = 0; i < list->Count; i++ )
+    {
+        if( strcmp( (const char *) list->Data + (size_t) i * (size_t) list->Size, Name ) == 0 ) return 1;
+    }
+    return 0;
+}
+
+/***************************************************************
+** Split the header into tokens. Comments and preprocessor lines
+** are dropped, so both sides of #if are seen.
+*/
+static void AddToken( const char *Start, size_t Len )
+{
+    char *t = (char *) malloc( Len + 1 );
+    if( t == NULL )
+    {
+        fprintf( stderr, "mkraylib: out of memory\n" );
+        exit( 1 );
+    }
+    memcpy( t, Start, Len );
+    t[Len] = '\0';
+    *(char **) ListAdd( &gTokens ) = t;
+}
+
+static void Tokenize( const char *p )
+{
+    int lineStart = 1;
+    while( *p )
+    {
+        const char *start = p;
+        if( *p == '\n' )
+        {
+            lineStart = 1;
+            p++;
+            continue;
+        }
+        if( isspace( (unsigned char) *p ) )
+        {
+            p++;
+            continue;
+        }
+        if( lineStart && *p == '#' )
+        {
+            while( *p && *p != '\n' )
+            {
+                if( p[0] == '\\' && p[1] == '\n' ) p++;
+                else if( p[0] == '/' && p[1] == '*' ) break;
+                p++;
+            }
+            if( *p == '/' ) lineStart = 0;
+            continue;
+        }
+        lineStart = 0;
+        if( p[0] == '/' && p[1] == '/' )
+        {
+            while( *p && *p != '\n' ) p++;
+        }
+        else if( p[0] == '/' && p[1] == '*' )
+        {
+            p += 2;
+            while( *p && !(p[0] == '*' && p[1] == '/') ) p++;
+            if( *p ) p += 2;
+        }
+        else if( *p == '"' || *p == '\'' )
+        {
+            char quote = *p++;
+            while( *p && *p != quote )
+            {
+                if( *p == '\\' && p[1] ) p++;
+                p++;
+            }
+            if( *p ) p++;
+            AddToken( start, (size_t) (p - start) );
+        }
+        else if( isalnum( (unsigned char) *p ) || *p == '_' )
+        {
+            while( isalnum( (unsigned char) *p ) || *p == '_' ) p++;
+            AddToken( start, (size_t) (p - start) );
+        }
+        else if( strncmp( p, "...", 3 ) == 0 )
+        {
+            p += 3;
+            AddToken( start, 3 );
+        }
+        else
+        {
+            p++;
+            AddToken( start, 1 );
+        }
+    }
+}
+
+/***************************************************************
+** Types.
+*/
+static StructInfo *FindStruct( const char *Name )
+{
+    int i;
+    for( i = 0; i < gStructs.Count; i++ )
+    {
+        if( strcmp( LIST_AT(gStructs, StructInfo, i).Name, Name ) == 0 )
+        {
+            return &LIST_AT(gStructs, StructInfo, i);
+        }
+    }
+    return NULL;
+}
+
+/* Follow typedef Texture Texture2D; */
+static const char *ResolveAlias( const char *Name )
+{
+    int i, depth;
+    for( depth = 0; depth < 8; depth++ )
+    {
+        for( i = 0; i < gAliases.Count; i++ )
+        {
+            const char *alias = (const char *) gAliases.Data + (size_t) i * (size_t) gAliases.Size;
+            if( strcmp( alias, Name ) == 0 )
+            {
+                Name = alias + MAX_NAME;
+                break;
+            }
+        }
+        if( i == gAliases.Count ) break;
+    }
+    return Name;
+}
+
+static int IsIntegerType( const char *Base )
+{
+    static const char *words[] = { "unsigned", "signed", "int", "long", "short", "char", NULL };
+    char buf[MAX_TYPE];
+    char *w;
+    CopyName( buf, Base, sizeof(buf) );
+    for( w = strtok( buf, " " ); w != NULL; w = strtok( NULL, " " ) )
+    {
+        int i;
+        for( i = 0; words[i] != NULL; i++ )
+        {
+            if( strcmp( w, words[i] ) == 0 ) break;
+        }
+        if( words[i] == NULL ) return 0;
+    }
+    return 1;
+}
+
+static Kind ClassifyValue( Value *v, int IsResult )
+{
+    const char *base = ResolveAlias( v->Base );
+
+    v->Struct = NULL;
+    if( v->Stars > 0 )
+    {
+        if( (v->Stars == 1) && (strcmp( base, "char" ) == 0) && (IsResult || v->IsConst) )
+        {
+            return K_STRING;
+        }
+        return K_POINTER;
+    }
+    if( strcmp( base, "void" ) == 0 ) return IsResult ? K_VOID : K_BAD;
+    if( strcmp( base, "bool" ) == 0 ) return K_BOOL;
+    if( (strcmp( base, "float" ) == 0) || (strcmp( base, "double" ) == 0) ) return K_FLOAT;
+    if( IsIntegerType( base ) ) return K_INT;
+    if( HasName( &gNames, base ) ) return K_INT;
+    v->Struct = FindStruct( base );
+    if( v->Struct != NULL ) return v->Struct->StructKind;
+    return K_BAD;
+}
+
+/* Parse "const unsigned char *data" in tokens [First,Last). */
+static int ParseValue( int First, int Last, Value *v, int WithName )
+{
+    int i;
+    if( WithName )
+    {
+        if( (Last <= First) || !IsIdent( Tok( Last - 1 ) ) ) return -1;
+        CopyName( v->Name, Tok( Last - 1 ), sizeof(v->Name) );
+        Last--;
+    }
+    for( i = First; i < Last; i++ )
+    {
+        const char *t = Tok( i );
+        if( strcmp( t, "*" ) == 0 )
+        {
+            v->Stars++;
+        }
+        else if( !IsIdent( t ) )
+        {
+            return -1;
+        }
+        else if( strcmp( t, "const" ) == 0 )
+        {
+            if( v->Stars == 0 ) v->IsConst = 1;
+        }
+        else if( v->Stars == 0 )
+        {
+            if( v->Base[0] ) strcat( v->Base, " " );
+            strncat( v->Base, t, sizeof(v->Base) - strlen( v->Base ) - 1 );
+        }
+        if( strcmp( t, "*" ) == 0 )
+        {
+            strcat( v->Type, "*" );
+        }
+        else
+        {
+            if( v->Type[0] ) strcat( v->Type, " " );
+            strncat( v->Type, t, sizeof(v->Type) - strlen( v->Type ) - 3 );
+        }
+    }
+    /* "char *" rather than "char*" */
+    {
+        char *star = strchr( v->Type, '*' );
+        if( star != NULL && star > v->Type && star[-1] != ' ' )
+        {
+            memmove( star + 1, star, strlen( star ) + 1 );
+            *star = ' ';
+        }
+    }
+    return (v->Base[0] != '\0') ? 0 : -1;
+}
+
+/***************************************************************
+** Declarations.
+*/
+
+/* typedef struct Name { fields } Name; */
+static int ParseStruct( int i )
+{
+    StructInfo *s;
+    int numFloats = 0, numBytes = 0, numOther = 0;
+
+    s = (StructInfo *) ListAdd( &gStructs );
+    CopyName( s->Name, Tok( i ), sizeof(s->Name) );
+    if( IsTok( i + 1, ";" ) || IsTok( i + 2, ";" ) )
+    {
+        s->StructKind = K_BAD;    /* Opaque, only used by pointer. */
+        return i + 1;
+    }
+    i += 2;
+    while( (i < gTokens.Count) && !IsTok( i, "}" ) )
+    {
+        /* One line of fields, "float m0, m4, m8, m12;" */
+        int start = i, simple = 1, names = 0, typeEnd = -1;
+        char type[MAX_TYPE] = "";
+        while( (i < gTokens.Count) && !IsTok( i, ";" ) )
+        {
+            if( !IsIdent( Tok( i ) ) && !IsTok( i, "," ) ) simple = 0;
+            if( (typeEnd < 0) && (IsTok( i + 1, "," ) || IsTok( i + 1, ";" )) ) typeEnd = i;
+            if( IsTok( i, "," ) ) names++;
+            i++;
+        }
+        names++;
+        if( simple && (typeEnd > start) )
+        {
+            int k;
+            for( k = start; k < typeEnd; k++ )
+            {
+                if( type[0] ) strcat( type, " " );
+                strncat( type, Tok( k ), sizeof(type) - strlen( type ) - 1 );
+            }
+            for( k = typeEnd; k < i; k += 2 )
+            {
+                if( s->NumFields < MAX_FIELDS ) CopyName( s->Fields[s->NumFields], Tok( k ), MAX_NAME );
+                s->NumFields++;
+            }
+            if( strcmp( type, "float" ) == 0 ) numFloats += names;
+            else if( strcmp( type, "unsigned char" ) == 0 ) numBytes += names;
+            else numOther += names;
+        }
+        else
+        {
+            numOther += names;
+        }
+        i++;
+    }
+    if( (numOther == 0) && (numBytes == 0) && (numFloats > 0) && (numFloats <= MAX_FIELDS) )
+    {
+        s->StructKind = K_FLOATS;
+    }
+    else if( (numOther == 0) && (numFloats == 0) && (numBytes > 0) && (numBytes <= MAX_FIELDS) )
+    {
+        s->StructKind = K_BYTES;
+    }
+    else
+    {
+        s->StructKind = K_STRUCT;
+    }
+    return i;
+}
+
+/* Parse a C number like 0x00000040 or 65. */
+static int ParseNumber( const char *t, long *Number )
+{
+    char *end;
+    *Number = strtol( t, &end, 0 );
+    while( *end == 'u' || *end == 'U' || *end == 'l' || *end == 'L' ) end++;
+    return (end != t) && (*end == '\0');
+}
+
+static int FindConstant( const char *Name, long *Number )
+{
+    int i;
+    for( i = 0; i < gConstants.Count; i++ )
+    {
+        if( strcmp( LIST_AT(gConstants, Constant, i).Name, Name ) == 0 )
+        {
+            *Number = LIST_AT(gConstants, Constant, i).Number;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* typedef enum { A = 1, B, ... } Name;
+** Enums with values that are not simple numbers are skipped,
+** like "typedef enum bool { false = 0, true = !false } bool;".
+*/
+static int ParseEnum( int i )
+{
+    int first = gConstants.Count;
+    long next = 0;
+    int ok = 1;
+
+    while( (i < gTokens.Count) && !IsTok( i, "{" ) ) i++;
+    i++;
+    while( (i < gTokens.Count) && !IsTok( i, "}" ) )
+    {
+        Constant *c;
+        if( !IsIdent( Tok( i ) ) )
+        {
+            ok = 0;
+            i++;
+            continue;
+        }
+        c = (Constant *) ListAdd( &gConstants );
+        CopyName( c->Name, Tok( i ), sizeof(c->Name) );
+        c->Number = next;
+        i++;
+        if( IsTok( i, "=" ) )
+        {
+            int negative = IsTok( i + 1, "-" );
+            const char *t = Tok( i + 1 + negative );
+            if( (ParseNumber( t, &c->Number ) || FindConstant( t, &c->Number ))
+                && (IsTok( i + 2 + negative, "," ) || IsTok( i + 2 + negative, "}" )) )
+            {
+                if( negative ) c->Number = -c->Number;
+            }
+            else
+            {
+                ok = 0;
+            }
+            while( (i < gTokens.Count) && !IsTok( i, "," ) && !IsTok( i, "}" ) ) i++;
+        }
+        next = c->Number + 1;
+        if( IsTok( i, "," ) ) i++;
+    }
+    i++;
+    if( IsIdent( Tok( i ) ) ) AddName( &gNames, Tok( i ) );
+    if( !ok ) gConstants.Count = first;
+    return i;
+}
+
+/* Convert DrawCircleV to DRAW-CIRCLE-V and GetScreenToWorld2D to GET-SCREEN-TO-WORLD-2D. */
+static void ForthStyleName( char *dst, const char *src )
+{
+    int i;
+    for( i = 0; src[i]; i++ )
+    {
+        unsigned char c = (unsigned char) src[i];
+        if( i > 0 )
+        {
+            unsigned char prev = (unsigned char) src[i - 1];
+            unsigned char next = (unsigned char) src[i + 1];
+            if( (isupper( c ) && islower( prev ))
+                || (isupper( c ) && isupper( prev ) && islower( next ))
+                || (isdigit( c ) && islower( prev )) )
+            {
+                *dst++ = '-';
+            }
+        }
+        *dst++ = (char) toupper( c );
+    }
+    *dst = '\0';
+}
+
+static void Skip( const char *Name, const char *Why )
+{
+    snprintf( (char *) ListAdd( &gSkipped ), MAX_LINE, "%s (%s)", Name, Why );
+}
+
+/* RLAPI Type Name(params); */
+static int ParseFunction( int i )
+{
+    Function *f;
+    int start = i, open, close, p, numStrings = 0;
+    const char *why = NULL;
+
+    while( (i < gTokens.Count) && !IsTok( i, "(" ) ) i++;
+    open = i;
+    while( (i < gTokens.Count) && !IsTok( i, ")" ) ) i++;
+    close = i;
+    if( !IsTok( close + 1, ";" ) || (open - 1 <= start) ) return close;
+
+    f = (Function *) ListAdd( &gFunctions );
+    CopyName( f->Name, Tok( open - 1 ), sizeof(f->Name) );
+    ForthStyleName( f->ForthName, f->Name );
+    if( ParseValue( start, open - 1, &f->Result, 0 ) < 0 ) why = "result";
+    else f->Result.ValueKind = ClassifyValue( &f->Result, 1 );
+    if( f->Result.ValueKind == K_BAD ) why = f->Result.Type;
+
+    /* Parameters, or "void". */
+    if( !((close == open + 2) && IsTok( open + 1, "void" )) && (close > open + 1) )
+    {
+        int first = open + 1;
+        for( p = open + 1; (p <= close) && (why == NULL); p++ )
+        {
+            Value *v;
+            if( !IsTok( p, "," ) && (p != close) ) continue;
+            if( IsTok( first, "..." ) )
+            {
+                why = "...";
+                break;
+            }
+            if( f->NumParams == MAX_PARAMS )
+            {
+                why = "parameters";
+                break;
+            }
+            v = &f->Params[f->NumParams++];
+            if( ParseValue( first, p, v, 1 ) < 0 )
+            {
+                why = "parameter";
+                break;
+            }
+            v->ValueKind = ClassifyValue( v, 0 );
+            if( v->ValueKind == K_BAD ) why = v->Type;
+            if( v->ValueKind == K_STRING ) numStrings++;
+            first = p + 1;
+        }
+    }
+    if( (why == NULL) && (numStrings > MAX_STRINGS) ) why = "strings";
+    if( (why == NULL) && (strlen( f->ForthName ) > MAX_FORTH_NAME) ) why = "name";
+    if( why != NULL )
+    {
+        Skip( f->Name, why );
+        gFunctions.Count--;
+        return close + 1;
+    }
+
+    f->UsesFloat = (f->Result.ValueKind == K_FLOAT) || (f->Result.ValueKind == K_FLOATS);
+    for( p = 0; p < f->NumParams; p++ )
+    {
+        Kind k = f->Params[p].ValueKind;
+        if( (k == K_FLOAT) || (k == K_FLOATS) ) f->UsesFloat = 1;
+    }
+    return close + 1;
+}
+
+static void Parse( void )
+{
+    int i;
+    for( i = 0; i < gTokens.Count; i++ )
+    {
+        if( IsTok( i, "typedef" ) )
+        {
+            int k;
+            /* Callbacks are not supported, "typedef void (*TraceLogCallback)(...);" */
+            for( k = i + 1; IsIdent( Tok( k ) ) || IsTok( k, "*" ); k++ ) {}
+            if( IsTok( k, "(" ) && IsTok( k + 1, "*" ) )
+            {
+                while( (i < gTokens.Count) && !IsTok( i, ";" ) ) i++;
+            }
+            else if( IsTok( i + 1, "struct" ) && IsIdent( Tok( i + 2 ) ) )
+            {
+                i = ParseStruct( i + 2 );
+            }
+            else if( IsTok( i + 1, "enum" ) )
+            {
+                i = ParseEnum( i + 1 );
+            }
+            else if( IsIdent( Tok( i + 1 ) ) && IsIdent( Tok( i + 2 ) ) && IsTok( i + 3, ";" ) )
+            {
+                char *alias = (char *) ListAdd( &gAliases );
+                CopyName( alias, Tok( i + 2 ), MAX_NAME );
+                CopyName( alias + MAX_NAME, Tok( i + 1 ), MAX_NAME );
+                i += 3;
+            }
+        }
+        else if( IsTok( i, "RLAPI" ) )
+        {
+            i = ParseFunction( i + 1 );
+        }
+    }
+}
+
+/***************************************************************
+** Find the resources, the structs with "void UnloadName(Name x)".
+*/
+static int IsCountName( const char *Name )
+{
+    size_t len = strlen( Name );
+    return (strcmp( Name, "count" ) == 0) || ((len > 5) && (strcmp( Name + len - 5, "Count" ) == 0));
+}
+
+static void FindResources( void )
+{
+    int i, p;
+    for( i = 0; i < gFunctions.Count; i++ )
+    {
+        Function *f = &LIST_AT(gFunctions, Function, i);
+        if( (strncmp( f->Name, "Unload", 6 ) == 0) && (f->NumParams == 1)
+            && (f->Result.ValueKind == K_VOID) && (f->Params[0].ValueKind == K_STRUCT) )
+        {
+            f->Unloads = 1;
+            FindStruct( f->Params[0].Struct->Name )->IsResource = 1;
+        }
+    }
+    for( i = 0; i < gStructs.Count; i++ )
+    {
+        StructInfo *s = &LIST_AT(gStructs, StructInfo, i);
+        if( s->IsResource ) s->ResourceType = gNumResources++;
+    }
+    for( i = 0; i < gFunctions.Count; i++ )
+    {
+        Function *f = &LIST_AT(gFunctions, Function, i);
+        f->Result.IsHandle = (f->Result.ValueKind == K_STRUCT) && f->Result.Struct->IsResource;
+        for( p = 0; p < f->NumParams; p++ )
+        {
+            Value *v = &f->Params[p];
+            if( (v->ValueKind == K_POINTER) && (v->Stars == 1)
+                && ((p + 1 == f->NumParams) || !IsCountName( f->Params[p + 1].Name )) )
+            {
+                const StructInfo *s = FindStruct( ResolveAlias( v->Base ) );
+                if( (s != NULL) && s->IsResource ) v->Struct = s;
+            }
+            v->IsHandle = (v->Struct != NULL) && v->Struct->IsResource
+                && ((v->ValueKind == K_STRUCT) || (v->ValueKind == K_POINTER));
+        }
+    }
+}
+
+/***************************************************************
+** Output.
+*/
+
+/* Print #ifdef PF_SUPPORT_FP around runs of floating point words. */
+static int gInFloat;
+static void FloatSection( int UsesFloat )
+{
+    if( UsesFloat && !gInFloat ) printf( "#ifdef PF_SUPPORT_FP\n" );
+    if( !UsesFloat && gInFloat ) printf( "#endif /* PF_SUPPORT_FP */\n" );
+    gInFloat = UsesFloat;
+}
+
+/* PF_RL_TYPE_RENDER_TEXTURE for RenderTexture */
+static void PrintTypeName( const StructInfo *s )
+{
+    char name[2 * MAX_NAME];
+    char *p;
+    ForthStyleName( name, s->Name );
+    for( p = name; *p; p++ ) if( *p == '-' ) *p = '_';
+    printf( "PF_RL_TYPE_%s", name );
+}
+
+static void PrintIDName( const Function *f )
+{
+    const char *p;
+    printf( "ID_RL_" );
+    for( p = f->ForthName; *p; p++ ) putchar( (*p == '-') ? '_' : *p );
+}
+
+/* Append the stack picture of a value to one of the two stacks. */
+static void StackPicture( const Value *v, const char *Name, char *Cells, char *Floats )
+{
+    char item[4 * MAX_NAME + 8] = "";
+    int i;
+    switch( v->ValueKind )
+    {
+    case K_FLOAT:
+        strcat( Floats, " " );
+        strcat( Floats, Name );
+        return;
+    case K_FLOATS:
+        for( i = 0; i < v->Struct->NumFields; i++ )
+        {
+            strcat( Floats, " " );
+            strcat( Floats, Name );
+            strcat( Floats, "." );
+            strcat( Floats, v->Struct->Fields[i] );
+        }
+        return;
+    case K_BYTES:
+        for( i = 0; i < v->Struct->NumFields; i++ )
+        {
+            strcat( item, " " );
+            strcat( item, v->Struct->Fields[i] );
+        }
+        break;
+    case K_STRING:
+        strcpy( item, " c-addr u" );
+        break;
+    case K_VOID:
+        return;
+    default:
+        sprintf( item, " %s", Name );
+        break;
+    }
+    strcat( Cells, item );
+}
+
+/* True if the value goes on the data stack. */
+static int IsCellKind( Kind k )
+{
+    return (k != K_VOID) && (k != K_FLOAT) && (k != K_FLOATS) && (k != K_BAD);
+}
+
+static void PrintCall( const Function *f )
+{
+    int p;
+    printf( "%s(", f->Name );
+    for( p = 0; p < f->NumParams; p++ )
+    {
+        const Value *v = &f->Params[p];
+        printf( "%s %srl_%s", (p > 0) ? "," : "", (v->IsHandle && (v->Stars == 0)) ? "*" : "", v->Name );
+    }
+    printf( " )" );
+}
+
+/* A resource from a Get function, like GetFontDefault(), is not
+** loaded and must not be unloaded, so it gets the same handle every time. */
+static int IsBorrowed( const Function *f )
+{
+    return f->Result.IsHandle && (strncmp( f->Name, "Get", 3 ) == 0);
+}
+
+/* Call the function and push the result. */
+static void PrintResult( const Function *f, int reuseTos, const char *in )
+{
+    int i;
+    switch( f->Result.ValueKind )
+    {
+    case K_VOID:
+        printf( "%s", in ); PrintCall( f ); printf( ";\n" );
+        break;
+    case K_INT:
+    case K_POINTER:
+        if( !reuseTos ) printf( "%sPUSH_TOS;\n", in );
+        printf( "%sTOS = (cell_t) ", in ); PrintCall( f ); printf( ";\n" );
+        break;
+    case K_BOOL:
+        if( !reuseTos ) printf( "%sPUSH_TOS;\n", in );
+        printf( "%sTOS = ", in ); PrintCall( f ); printf( " ? FTRUE : FFALSE;\n" );
+        break;
+    case K_FLOAT:
+        printf( "%sPUSH_FP_TOS;\n", in );
+        printf( "%sFP_TOS = (PF_FLOAT) ", in ); PrintCall( f ); printf( ";\n" );
+        break;
+    case K_STRING:
+        printf( "%srl_Result = ", in ); PrintCall( f ); printf( ";\n" );
+        if( !reuseTos ) printf( "%sPUSH_TOS;\n", in );
+        printf( "%sM_PUSH( rl_Result );\n", in );
+        printf( "%sTOS = (rl_Result != NULL) ? (cell_t) pfCStringLength( rl_Result ) : 0;\n", in );
+        break;
+    case K_BYTES:
+        printf( "%srl_Result = ", in ); PrintCall( f ); printf( ";\n" );
+        if( !reuseTos ) printf( "%sPUSH_TOS;\n", in );
+        for( i = 0; i < f->Result.Struct->NumFields - 1; i++ )
+        {
+            printf( "%sM_PUSH( rl_Result.%s );\n", in, f->Result.Struct->Fields[i] );
+        }
+        printf( "%sTOS = rl_Result.%s;\n", in, f->Result.Struct->Fields[i] );
+        break;
+    case K_FLOATS:
+        printf( "%srl_Result = ", in ); PrintCall( f ); printf( ";\n" );
+        printf( "%sPUSH_FP_TOS;\n", in );
+        for( i = 0; i < f->Result.Struct->NumFields - 1; i++ )
+        {
+            printf( "%sM_FP_PUSH( rl_Result.%s );\n", in, f->Result.Struct->Fields[i] );
+        }
+        printf( "%sFP_TOS = rl_Result.%s;\n", in, f->Result.Struct->Fields[i] );
+        break;
+    case K_STRUCT:
+        /* Allocate first so that nothing is lost if there is no memory. */
+        if( IsBorrowed( f ) )
+        {
+            printf( "%sCharPtr = (char *) pfRaylibHandleData( rl_Handle, ", in );
+            PrintTypeName( f->Result.Struct );
+            printf( " );\n" );
+            printf( "%sif( CharPtr == NULL ) CharPtr = (char *) pfRaylibNewHandle( ", in );
+            PrintTypeName( f->Result.Struct );
+            printf( ", sizeof(%s), &rl_Handle );\n", f->Result.Base );
+            printf( "%sTemp = rl_Handle;\n", in );
+        }
+        else if( f->Result.IsHandle )
+        {
+            printf( "%sCharPtr = (char *) pfRaylibNewHandle( ", in );
+            PrintTypeName( f->Result.Struct );
+            printf( ", sizeof(%s), &Temp );\n", f->Result.Base );
+        }
+        else
+        {
+            printf( "%sCharPtr = pfHeapAlloc( sizeof(%s), (cell_t) InsPtr );\n", in, f->Result.Base );
+        }
+        printf( "%sif( CharPtr == NULL )\n", in );
+        printf( "%s{\n", in );
+        printf( "%s    M_THROW( THROW_ALLOCATE );\n", in );
+        printf( "%s}\n", in );
+        printf( "%selse\n", in );
+        printf( "%s{\n", in );
+        printf( "%s    *(%s *) CharPtr = ", in, f->Result.Base ); PrintCall( f ); printf( ";\n" );
+        if( !reuseTos ) printf( "%s    PUSH_TOS;\n", in );
+        printf( "%s    TOS = %s;\n", in, f->Result.IsHandle ? "Temp" : "(cell_t) CharPtr" );
+        printf( "%s}\n", in );
+        break;
+    default:
+        break;
+    }
+}
+
+static void PrintCase( const Function *f )
+{
+    char inCells[1024] = "", inFloats[1024] = "", outCells[256] = "", outFloats[256] = "";
+    const char *resultName;
+    const char *in;
+    int p, str, firstCell, reuseTos, numHandles = 0;
+
+    for( p = 0; p < f->NumParams; p++ )
+    {
+        StackPicture( &f->Params[p], f->Params[p].Name, inCells, inFloats );
+    }
+    switch( f->Result.ValueKind )
+    {
+    case K_INT:     resultName = "n"; break;
+    case K_BOOL:    resultName = "flag"; break;
+    case K_FLOAT:   resultName = "r"; break;
+    case K_FLOATS:  resultName = "r"; break;
+    default:        resultName = f->Result.IsHandle ? "handle" : "addr"; break;
+    }
+    StackPicture( &f->Result, resultName, outCells, outFloats );
+
+    printf( "        case " );
+    PrintIDName( f );
+    printf( ":  /* (%s --%s )", inCells, outCells );
+    if( f->UsesFloat ) printf( " ( F:%s --%s )", inFloats, outFloats );
+    printf( " */\n" );
+
+    printf( "            {\n" );
+    for( p = 0; p < f->NumParams; p++ )
+    {
+        const Value *v = &f->Params[p];
+        if( v->IsHandle )
+        {
+            printf( "                %s *rl_%s;\n", v->Base, v->Name );
+            numHandles++;
+            continue;
+        }
+        switch( v->ValueKind )
+        {
+        case K_STRING:
+            printf( "                const char *rl_%s;\n", v->Name );
+            break;
+        case K_POINTER:
+            printf( "                %s%srl_%s;\n", v->Type, (v->Type[strlen( v->Type ) - 1] == '*') ? "" : " ", v->Name );
+            break;
+        default:
+            printf( "                %s rl_%s;\n", v->Base, v->Name );
+            break;
+        }
+    }
+    if( IsBorrowed( f ) ) printf( "                static cell_t rl_Handle = 0;\n" );
+    switch( f->Result.ValueKind )
+    {
+    case K_STRING:
+        printf( "                %srl_Result;\n", f->Result.Type );
+        break;
+    case K_BYTES:
+    case K_FLOATS:
+        printf( "                %s rl_Result;\n", f->Result.Base );
+        break;
+    default:
+        break;
+    }
+
+    /* Pop the parameters, last first. If the result goes on the data
+    ** stack, the last cell popped is not dropped and TOS is reused. */
+    str = 0;
+    firstCell = -1;
+    for( p = f->NumParams - 1; p >= 0; p-- )
+    {
+        if( f->Params[p].ValueKind == K_STRING ) str++;
+        if( IsCellKind( f->Params[p].ValueKind ) ) firstCell = p;
+    }
+    reuseTos = (firstCell >= 0) && IsCellKind( f->Result.ValueKind );
+    for( p = f->NumParams - 1; p >= 0; p-- )
+    {
+        const Value *v = &f->Params[p];
+        const char *drop = (reuseTos && (p == firstCell)) ? "" : " M_DROP;";
+        int i;
+        if( v->IsHandle )
+        {
+            /* Keep the handle in Temp for the Unload function. */
+            printf( "                %srl_%s = (%s *) pfRaylibHandleData( TOS, ", f->Unloads ? "Temp = TOS; " : "",
+                v->Name, v->Base );
+            PrintTypeName( v->Struct );
+            printf( " );%s\n", drop );
+            continue;
+        }
+        switch( v->ValueKind )
+        {
+        case K_INT:
+            printf( "                rl_%s = (%s) TOS;%s\n", v->Name, v->Base, drop );
+            break;
+        case K_BOOL:
+            printf( "                rl_%s = (TOS != 0);%s\n", v->Name, drop );
+            break;
+        case K_FLOAT:
+            printf( "                rl_%s = (%s) FP_TOS; M_FP_DROP;\n", v->Name, v->Base );
+            break;
+        case K_POINTER:
+            printf( "                rl_%s = (%s) TOS;%s\n", v->Name, v->Type, drop );
+            break;
+        case K_STRING:
+            printf( "                Temp = TOS; M_DROP; /* u */\n" );
+            printf( "                rl_%s = pfRaylibCString( TOS, Temp, %d );%s\n", v->Name, --str, drop );
+            break;
+        case K_BYTES:
+            for( i = v->Struct->NumFields - 1; i >= 0; i-- )
+            {
+                printf( "                rl_%s.%s = (unsigned char) TOS;%s\n", v->Name, v->Struct->Fields[i],
+                    (i == 0) ? drop : " M_DROP;" );
+            }
+            break;
+        case K_FLOATS:
+            for( i = v->Struct->NumFields - 1; i >= 0; i-- )
+            {
+                printf( "                rl_%s.%s = (float) FP_TOS; M_FP_DROP;\n", v->Name, v->Struct->Fields[i] );
+            }
+            break;
+        case K_STRUCT:
+            printf( "                rl_%s = *(%s *) TOS;%s\n", v->Name, v->Base, drop );
+            break;
+        default:
+            break;
+        }
+    }
+
+    /* Check the handles before anything is changed. */
+    in = "                ";
+    if( numHandles > 0 )
+    {
+        printf( "                if( " );
+        for( p = 0, str = 0; p < f->NumParams; p++ )
+        {
+            if( !f->Params[p].IsHandle ) continue;
+            if( numHandles == 1 ) printf( "rl_%s == NULL", f->Params[p].Name );
+            else printf( "%s(rl_%s == NULL)", (str++ > 0) ? " || " : "", f->Params[p].Name );
+        }
+        printf( " )\n" );
+        printf( "                {\n" );
+        printf( "                    M_THROW( THROW_RAYLIB_HANDLE );\n" );
+        printf( "                }\n" );
+        printf( "                else\n" );
+        printf( "                {\n" );
+        in = "                    ";
+    }
+    PrintResult( f, reuseTos, in );
+    if( f->Unloads ) printf( "%spfRaylibFreeHandle( Temp );\n", in );
+    if( numHandles > 0 ) printf( "                }\n" );
+    printf( "            }\n" );
+    printf( "            endcase;\n\n" );
+}
+
+/* FNV-1a hash of a string, continued from Hash. */
+static unsigned long HashText( unsigned long Hash, const char *Text )
+{
+    while( *Text != '\0' )
+    {
+        Hash = ((Hash ^ (unsigned char) *Text++) * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return Hash;
+}
+
+/* Hash the name and types of every function, see PF_RAYLIB_API_HASH.
+** "@" marks a value passed as a handle.
+*/
+static unsigned long HashAPI( void )
+{
+    unsigned long Hash = 2166136261UL;
+    int i, j;
+
+    for( i = 0; i < gFunctions.Count; i++ )
+    {
+        const Function *f = &LIST_AT(gFunctions, Function, i);
+        Hash = HashText( Hash, f->Result.Type );
+        Hash = HashText( Hash, f->Result.IsHandle ? "@ " : " " );
+        Hash = HashText( Hash, f->Name );
+        Hash = HashText( Hash, "(" );
+        for( j = 0; j < f->NumParams; j++ )
+        {
+            Hash = HashText( Hash, f->Params[j].Type );
+            Hash = HashText( Hash, f->Params[j].IsHandle ? "@," : "," );
+        }
+        Hash = HashText( Hash, ");" );
+    }
+    return Hash;
+}
+
+static void Generate( const char *HeaderName )
+{
+    int i;
+
+    printf( "/* pf_raylib_api.h - generated by mkraylib from %s. Do not edit. */\n", HeaderName );
+    printf( "/* %d functions, %d constants. */\n", gFunctions.Count, gConstants.Count );
+    if( gSkipped.Count > 0 )
+    {
+        printf( "/* Skipped:\n" );
+        for( i = 0; i < gSkipped.Count; i++ )
+        {
+            printf( "**     %s\n", (const char *) gSkipped.Data + (size_t) i * MAX_LINE );
+        }
+        printf( "*/\n" );
+    }
+
+    printf( "\n#ifndef PF_RAYLIB_API_HASH\n" );
+    printf( "#define PF_RAYLIB_API_HASH  (0x%08lXUL)\n", HashAPI() );
+    printf( "#endif\n" );
+
+    printf( "\n#ifdef PF_RAYLIB_TYPES\n" );
+    for( i = 0; i < gStructs.Count; i++ )
+    {
+        const StructInfo *s = &LIST_AT(gStructs, StructInfo, i);
+        if( !s->IsResource ) continue;
+        printf( "#define " );
+        PrintTypeName( s );
+        printf( "  (%d)\n", s->ResourceType );
+    }
+    printf( "#define PF_RAYLIB_NUM_TYPES  (%d)\n", gNumResources );
+    printf( "#endif /* PF_RAYLIB_TYPES */\n" );
+
+    printf( "\n#ifdef PF_RAYLIB_IDS\n" );
+    for( i = 0; i < gFunctions.Count; i++ )
+    {
+        printf( "    " );
+        PrintIDName( &LIST_AT(gFunctions, Function, i) );
+        printf( ",\n" );
+    }
+    printf( "#endif /* PF_RAYLIB_IDS */\n" );
+
+    printf( "\n#ifdef PF_RAYLIB_ENTRIES\n" );
+    for( i = 0; i < gFunctions.Count; i++ )
+    {
+        const Function *f = &LIST_AT(gFunctions, Function, i);
+        FloatSection( f->UsesFloat );
+        printf( "    CreateDicEntryC( " );
+        PrintIDName( f );
+        printf( ", \"%s\", 0 );\n", f->ForthName );
+    }
+    FloatSection( 0 );
+    for( i = 0; i < gConstants.Count; i++ )
+    {
+        const Constant *c = &LIST_AT(gConstants, Constant, i);
+        if( strlen( c->Name ) > MAX_FORTH_NAME ) continue;
+        printf( "    CreateConstantC( \"%s\", %ld );\n", c->Name, c->Number );
+    }
+    printf( "#endif /* PF_RAYLIB_ENTRIES */\n" );
+
+    printf( "\n#ifdef PF_RAYLIB_CASES\n" );
+    for( i = 0; i < gFunctions.Count; i++ )
+    {
+        const Function *f = &LIST_AT(gFunctions, Function, i);
+        FloatSection( f->UsesFloat );
+        PrintCase( f );
+    }
+    FloatSection( 0 );
+    printf( "#endif /* PF_RAYLIB_CASES */\n" );
+}
+
+int main( int argc, char **argv )
+{
+    FILE *fid;
+    char *text;
+    long size;
+    int i;
+
+    if( argc != 2 )
+    {
+        fprintf( stderr, "Usage: mkraylib path/to/raylib.h > pf_raylib_api.h\n" );
+        return 1;
+    }
+    fid = fopen( argv[1], "rb" );
+    if( fid == NULL )
+    {
+        fprintf( stderr, "mkraylib: cannot open %s\n", argv[1] );
+        return 1;
+    }
+    fseek( fid, 0, SEEK_END );
+    size = ftell( fid );
+    fseek( fid, 0, SEEK_SET );
+    text = (char *) malloc( (size_t) size + 1 );
+    if( (text == NULL) || (fread( text, 1, (size_t) size, fid ) != (size_t) size) )
+    {
+        fprintf( stderr, "mkraylib: cannot read %s\n", argv[1] );
+        return 1;
+    }
+    text[size] = '\0';
+    fclose( fid );
+
+    Tokenize( text );
+    Parse();
+    FindResources();
+    if( gFunctions.Count == 0 )
+    {
+        fprintf( stderr, "mkraylib: no RLAPI functions in %s\n", argv[1] );
+        return 1;
+    }
+    for( i = 0; i < gConstants.Count; i++ )
+    {
+        if( strlen( LIST_AT(gConstants, Constant, i).Name ) > MAX_FORTH_NAME )
+        {
+            Skip( LIST_AT(gConstants, Constant, i).Name, "name" );
+        }
+    }
+    Generate( argv[1] );
+    return 0;
+}
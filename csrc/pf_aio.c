@@ -0,0 +1,224 @@
+/* @(#) pf_aio.c 2026-10-19 */
+/***************************************************************
+** Asynchronous file I/O for PForth
+**
+** Requests are queued for a small pool of I/O threads that use
+** sdReadFileAt() and sdWriteFileAt(), so the interpreter keeps
+** running while the disk is busy. Each request gets its own file
+** offset when it is started, so requests on one file may finish
+** in any order. The buffer and the file must not be used or
+** closed until the request has been waited for.
+**
+** Without PF_SUPPORT_THREADS the transfer is done when the
+** request is started, and the request is already done.
+**
+** Permission to use, copy, modify, and/or distribute this
+** software for any purpose with or without fee is hereby granted.
+**
+** THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+** WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+** THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+** CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+** FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+** CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+** OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**
+***************************************************************/
+
+#include "pf_all.h"
+
+#if defined(PF_SUPPORT_THREADS) && !defined(PF_NO_FILEIO)
+    #define PF_ASYNC_THREADS (1)
+    #define LOCK_ASYNC    sdLock( PF_LOCK_ASYNC_IO )
+    #define UNLOCK_ASYNC  sdUnlock( PF_LOCK_ASYNC_IO )
+#else
+    #define LOCK_ASYNC    /* noop */
+    #define UNLOCK_ASYNC  /* noop */
+#endif
+
+#define PF_AIO_NUM_THREADS  (2)
+
+#define PF_IOR_ASYNC  (-1)  /* ior for a failed transfer */
+
+typedef struct pfFileRequest_s
+{
+    struct pfFileRequest_s *fr_Next;   /* In the queue. */
+    FileStream    *fr_File;
+    char          *fr_Buffer;
+    cell_t         fr_NumBytes;
+    file_offset_t  fr_Offset;
+    int            fr_IsWrite;
+/* Set by an I/O thread, guarded by PF_LOCK_ASYNC_IO. */
+    cell_t         fr_Done;
+    cell_t         fr_Result;          /* Bytes transferred. */
+    cell_t         fr_Ior;
+} pfFileRequest_t;
+
+/* Transfer the bytes and fill in the result. */
+static void pfDoFileRequest( pfFileRequest_t *req )
+{
+    cell_t num;
+#ifdef PF_ASYNC_THREADS
+    if( req->fr_IsWrite )
+        num = sdWriteFileAt( req->fr_File, req->fr_Buffer, req->fr_NumBytes, req->fr_Offset );
+    else
+        num = sdReadFileAt( req->fr_File, req->fr_Buffer, req->fr_NumBytes, req->fr_Offset );
+#else
+    file_offset_t saved = sdTellFile( req->fr_File );
+    num = -1;
+    if( sdSeekFile( req->fr_File, req->fr_Offset, PF_SEEK_SET ) == 0 )
+    {
+        if( req->fr_IsWrite )
+            num = sdWriteFile( req->fr_Buffer, 1, req->fr_NumBytes, req->fr_File );
+        else
+            num = sdReadFile( req->fr_Buffer, 1, req->fr_NumBytes, req->fr_File );
+    }
+    sdSeekFile( req->fr_File, saved, PF_SEEK_SET );
+#endif
+    req->fr_Result = (num < 0) ? 0 : num;
+    if( num < 0 ) req->fr_Ior = PF_IOR_ASYNC;
+    else if( req->fr_IsWrite && (num != req->fr_NumBytes) ) req->fr_Ior = PF_IOR_ASYNC;
+    else req->fr_Ior = 0;
+}
+
+#ifdef PF_ASYNC_THREADS
+/* Guarded by PF_LOCK_ASYNC_IO. */
+static pfFileRequest_t *gAsyncHead;
+static pfFileRequest_t *gAsyncTail;
+static cell_t gAsyncThreads[PF_AIO_NUM_THREADS];
+static cell_t gAsyncNumThreads;
+static cell_t gAsyncQuit;
+
+static void *pfAsyncThreadMain( void *arg )
+{
+    pfFileRequest_t *req;
+    (void) arg;
+
+    LOCK_ASYNC;
+    for(;;)
+    {
+        while( !gAsyncQuit && (gAsyncHead == NULL) ) sdWaitCondition( PF_LOCK_ASYNC_IO );
+        if( gAsyncHead == NULL ) break; /* Quit once the queue is empty. */
+        req = gAsyncHead;
+        gAsyncHead = req->fr_Next;
+        if( gAsyncHead == NULL ) gAsyncTail = NULL;
+        UNLOCK_ASYNC;
+
+        pfDoFileRequest( req );
+
+        LOCK_ASYNC;
+        req->fr_Done = TRUE;
+        sdSignalCondition( PF_LOCK_ASYNC_IO );
+    }
+    UNLOCK_ASYNC;
+    return NULL;
+}
+#endif /* PF_ASYNC_THREADS */
+
+/***************************************************************/
+cell_t pfStartFileRequest( int IsWrite, char *Buffer, cell_t NumBytes, FileStream *File )
+{
+    pfFileRequest_t *req;
+    file_offset_t position;
+
+    req = (pfFileRequest_t *) pfAllocMem( sizeof(pfFileRequest_t) );
+    if( req == NULL ) return 0;
+    pfSetMemory( req, 0, sizeof(pfFileRequest_t) );
+    req->fr_File = File;
+    req->fr_Buffer = Buffer;
+    req->fr_NumBytes = NumBytes;
+    req->fr_IsWrite = IsWrite;
+
+/* Flush so that bytes written by WRITE-FILE are in the file before ours. */
+    if( IsWrite ) sdFlushFile( File );
+    position = sdTellFile( File );
+    if( (position < 0) || (NumBytes < 0) ||
+        (sdSeekFile( File, position + NumBytes, PF_SEEK_SET ) != 0) )
+    {
+        req->fr_Ior = PF_IOR_ASYNC;
+        req->fr_Done = TRUE;
+        return (cell_t) req;
+    }
+    req->fr_Offset = position;
+
+#ifdef PF_ASYNC_THREADS
+    LOCK_ASYNC;
+    while( gAsyncNumThreads < PF_AIO_NUM_THREADS )
+    {
+        cell_t thread = sdCreateThread( pfAsyncThreadMain, NULL );
+        if( thread == 0 ) break;
+        gAsyncThreads[gAsyncNumThreads++] = thread;
+    }
+    if( gAsyncNumThreads > 0 )
+    {
+        if( gAsyncTail == NULL ) gAsyncHead = req;
+        else gAsyncTail->fr_Next = req;
+        gAsyncTail = req;
+        sdSignalCondition( PF_LOCK_ASYNC_IO );
+        UNLOCK_ASYNC;
+        return (cell_t) req;
+    }
+    UNLOCK_ASYNC;
+#endif
+/* No threads so do it now. */
+    pfDoFileRequest( req );
+    req->fr_Done = TRUE;
+    return (cell_t) req;
+}
+
+/***************************************************************/
+cell_t pfFileRequestDone( cell_t Request )
+{
+    pfFileRequest_t *req = (pfFileRequest_t *) Request;
+    cell_t done;
+    if( req == NULL ) return TRUE;
+    LOCK_ASYNC;
+    done = req->fr_Done;
+    UNLOCK_ASYNC;
+    return done;
+}
+
+/***************************************************************/
+cell_t pfWaitFileRequest( cell_t Request, cell_t *IorPtr )
+{
+    pfFileRequest_t *req = (pfFileRequest_t *) Request;
+    cell_t result;
+
+    if( req == NULL )
+    {
+        *IorPtr = PF_IOR_ASYNC;
+        return 0;
+    }
+
+    LOCK_ASYNC;
+#ifdef PF_ASYNC_THREADS
+    while( !req->fr_Done ) sdWaitCondition( PF_LOCK_ASYNC_IO );
+#endif
+    UNLOCK_ASYNC;
+
+    result = req->fr_Result;
+    *IorPtr = req->fr_Ior;
+    pfFreeMem( req );
+    return result;
+}
+
+/***************************************************************/
+void pfTermFileRequests( void )
+{
+#ifdef PF_ASYNC_THREADS
+    cell_t i;
+
+    LOCK_ASYNC;
+    gAsyncQuit = TRUE;
+    sdSignalCondition( PF_LOCK_ASYNC_IO );
+    UNLOCK_ASYNC;
+
+    for( i=0; i<gAsyncNumThreads; i++ )
+    {
+        sdJoinThread( gAsyncThreads[i] );
+    }
+    gAsyncNumThreads = 0;
+    gAsyncQuit = FALSE;
+#endif
+}
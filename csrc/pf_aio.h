@@ -0,0 +1,49 @@
+/* @(#) pf_aio.h 2026-10-19 */
+#ifndef _pf_aio_h
+#define _pf_aio_h
+
+/***************************************************************
+** Include file for PForth asynchronous file I/O
+**
+** Used by READ-FILE-ASYNC WRITE-FILE-ASYNC REQ-DONE? and REQ-WAIT
+** in "pf_inner.c".
+**
+** Permission to use, copy, modify, and/or distribute this
+** software for any purpose with or without fee is hereby granted.
+**
+** THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+** WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+** THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+** CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+** FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+** CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+** OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**
+***************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Start reading or writing NumBytes at the current file position,
+** then move the file position past them.
+** Returns a request, or 0 if out of memory.
+** A 0 request is done and waiting for it gives an error. */
+cell_t pfStartFileRequest( int IsWrite, char *Buffer, cell_t NumBytes, FileStream *File );
+
+/* True if the request has finished. Does not wait. */
+cell_t pfFileRequestDone( cell_t Request );
+
+/* Wait for the request to finish then free it.
+** Returns the number of bytes read or written, and sets *IorPtr. */
+cell_t pfWaitFileRequest( cell_t Request, cell_t *IorPtr );
+
+/* Stop the I/O threads. Called when pForth exits. */
+void pfTermFileRequests( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _pf_aio_h */
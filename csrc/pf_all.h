@@ -58,6 +58,11 @@
 #include "pf_words.h"
 #include "pf_save.h"
 #include "pf_mem.h"
+#include "pf_pheap.h"
+#include "pf_raylib.h"
+#include "pf_array.h"
+#include "pf_chan.h"
+#include "pf_aio.h"
 #include "pf_cglue.h"
 #include "pf_core.h"
 
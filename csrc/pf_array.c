@@ -0,0 +1,487 @@
+/* @(#) pf_array.c 2026-10-19 */
+/***************************************************************
+** Typed array kernels for PForth
+**
+** Each kernel has a plain 'C' loop that handles any tail, and any
+** CPU without SSE2. On x86 the body of the loop runs two float64,
+** four float32 or four int32 elements at a time using SSE2.
+** Arrays do not need to be aligned, and dst may be the same array
+** as a source.
+**
+** Permission to use, copy, modify, and/or distribute this
+** software for any purpose with or without fee is hereby granted.
+**
+** THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+** WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+** THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+** CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+** FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+** CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+** OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**
+***************************************************************/
+
+#include "pf_all.h"
+
+#ifdef PF_SUPPORT_FP
+
+#if defined(__SSE2__) && !defined(PF_SCALAR_ARRAYS) && !defined(PF_DIC_CONVERT)
+    #include <emmintrin.h>
+    #define PF_SSE2_ARRAYS (1)
+#endif
+
+#define ARRAY_MIN(a,b)  (((a) < (b)) ? (a) : (b))
+#define ARRAY_MAX(a,b)  (((a) > (b)) ? (a) : (b))
+
+/* Run a vector body WIDTH elements at a time, then a scalar body for the rest. */
+#ifdef PF_SSE2_ARRAYS
+    #define ARRAY_LOOP( WIDTH, VECTOR, SCALAR ) \
+        for( ; (i + (WIDTH)) <= n; i += (WIDTH) ) { VECTOR; } \
+        for( ; i < n; i++ ) { SCALAR; }
+#else
+    #define ARRAY_LOOP( WIDTH, VECTOR, SCALAR ) \
+        for( ; i < n; i++ ) { SCALAR; }
+#endif
+
+/* Read and write PF_FLOAT and cell elements. In the dictionary they are in
+** dictionary byte order, the same as F! and ! leave them, so a build with
+** PF_DIC_CONVERT uses the scalar loops and converts each element. */
+#ifdef PF_DIC_CONVERT
+    #define ARRAY_IN(p,Base,Limit)  (((ucell_t) (p) >= gCurrentDictionary->Base) && ((ucell_t) (p) < gCurrentDictionary->Limit))
+    #define ARRAY_IN_CODE(p)        ARRAY_IN( p, dic_CodeBase, dic_CodeLimit )
+    #define ARRAY_IN_DICS(p)        (ARRAY_IN_CODE(p) || ARRAY_IN( p, dic_HeaderBase, dic_HeaderLimit ))
+    #define GET_DF(p)       (ARRAY_IN_CODE(p) ? READ_FLOAT_DIC( (p) ) : *(p))
+    #define PUT_DF(p,x)     { if( ARRAY_IN_CODE(p) ) { WRITE_FLOAT_DIC( (p), (x) ); } else { *(p) = (x); } }
+    #define GET_CELL(p)     (ARRAY_IN_DICS(p) ? (cell_t) READ_CELL_DIC(p) : *(p))
+    #define PUT_CELL(p,x)   { if( ARRAY_IN_DICS(p) ) { WRITE_CELL_DIC( (p), (x) ); } else { *(p) = (x); } }
+#else
+    #define GET_DF(p)       (*(p))
+    #define PUT_DF(p,x)     { *(p) = (x); }
+    #define GET_CELL(p)     (*(p))
+    #define PUT_CELL(p,x)   { *(p) = (x); }
+#endif
+
+/* Unaligned SSE2 loads and stores for each element type. */
+#define LOAD_DF(p)      _mm_loadu_pd( (p) )
+#define STORE_DF(p,v)   _mm_storeu_pd( (p), (v) )
+#define LOAD_SF(p)      _mm_loadu_ps( (p) )
+#define STORE_SF(p,v)   _mm_storeu_ps( (p), (v) )
+#define LOAD_I32(p)     _mm_loadu_si128( (const __m128i *) (p) )
+#define STORE_I32(p,v)  _mm_storeu_si128( (__m128i *) (p), (v) )
+
+/***************************************************************
+** Element-wise operations.
+*/
+void pfArrayOpDF( int Op, const PF_FLOAT *a, const PF_FLOAT *b, PF_FLOAT *dst, cell_t n )
+{
+    cell_t i = 0;
+    switch( Op )
+    {
+    case PF_ARRAY_ADD:
+        ARRAY_LOOP( 2, STORE_DF( dst+i, _mm_add_pd( LOAD_DF(a+i), LOAD_DF(b+i) ) ), PUT_DF( dst+i, GET_DF(a+i) + GET_DF(b+i) ) );
+        break;
+    case PF_ARRAY_SUB:
+        ARRAY_LOOP( 2, STORE_DF( dst+i, _mm_sub_pd( LOAD_DF(a+i), LOAD_DF(b+i) ) ), PUT_DF( dst+i, GET_DF(a+i) - GET_DF(b+i) ) );
+        break;
+    default:
+        ARRAY_LOOP( 2, STORE_DF( dst+i, _mm_mul_pd( LOAD_DF(a+i), LOAD_DF(b+i) ) ), PUT_DF( dst+i, GET_DF(a+i) * GET_DF(b+i) ) );
+        break;
+    }
+}
+
+void pfArrayOpSF( int Op, const float *a, const float *b, float *dst, cell_t n )
+{
+    cell_t i = 0;
+    switch( Op )
+    {
+    case PF_ARRAY_ADD:
+        ARRAY_LOOP( 4, STORE_SF( dst+i, _mm_add_ps( LOAD_SF(a+i), LOAD_SF(b+i) ) ), dst[i] = a[i] + b[i] );
+        break;
+    case PF_ARRAY_SUB:
+        ARRAY_LOOP( 4, STORE_SF( dst+i, _mm_sub_ps( LOAD_SF(a+i), LOAD_SF(b+i) ) ), dst[i] = a[i] - b[i] );
+        break;
+    default:
+        ARRAY_LOOP( 4, STORE_SF( dst+i, _mm_mul_ps( LOAD_SF(a+i), LOAD_SF(b+i) ) ), dst[i] = a[i] * b[i] );
+        break;
+    }
+}
+
+/* Integer arithmetic wraps around, like the Forth words on a 32-bit cell.
+** SSE2 has no 32-bit multiply so that one stays scalar. */
+#define WRAP_I32(x)   ((int32_t) (uint32_t) (x))
+
+void pfArrayOpI32( int Op, const int32_t *a, const int32_t *b, int32_t *dst, cell_t n )
+{
+    cell_t i = 0;
+    switch( Op )
+    {
+    case PF_ARRAY_ADD:
+        ARRAY_LOOP( 4, STORE_I32( dst+i, _mm_add_epi32( LOAD_I32(a+i), LOAD_I32(b+i) ) ),
+            dst[i] = WRAP_I32( (uint32_t) a[i] + (uint32_t) b[i] ) );
+        break;
+    case PF_ARRAY_SUB:
+        ARRAY_LOOP( 4, STORE_I32( dst+i, _mm_sub_epi32( LOAD_I32(a+i), LOAD_I32(b+i) ) ),
+            dst[i] = WRAP_I32( (uint32_t) a[i] - (uint32_t) b[i] ) );
+        break;
+    default:
+        for( ; i < n; i++ ) dst[i] = WRAP_I32( (uint32_t) a[i] * (uint32_t) b[i] );
+        break;
+    }
+}
+
+void pfArrayOpScalarDF( int Op, const PF_FLOAT *a, PF_FLOAT s, PF_FLOAT *dst, cell_t n )
+{
+    cell_t i = 0;
+#ifdef PF_SSE2_ARRAYS
+    const __m128d vs = _mm_set1_pd( s );
+#endif
+    switch( Op )
+    {
+    case PF_ARRAY_ADD:
+        ARRAY_LOOP( 2, STORE_DF( dst+i, _mm_add_pd( LOAD_DF(a+i), vs ) ), PUT_DF( dst+i, GET_DF(a+i) + s ) );
+        break;
+    case PF_ARRAY_SUB:
+        ARRAY_LOOP( 2, STORE_DF( dst+i, _mm_sub_pd( LOAD_DF(a+i), vs ) ), PUT_DF( dst+i, GET_DF(a+i) - s ) );
+        break;
+    default:
+        ARRAY_LOOP( 2, STORE_DF( dst+i, _mm_mul_pd( LOAD_DF(a+i), vs ) ), PUT_DF( dst+i, GET_DF(a+i) * s ) );
+        break;
+    }
+}
+
+void pfArrayOpScalarSF( int Op, const float *a, float s, float *dst, cell_t n )
+{
+    cell_t i = 0;
+#ifdef PF_SSE2_ARRAYS
+    const __m128 vs = _mm_set1_ps( s );
+#endif
+    switch( Op )
+    {
+    case PF_ARRAY_ADD:
+        ARRAY_LOOP( 4, STORE_SF( dst+i, _mm_add_ps( LOAD_SF(a+i), vs ) ), dst[i] = a[i] + s );
+        break;
+    case PF_ARRAY_SUB:
+        ARRAY_LOOP( 4, STORE_SF( dst+i, _mm_sub_ps( LOAD_SF(a+i), vs ) ), dst[i] = a[i] - s );
+        break;
+    default:
+        ARRAY_LOOP( 4, STORE_SF( dst+i, _mm_mul_ps( LOAD_SF(a+i), vs ) ), dst[i] = a[i] * s );
+        break;
+    }
+}
+
+void pfArrayOpScalarI32( int Op, const int32_t *a, int32_t s, int32_t *dst, cell_t n )
+{
+    cell_t i = 0;
+#ifdef PF_SSE2_ARRAYS
+    const __m128i vs = _mm_set1_epi32( s );
+#endif
+    switch( Op )
+    {
+    case PF_ARRAY_ADD:
+        ARRAY_LOOP( 4, STORE_I32( dst+i, _mm_add_epi32( LOAD_I32(a+i), vs ) ),
+            dst[i] = WRAP_I32( (uint32_t) a[i] + (uint32_t) s ) );
+        break;
+    case PF_ARRAY_SUB:
+        ARRAY_LOOP( 4, STORE_I32( dst+i, _mm_sub_epi32( LOAD_I32(a+i), vs ) ),
+            dst[i] = WRAP_I32( (uint32_t) a[i] - (uint32_t) s ) );
+        break;
+    default:
+        for( ; i < n; i++ ) dst[i] = WRAP_I32( (uint32_t) a[i] * (uint32_t) s );
+        break;
+    }
+}
+
+/***************************************************************
+** Multiply and add. There is no fused multiply in SSE2 so the
+** product is rounded before the add, same as the scalar loop.
+*/
+void pfArrayFmaDF( const PF_FLOAT *a, const PF_FLOAT *b, const PF_FLOAT *c, PF_FLOAT *dst, cell_t n )
+{
+    cell_t i = 0;
+    ARRAY_LOOP( 2, STORE_DF( dst+i, _mm_add_pd( _mm_mul_pd( LOAD_DF(a+i), LOAD_DF(b+i) ), LOAD_DF(c+i) ) ),
+        PUT_DF( dst+i, (GET_DF(a+i) * GET_DF(b+i)) + GET_DF(c+i) ) );
+}
+
+void pfArrayFmaSF( const float *a, const float *b, const float *c, float *dst, cell_t n )
+{
+    cell_t i = 0;
+    ARRAY_LOOP( 4, STORE_SF( dst+i, _mm_add_ps( _mm_mul_ps( LOAD_SF(a+i), LOAD_SF(b+i) ), LOAD_SF(c+i) ) ),
+        dst[i] = (a[i] * b[i]) + c[i] );
+}
+
+void pfArrayFmaI32( const int32_t *a, const int32_t *b, const int32_t *c, int32_t *dst, cell_t n )
+{
+    cell_t i;
+    for( i=0; i<n; i++ )
+    {
+        dst[i] = WRAP_I32( ((uint32_t) a[i] * (uint32_t) b[i]) + (uint32_t) c[i] );
+    }
+}
+
+void pfArrayAxpyDF( const PF_FLOAT *a, PF_FLOAT s, const PF_FLOAT *b, PF_FLOAT *dst, cell_t n )
+{
+    cell_t i = 0;
+#ifdef PF_SSE2_ARRAYS
+    const __m128d vs = _mm_set1_pd( s );
+#endif
+    ARRAY_LOOP( 2, STORE_DF( dst+i, _mm_add_pd( _mm_mul_pd( LOAD_DF(a+i), vs ), LOAD_DF(b+i) ) ),
+        PUT_DF( dst+i, (GET_DF(a+i) * s) + GET_DF(b+i) ) );
+}
+
+void pfArrayAxpySF( const float *a, float s, const float *b, float *dst, cell_t n )
+{
+    cell_t i = 0;
+#ifdef PF_SSE2_ARRAYS
+    const __m128 vs = _mm_set1_ps( s );
+#endif
+    ARRAY_LOOP( 4, STORE_SF( dst+i, _mm_add_ps( _mm_mul_ps( LOAD_SF(a+i), vs ), LOAD_SF(b+i) ) ),
+        dst[i] = (a[i] * s) + b[i] );
+}
+
+void pfArrayAxpyI32( const int32_t *a, int32_t s, const int32_t *b, int32_t *dst, cell_t n )
+{
+    cell_t i;
+    for( i=0; i<n; i++ )
+    {
+        dst[i] = WRAP_I32( ((uint32_t) a[i] * (uint32_t) s) + (uint32_t) b[i] );
+    }
+}
+
+void pfArrayClampDF( const PF_FLOAT *a, PF_FLOAT lo, PF_FLOAT hi, PF_FLOAT *dst, cell_t n )
+{
+    cell_t i = 0;
+#ifdef PF_SSE2_ARRAYS
+    const __m128d vlo = _mm_set1_pd( lo );
+    const __m128d vhi = _mm_set1_pd( hi );
+#endif
+    ARRAY_LOOP( 2, STORE_DF( dst+i, _mm_max_pd( _mm_min_pd( LOAD_DF(a+i), vhi ), vlo ) ),
+        PUT_DF( dst+i, ARRAY_MAX( ARRAY_MIN( GET_DF(a+i), hi ), lo ) ) );
+}
+
+void pfArrayClampSF( const float *a, float lo, float hi, float *dst, cell_t n )
+{
+    cell_t i = 0;
+#ifdef PF_SSE2_ARRAYS
+    const __m128 vlo = _mm_set1_ps( lo );
+    const __m128 vhi = _mm_set1_ps( hi );
+#endif
+    ARRAY_LOOP( 4, STORE_SF( dst+i, _mm_max_ps( _mm_min_ps( LOAD_SF(a+i), vhi ), vlo ) ),
+        dst[i] = ARRAY_MAX( ARRAY_MIN( a[i], hi ), lo ) );
+}
+
+void pfArrayClampI32( const int32_t *a, int32_t lo, int32_t hi, int32_t *dst, cell_t n )
+{
+    cell_t i;
+    for( i=0; i<n; i++ )
+    {
+        dst[i] = ARRAY_MAX( ARRAY_MIN( a[i], hi ), lo );
+    }
+}
+
+/***************************************************************
+** Reductions.
+*/
+#ifdef PF_SSE2_ARRAYS
+/* Add the two lanes of an SSE2 double vector. */
+static PF_FLOAT SumLanesDF( __m128d v )
+{
+    return _mm_cvtsd_f64( _mm_add_sd( v, _mm_unpackhi_pd( v, v ) ) );
+}
+#endif
+
+PF_FLOAT pfArrayDotDF( const PF_FLOAT *a, const PF_FLOAT *b, cell_t n )
+{
+    cell_t i = 0;
+    PF_FLOAT sum = 0.0;
+#ifdef PF_SSE2_ARRAYS
+    __m128d acc = _mm_setzero_pd();
+    for( ; (i + 2) <= n; i += 2 )
+    {
+        acc = _mm_add_pd( acc, _mm_mul_pd( LOAD_DF(a+i), LOAD_DF(b+i) ) );
+    }
+    sum = SumLanesDF( acc );
+#endif
+    for( ; i < n; i++ ) sum += GET_DF(a+i) * GET_DF(b+i);
+    return sum;
+}
+
+PF_FLOAT pfArrayDotSF( const float *a, const float *b, cell_t n )
+{
+    cell_t i = 0;
+    PF_FLOAT sum = 0.0;
+#ifdef PF_SSE2_ARRAYS
+    __m128d acc = _mm_setzero_pd();
+    for( ; (i + 4) <= n; i += 4 )
+    {
+        /* Widen each product to double before adding it. */
+        __m128 p = _mm_mul_ps( LOAD_SF(a+i), LOAD_SF(b+i) );
+        acc = _mm_add_pd( acc, _mm_cvtps_pd( p ) );
+        acc = _mm_add_pd( acc, _mm_cvtps_pd( _mm_movehl_ps( p, p ) ) );
+    }
+    sum = SumLanesDF( acc );
+#endif
+    for( ; i < n; i++ ) sum += (PF_FLOAT) (a[i] * b[i]);
+    return sum;
+}
+
+cell_t pfArrayDotI32( const int32_t *a, const int32_t *b, cell_t n )
+{
+    cell_t i;
+    ucell_t sum = 0;
+/* The product always fits in 64 bits. The sum wraps like + does. */
+    for( i=0; i<n; i++ ) sum += (ucell_t) (uint64_t) ((int64_t) a[i] * (int64_t) b[i]);
+    return (cell_t) sum;
+}
+
+PF_FLOAT pfArraySumDF( const PF_FLOAT *a, cell_t n )
+{
+    cell_t i = 0;
+    PF_FLOAT sum = 0.0;
+#ifdef PF_SSE2_ARRAYS
+    __m128d acc = _mm_setzero_pd();
+    for( ; (i + 2) <= n; i += 2 ) acc = _mm_add_pd( acc, LOAD_DF(a+i) );
+    sum = SumLanesDF( acc );
+#endif
+    for( ; i < n; i++ ) sum += GET_DF(a+i);
+    return sum;
+}
+
+PF_FLOAT pfArraySumSF( const float *a, cell_t n )
+{
+    cell_t i = 0;
+    PF_FLOAT sum = 0.0;
+#ifdef PF_SSE2_ARRAYS
+    __m128d acc = _mm_setzero_pd();
+    for( ; (i + 4) <= n; i += 4 )
+    {
+        __m128 v = LOAD_SF(a+i);
+        acc = _mm_add_pd( acc, _mm_cvtps_pd( v ) );
+        acc = _mm_add_pd( acc, _mm_cvtps_pd( _mm_movehl_ps( v, v ) ) );
+    }
+    sum = SumLanesDF( acc );
+#endif
+    for( ; i < n; i++ ) sum += a[i];
+    return sum;
+}
+
+cell_t pfArraySumI32( const int32_t *a, cell_t n )
+{
+    cell_t i;
+    ucell_t sum = 0;
+    for( i=0; i<n; i++ ) sum += (ucell_t) (cell_t) a[i];
+    return (cell_t) sum;
+}
+
+PF_FLOAT pfArrayMinDF( const PF_FLOAT *a, cell_t n )
+{
+    cell_t i = 0;
+    PF_FLOAT result = HUGE_VAL;
+#ifdef PF_SSE2_ARRAYS
+    __m128d acc = _mm_set1_pd( HUGE_VAL );
+    for( ; (i + 2) <= n; i += 2 ) acc = _mm_min_pd( acc, LOAD_DF(a+i) );
+    result = ARRAY_MIN( _mm_cvtsd_f64( acc ), _mm_cvtsd_f64( _mm_unpackhi_pd( acc, acc ) ) );
+#endif
+    for( ; i < n; i++ ) result = ARRAY_MIN( result, GET_DF(a+i) );
+    return result;
+}
+
+PF_FLOAT pfArrayMaxDF( const PF_FLOAT *a, cell_t n )
+{
+    cell_t i = 0;
+    PF_FLOAT result = -HUGE_VAL;
+#ifdef PF_SSE2_ARRAYS
+    __m128d acc = _mm_set1_pd( -HUGE_VAL );
+    for( ; (i + 2) <= n; i += 2 ) acc = _mm_max_pd( acc, LOAD_DF(a+i) );
+    result = ARRAY_MAX( _mm_cvtsd_f64( acc ), _mm_cvtsd_f64( _mm_unpackhi_pd( acc, acc ) ) );
+#endif
+    for( ; i < n; i++ ) result = ARRAY_MAX( result, GET_DF(a+i) );
+    return result;
+}
+
+PF_FLOAT pfArrayMinSF( const float *a, cell_t n )
+{
+    cell_t i;
+    float result = (float) HUGE_VAL;
+    for( i=0; i<n; i++ ) result = ARRAY_MIN( result, a[i] );
+    return result;
+}
+
+PF_FLOAT pfArrayMaxSF( const float *a, cell_t n )
+{
+    cell_t i;
+    float result = (float) -HUGE_VAL;
+    for( i=0; i<n; i++ ) result = ARRAY_MAX( result, a[i] );
+    return result;
+}
+
+cell_t pfArrayMinI32( const int32_t *a, cell_t n )
+{
+    cell_t i;
+    int32_t result = INT32_MAX;
+    for( i=0; i<n; i++ ) result = ARRAY_MIN( result, a[i] );
+    return result;
+}
+
+cell_t pfArrayMaxI32( const int32_t *a, cell_t n )
+{
+    cell_t i;
+    int32_t result = INT32_MIN;
+    for( i=0; i<n; i++ ) result = ARRAY_MAX( result, a[i] );
+    return result;
+}
+
+/***************************************************************
+** Conversions.
+*/
+void pfArrayCellsToDF( const cell_t *src, PF_FLOAT *dst, cell_t n )
+{
+    cell_t i;
+    for( i=0; i<n; i++ ) PUT_DF( dst+i, (PF_FLOAT) GET_CELL(src+i) );
+}
+
+void pfArrayDFToCells( const PF_FLOAT *src, cell_t *dst, cell_t n )
+{
+    cell_t i;
+    for( i=0; i<n; i++ ) PUT_CELL( dst+i, (cell_t) GET_DF(src+i) );
+}
+
+void pfArrayCellsToSF( const cell_t *src, float *dst, cell_t n )
+{
+    cell_t i;
+    for( i=0; i<n; i++ ) dst[i] = (float) GET_CELL(src+i);
+}
+
+void pfArraySFToCells( const float *src, cell_t *dst, cell_t n )
+{
+    cell_t i;
+    for( i=0; i<n; i++ ) PUT_CELL( dst+i, (cell_t) src[i] );
+}
+
+void pfArrayCellsToI32( const cell_t *src, int32_t *dst, cell_t n )
+{
+    cell_t i;
+    for( i=0; i<n; i++ ) dst[i] = WRAP_I32( GET_CELL(src+i) );
+}
+
+void pfArrayI32ToCells( const int32_t *src, cell_t *dst, cell_t n )
+{
+    cell_t i;
+    for( i=0; i<n; i++ ) PUT_CELL( dst+i, (cell_t) src[i] );
+}
+
+void pfArraySFToDF( const float *src, PF_FLOAT *dst, cell_t n )
+{
+    cell_t i = 0;
+    ARRAY_LOOP( 2, STORE_DF( dst+i, _mm_cvtps_pd( _mm_castsi128_ps( _mm_loadl_epi64( (const __m128i *) (src+i) ) ) ) ),
+        PUT_DF( dst+i, (PF_FLOAT) src[i] ) );
+}
+
+void pfArrayDFToSF( const PF_FLOAT *src, float *dst, cell_t n )
+{
+    cell_t i = 0;
+    ARRAY_LOOP( 2, _mm_storel_epi64( (__m128i *) (dst+i), _mm_castps_si128( _mm_cvtpd_ps( LOAD_DF(src+i) ) ) ),
+        dst[i] = (float) GET_DF(src+i) );
+}
+
+#endif /* PF_SUPPORT_FP */
@@ -0,0 +1,97 @@
+/* @(#) pf_array.h 2026-10-19 */
+#ifndef _pf_array_h
+#define _pf_array_h
+
+/***************************************************************
+** Include file for PForth typed array kernels
+**
+** Bulk arithmetic on contiguous arrays of float64 (PF_FLOAT),
+** float32 and int32 values in Forth memory.
+** Used by the DFV, SFV and IV words in "pfinnrfp.h".
+**
+** Permission to use, copy, modify, and/or distribute this
+** software for any purpose with or without fee is hereby granted.
+**
+** THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+** WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+** THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+** CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+** FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+** CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+** OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**
+***************************************************************/
+
+#ifdef PF_SUPPORT_FP
+
+/* Element-wise operations, selected by the Op parameter. */
+#define PF_ARRAY_ADD   (0)
+#define PF_ARRAY_SUB   (1)
+#define PF_ARRAY_MUL   (2)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* dst[i] = a[i] op b[i] */
+void pfArrayOpDF( int Op, const PF_FLOAT *a, const PF_FLOAT *b, PF_FLOAT *dst, cell_t n );
+void pfArrayOpSF( int Op, const float *a, const float *b, float *dst, cell_t n );
+void pfArrayOpI32( int Op, const int32_t *a, const int32_t *b, int32_t *dst, cell_t n );
+
+/* dst[i] = a[i] op s */
+void pfArrayOpScalarDF( int Op, const PF_FLOAT *a, PF_FLOAT s, PF_FLOAT *dst, cell_t n );
+void pfArrayOpScalarSF( int Op, const float *a, float s, float *dst, cell_t n );
+void pfArrayOpScalarI32( int Op, const int32_t *a, int32_t s, int32_t *dst, cell_t n );
+
+/* dst[i] = a[i]*b[i] + c[i] */
+void pfArrayFmaDF( const PF_FLOAT *a, const PF_FLOAT *b, const PF_FLOAT *c, PF_FLOAT *dst, cell_t n );
+void pfArrayFmaSF( const float *a, const float *b, const float *c, float *dst, cell_t n );
+void pfArrayFmaI32( const int32_t *a, const int32_t *b, const int32_t *c, int32_t *dst, cell_t n );
+
+/* dst[i] = a[i]*s + b[i] */
+void pfArrayAxpyDF( const PF_FLOAT *a, PF_FLOAT s, const PF_FLOAT *b, PF_FLOAT *dst, cell_t n );
+void pfArrayAxpySF( const float *a, float s, const float *b, float *dst, cell_t n );
+void pfArrayAxpyI32( const int32_t *a, int32_t s, const int32_t *b, int32_t *dst, cell_t n );
+
+/* dst[i] = a[i] limited to lo..hi */
+void pfArrayClampDF( const PF_FLOAT *a, PF_FLOAT lo, PF_FLOAT hi, PF_FLOAT *dst, cell_t n );
+void pfArrayClampSF( const float *a, float lo, float hi, float *dst, cell_t n );
+void pfArrayClampI32( const int32_t *a, int32_t lo, int32_t hi, int32_t *dst, cell_t n );
+
+/* Reductions. Float sums are accumulated in PF_FLOAT, several lanes at a time,
+** so the last bits may differ from a sequential loop. */
+PF_FLOAT pfArrayDotDF( const PF_FLOAT *a, const PF_FLOAT *b, cell_t n );
+PF_FLOAT pfArrayDotSF( const float *a, const float *b, cell_t n );
+cell_t   pfArrayDotI32( const int32_t *a, const int32_t *b, cell_t n );
+PF_FLOAT pfArraySumDF( const PF_FLOAT *a, cell_t n );
+PF_FLOAT pfArraySumSF( const float *a, cell_t n );
+cell_t   pfArraySumI32( const int32_t *a, cell_t n );
+
+/* Smallest or largest element. An empty array gives the identity,
+** eg. +infinity for the float minimum. */
+PF_FLOAT pfArrayMinDF( const PF_FLOAT *a, cell_t n );
+PF_FLOAT pfArrayMaxDF( const PF_FLOAT *a, cell_t n );
+PF_FLOAT pfArrayMinSF( const float *a, cell_t n );
+PF_FLOAT pfArrayMaxSF( const float *a, cell_t n );
+cell_t   pfArrayMinI32( const int32_t *a, cell_t n );
+cell_t   pfArrayMaxI32( const int32_t *a, cell_t n );
+
+/* Conversions. Floats are truncated toward zero when converted to integers.
+** The source and destination must not overlap. */
+void pfArrayCellsToDF( const cell_t *src, PF_FLOAT *dst, cell_t n );
+void pfArrayDFToCells( const PF_FLOAT *src, cell_t *dst, cell_t n );
+void pfArrayCellsToSF( const cell_t *src, float *dst, cell_t n );
+void pfArraySFToCells( const float *src, cell_t *dst, cell_t n );
+void pfArrayCellsToI32( const cell_t *src, int32_t *dst, cell_t n );
+void pfArrayI32ToCells( const int32_t *src, cell_t *dst, cell_t n );
+void pfArraySFToDF( const float *src, PF_FLOAT *dst, cell_t n );
+void pfArrayDFToSF( const PF_FLOAT *src, float *dst, cell_t n );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PF_SUPPORT_FP */
+
+#endif /* _pf_array_h */
@@ -0,0 +1,161 @@
+/* @(#) pf_chan.c 2026-10-19 */
+/***************************************************************
+** Channels for PForth
+**
+** Each channel is a bounded multi-producer multi-consumer ring.
+** Every slot has a sequence number that tells a sender when the
+** slot is free and a receiver when it is full, so each cell only
+** needs one compare-and-swap on the head or tail. The head and
+** tail are on separate cache lines so that senders and receivers
+** do not slow each other down.
+**
+** Without PF_SUPPORT_THREADS only cooperative tasks share a
+** channel, so plain loads and stores are used.
+**
+** Permission to use, copy, modify, and/or distribute this
+** software for any purpose with or without fee is hereby granted.
+**
+** THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+** WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+** THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+** CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+** FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+** CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+** OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**
+***************************************************************/
+
+#include "pf_all.h"
+
+#define PF_CACHE_LINE  (64)
+
+#ifdef PF_SUPPORT_THREADS
+    #define LOAD_ACQUIRE(p)       __atomic_load_n( (p), __ATOMIC_ACQUIRE )
+    #define LOAD_RELAXED(p)       __atomic_load_n( (p), __ATOMIC_RELAXED )
+    #define STORE_RELEASE(p,v)    __atomic_store_n( (p), (v), __ATOMIC_RELEASE )
+    #define CAS_RELAXED(p,old,v)  __atomic_compare_exchange_n( (p), &(old), (v), 0, \
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED )
+#else
+    #define LOAD_ACQUIRE(p)       (*(p))
+    #define LOAD_RELAXED(p)       (*(p))
+    #define STORE_RELEASE(p,v)    (*(p) = (v))
+    #define CAS_RELAXED(p,old,v)  ((*(p) == (old)) ? (*(p) = (v), 1) : ((old) = *(p), 0))
+#endif
+
+typedef struct pfChannelSlot_s
+{
+    ucell_t cs_Sequence;
+    cell_t  cs_Value;
+} pfChannelSlot_t;
+
+typedef struct pfChannel_s
+{
+    ucell_t          ch_Mask;   /* Capacity - 1 */
+    pfChannelSlot_t *ch_Slots;  /* Follow this header. */
+    char             ch_Pad0[PF_CACHE_LINE];
+    ucell_t          ch_Head;   /* Next slot to receive from. */
+    char             ch_Pad1[PF_CACHE_LINE - sizeof(ucell_t)];
+    ucell_t          ch_Tail;   /* Next slot to send to. */
+    char             ch_Pad2[PF_CACHE_LINE - sizeof(ucell_t)];
+} pfChannel_t;
+
+static ucell_t pfChannelCapacity( cell_t Capacity )
+{
+    ucell_t size = 2;
+    while( size < (ucell_t) Capacity ) size = size << 1;
+    return size;
+}
+
+/***************************************************************/
+cell_t pfChannelSize( cell_t Capacity )
+{
+    if( Capacity < 1 ) return 0;
+    return sizeof(pfChannel_t) + (pfChannelCapacity( Capacity ) * sizeof(pfChannelSlot_t));
+}
+
+/***************************************************************/
+void pfInitChannel( void *Mem, cell_t Capacity )
+{
+    pfChannel_t *ch = (pfChannel_t *) Mem;
+    ucell_t i, size = pfChannelCapacity( Capacity );
+
+    pfSetMemory( ch, 0, sizeof(pfChannel_t) );
+    ch->ch_Mask = size - 1;
+    ch->ch_Slots = (pfChannelSlot_t *) (ch + 1);
+/* A slot is free for the sender whose position equals its sequence. */
+    for( i=0; i<size; i++ )
+    {
+        ch->ch_Slots[i].cs_Sequence = i;
+    }
+}
+
+/***************************************************************/
+cell_t pfChannelSend( cell_t Channel, const cell_t *Src, cell_t NumCells )
+{
+    pfChannel_t *ch = (pfChannel_t *) Channel;
+    pfChannelSlot_t *slot;
+    ucell_t pos, seq;
+    cell_t numSent;
+
+    for( numSent = 0; numSent < NumCells; numSent++ )
+    {
+        pos = LOAD_RELAXED( &ch->ch_Tail );
+        for(;;)
+        {
+            slot = &ch->ch_Slots[ pos & ch->ch_Mask ];
+            seq = LOAD_ACQUIRE( &slot->cs_Sequence );
+            if( seq == pos )
+            {
+                if( CAS_RELAXED( &ch->ch_Tail, pos, pos + 1 ) ) break;
+                /* CAS failed and reloaded pos. */
+            }
+            else if( (cell_t)(seq - pos) < 0 )
+            {
+                return numSent; /* Full. */
+            }
+            else
+            {
+                pos = LOAD_RELAXED( &ch->ch_Tail );
+            }
+        }
+        slot->cs_Value = Src[numSent];
+        STORE_RELEASE( &slot->cs_Sequence, pos + 1 );
+    }
+    return numSent;
+}
+
+/***************************************************************/
+cell_t pfChannelRecv( cell_t Channel, cell_t *Dst, cell_t NumCells )
+{
+    pfChannel_t *ch = (pfChannel_t *) Channel;
+    pfChannelSlot_t *slot;
+    ucell_t pos, seq;
+    cell_t numReceived;
+
+    for( numReceived = 0; numReceived < NumCells; numReceived++ )
+    {
+        pos = LOAD_RELAXED( &ch->ch_Head );
+        for(;;)
+        {
+            slot = &ch->ch_Slots[ pos & ch->ch_Mask ];
+            seq = LOAD_ACQUIRE( &slot->cs_Sequence );
+            if( seq == (pos + 1) )
+            {
+                if( CAS_RELAXED( &ch->ch_Head, pos, pos + 1 ) ) break;
+            }
+            else if( (cell_t)(seq - (pos + 1)) < 0 )
+            {
+                return numReceived; /* Empty. */
+            }
+            else
+            {
+                pos = LOAD_RELAXED( &ch->ch_Head );
+            }
+        }
+        Dst[numReceived] = slot->cs_Value;
+/* Free the slot for the sender one lap later. */
+        STORE_RELEASE( &slot->cs_Sequence, pos + ch->ch_Mask + 1 );
+    }
+    return numReceived;
+}
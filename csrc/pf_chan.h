@@ -0,0 +1,43 @@
+/* @(#) pf_chan.h 2026-10-19 */
+#ifndef _pf_chan_h
+#define _pf_chan_h
+
+/***************************************************************
+** Include file for PForth channels
+**
+** A channel is a bounded queue of cells that any number of tasks
+** and threads can send to and receive from without a lock.
+** Used by CHANNEL and the TRY- words in "pf_inner.c".
+**
+** Permission to use, copy, modify, and/or distribute this
+** software for any purpose with or without fee is hereby granted.
+**
+** THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+** WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+** THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+** CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+** FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+** CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+** OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**
+***************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Capacity is rounded up to a power of two.
+** Returns the number of bytes needed for a channel, or 0 if Capacity < 1. */
+cell_t pfChannelSize( cell_t Capacity );
+void   pfInitChannel( void *Mem, cell_t Capacity );
+
+/* These never wait. They return the number of cells sent or received. */
+cell_t pfChannelSend( cell_t Channel, const cell_t *Src, cell_t NumCells );
+cell_t pfChannelRecv( cell_t Channel, cell_t *Dst, cell_t NumCells );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _pf_chan_h */
@@ -37,3 +37,377 @@ char pfCharToUpper(char c) {
 char pfCharToLower(char c) {
     return (c >= 'A' && c <= 'Z') ? (c + ('a' - 'A')) : c;
 }
+
+/***************************************************************
+** Bulk character kernels.
+**
+** CMOVE, CMOVE>, FILL, COMPARE, SCAN and SKIP used to be plain byte
+** loops. The bulk copies and fills now go to memmove() and memset(),
+** which the C library already tunes for the host CPU. The searches
+** that the C library cannot express test 16 characters at a time
+** with SSE2, or a whole cell at a time elsewhere, then finish with
+** the byte loop.
+**
+** Define PF_SCALAR_CHARS to use only the byte loops.
+***************************************************************/
+
+#if defined(__SSE2__) && !defined(PF_SCALAR_CHARS)
+    #include <emmintrin.h>
+    #define PF_SSE2_CHARS  (1)
+#elif (defined(__GNUC__) || defined(__clang__)) && !defined(PF_SCALAR_CHARS)
+    /* A cell that may be read from any character address. */
+    typedef ucell_t pfUnalignedCell __attribute__((__may_alias__, __aligned__(1)));
+    #define PF_CELL_CHARS  (1)
+    #define CELL_ONES      (((ucell_t)-1) / 0xFF)
+#endif
+
+#define IS_BLANK_CHAR(c) (((c) == ' ') || ((c) == '\r') || ((c) == '\n') || ((c) == '\t'))
+
+/* Byte loops. These define the results that the fast paths must match. */
+#if defined(PF_SCALAR_CHARS) || defined(PF_UNIT_TEST)
+static void CopyCharsScalar( char *dst, const char *src, ucell_t n )
+{
+    while( n-- > 0 ) *dst++ = *src++;
+}
+
+static void CopyCharsUpScalar( char *dst, const char *src, ucell_t n )
+{
+    dst += n;
+    src += n;
+    while( n-- > 0 ) *(--dst) = *(--src);
+}
+
+static void FillCharsScalar( char *dst, ucell_t n, char c )
+{
+    while( n-- > 0 ) *dst++ = c;
+}
+
+static ucell_t FindCharScalar( const char *s, ucell_t n, char c )
+{
+    ucell_t i;
+    for( i=0; (i < n) && (s[i] != c); i++ ) {}
+    return i;
+}
+#endif /* PF_SCALAR_CHARS || PF_UNIT_TEST */
+
+static ucell_t MatchCharsScalar( const char *s1, const char *s2, ucell_t n )
+{
+    ucell_t i;
+    for( i=0; (i < n) && (s1[i] == s2[i]); i++ ) {}
+    return i;
+}
+
+static ucell_t FindBlankScalar( const char *s, ucell_t n )
+{
+    ucell_t i;
+    for( i=0; (i < n) && !IS_BLANK_CHAR(s[i]); i++ ) {}
+    return i;
+}
+
+static ucell_t SkipCharScalar( const char *s, ucell_t n, char c )
+{
+    ucell_t i;
+    for( i=0; (i < n) && (s[i] == c); i++ ) {}
+    return i;
+}
+
+/***************************************************************
+** Copy like CMOVE, one character at a time from low addresses up.
+** If dst starts inside src then the first (dst-src) characters
+** repeat through dst, so build that pattern by doubling it.
+*/
+void pfCopyChars( char *dst, const char *src, ucell_t n )
+{
+#ifdef PF_SCALAR_CHARS
+    CopyCharsScalar( dst, src, n );
+#else
+    ucell_t done, chunk;
+
+    if( (dst <= src) || (dst >= (src + n)) )
+    {
+        memmove( dst, src, n );
+        return;
+    }
+    done = (ucell_t) (dst - src);
+    pfCopyMemory( dst, src, done );
+    while( done < n )
+    {
+        chunk = MIN( done, n - done );
+        pfCopyMemory( dst + done, dst, chunk );
+        done += chunk;
+    }
+#endif
+}
+
+/***************************************************************
+** Copy like CMOVE>, one character at a time from high addresses down.
+** If dst ends inside src then the last (src-dst) characters
+** repeat backwards through dst.
+*/
+void pfCopyCharsUp( char *dst, const char *src, ucell_t n )
+{
+#ifdef PF_SCALAR_CHARS
+    CopyCharsUpScalar( dst, src, n );
+#else
+    ucell_t done, chunk;
+
+    if( (dst >= src) || ((dst + n) <= src) )
+    {
+        memmove( dst, src, n );
+        return;
+    }
+    done = (ucell_t) (src - dst);
+    pfCopyMemory( dst + n - done, src + n - done, done );
+    while( done < n )
+    {
+        chunk = MIN( done, n - done );
+        pfCopyMemory( dst + n - done - chunk, dst + n - chunk, chunk );
+        done += chunk;
+    }
+#endif
+}
+
+void pfFillChars( char *dst, ucell_t n, char c )
+{
+#ifdef PF_SCALAR_CHARS
+    FillCharsScalar( dst, n, c );
+#else
+    pfSetMemory( dst, (unsigned char) c, n );
+#endif
+}
+
+/* Return index of first character that differs. */
+ucell_t pfMatchChars( const char *s1, const char *s2, ucell_t n )
+{
+    ucell_t i = 0;
+#if defined(PF_SSE2_CHARS)
+    while( (n - i) >= 16 )
+    {
+        __m128i a = _mm_loadu_si128( (const __m128i *) (s1 + i) );
+        __m128i b = _mm_loadu_si128( (const __m128i *) (s2 + i) );
+        if( _mm_movemask_epi8( _mm_cmpeq_epi8( a, b ) ) != 0xFFFF ) break;
+        i += 16;
+    }
+#elif defined(PF_CELL_CHARS)
+    while( (n - i) >= sizeof(ucell_t) )
+    {
+        if( *(const pfUnalignedCell *) (s1 + i) != *(const pfUnalignedCell *) (s2 + i) ) break;
+        i += sizeof(ucell_t);
+    }
+#endif
+    return i + MatchCharsScalar( s1 + i, s2 + i, n - i );
+}
+
+ucell_t pfFindChar( const char *s, ucell_t n, char c )
+{
+#ifdef PF_SCALAR_CHARS
+    return FindCharScalar( s, n, c );
+#else
+    const char *hit = (const char *) memchr( s, (unsigned char) c, n );
+    return (hit == NULL) ? n : (ucell_t) (hit - s);
+#endif
+}
+
+/* Return index of first space, tab, CR or LF. */
+ucell_t pfFindBlank( const char *s, ucell_t n )
+{
+    ucell_t i = 0;
+#if defined(PF_SSE2_CHARS)
+    const __m128i spaces = _mm_set1_epi8( ' ' );
+    const __m128i tabs = _mm_set1_epi8( '\t' );
+    const __m128i crs = _mm_set1_epi8( '\r' );
+    const __m128i lfs = _mm_set1_epi8( '\n' );
+    while( (n - i) >= 16 )
+    {
+        __m128i a = _mm_loadu_si128( (const __m128i *) (s + i) );
+        __m128i hits = _mm_or_si128(
+            _mm_or_si128( _mm_cmpeq_epi8( a, spaces ), _mm_cmpeq_epi8( a, tabs ) ),
+            _mm_or_si128( _mm_cmpeq_epi8( a, crs ), _mm_cmpeq_epi8( a, lfs ) ) );
+        if( _mm_movemask_epi8( hits ) != 0 ) break;
+        i += 16;
+    }
+#elif defined(PF_CELL_CHARS)
+    while( (n - i) >= sizeof(ucell_t) )
+    {
+        /* Stop at any cell holding a character below '!', then let the byte loop decide. */
+        ucell_t x = *(const pfUnalignedCell *) (s + i);
+        if( ((x - (CELL_ONES * 0x21)) & ~x & (CELL_ONES * 0x80)) != 0 ) break;
+        i += sizeof(ucell_t);
+    }
+#endif
+    return i + FindBlankScalar( s + i, n - i );
+}
+
+/* Return index of first character that is not c. */
+ucell_t pfSkipChar( const char *s, ucell_t n, char c )
+{
+    ucell_t i = 0;
+#if defined(PF_SSE2_CHARS)
+    const __m128i pattern = _mm_set1_epi8( c );
+    while( (n - i) >= 16 )
+    {
+        __m128i a = _mm_loadu_si128( (const __m128i *) (s + i) );
+        if( _mm_movemask_epi8( _mm_cmpeq_epi8( a, pattern ) ) != 0xFFFF ) break;
+        i += 16;
+    }
+#elif defined(PF_CELL_CHARS)
+    const ucell_t pattern = CELL_ONES * (unsigned char) c;
+    while( (n - i) >= sizeof(ucell_t) )
+    {
+        if( *(const pfUnalignedCell *) (s + i) != pattern ) break;
+        i += sizeof(ucell_t);
+    }
+#endif
+    return i + SkipCharScalar( s + i, n - i, c );
+}
+
+#ifdef PF_UNIT_TEST
+#include <time.h>
+
+#define CHARS_TEST_SIZE   (256)
+#define CHARS_BENCH_SIZE  (1 << 20)
+#define CHARS_BENCH_TOTAL (1 << 23)
+
+static char gCharsA[CHARS_BENCH_SIZE + 16];
+static char gCharsB[CHARS_BENCH_SIZE + 16];
+static volatile ucell_t gCharsSink;
+
+static void FillCharsTestPattern( char *p, ucell_t n )
+{
+    ucell_t i;
+    for( i=0; i<n; i++ ) p[i] = (char) ('A' + (i % 23));
+}
+
+static cell_t ReportCharsError( const char *msg, cell_t n, cell_t offset )
+{
+    ERR(( "ERROR chars test failed: " ));
+    ERR(( msg ));
+    ERR(( ", n = " ));
+    ERR(( ConvertNumberToText( n, 10, TRUE, 1 ) ));
+    ERR(( ", offset = " ));
+    ERR(( ConvertNumberToText( offset, 10, TRUE, 1 ) ));
+    ERR(( "\n" ));
+    return 1;
+}
+
+static cell_t CheckCharsMatch( const char *msg, cell_t n, cell_t offset )
+{
+    if( MatchCharsScalar( gCharsA, gCharsB, CHARS_TEST_SIZE ) != CHARS_TEST_SIZE )
+    {
+        return ReportCharsError( msg, n, offset );
+    }
+    return 0;
+}
+
+/* Time one kernel over the same number of characters at each size, print MB/sec. */
+static void BenchChars( const char *name, int kernel, int fast )
+{
+    static const ucell_t sizes[] = { 16, 256, 4096, 65536, CHARS_BENCH_SIZE };
+    ucell_t i, rep, reps, size;
+    clock_t start;
+    double secs;
+
+    MSG( name );
+    MSG( fast ? " fast  " : " byte  " );
+    for( i=0; i<(sizeof(sizes)/sizeof(sizes[0])); i++ )
+    {
+        size = sizes[i];
+        reps = CHARS_BENCH_TOTAL / size;
+        start = clock();
+        for( rep=0; rep<reps; rep++ )
+        {
+            switch( kernel )
+            {
+            case 0:
+                if( fast ) pfCopyChars( gCharsB, gCharsA, size );
+                else CopyCharsScalar( gCharsB, gCharsA, size );
+                break;
+            case 1:
+                if( fast ) pfFillChars( gCharsB, size, (char) rep );
+                else FillCharsScalar( gCharsB, size, (char) rep );
+                break;
+            case 2:
+                gCharsSink += fast ? pfMatchChars( gCharsA, gCharsB, size )
+                    : MatchCharsScalar( gCharsA, gCharsB, size );
+                break;
+            default:
+                gCharsSink += fast ? pfFindBlank( gCharsA, size )
+                    : FindBlankScalar( gCharsA, size );
+                break;
+            }
+        }
+        secs = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+        if( secs <= 0.0 ) secs = 1.0 / CLOCKS_PER_SEC;
+        MSG( " " );
+        MSG( ConvertNumberToText( (cell_t) size, 10, FALSE, 1 ) );
+        MSG( "=" );
+        MSG( ConvertNumberToText( (cell_t) ((reps * size) / (secs * 1000000.0)), 10, FALSE, 1 ) );
+    }
+    MSG( " MB/sec\n" );
+}
+
+cell_t pfUnitTestChars( void )
+{
+    cell_t numErrors = 0;
+    cell_t n, offset;
+    char *mid;
+
+    /* Compare against the byte loops for every small size and overlap. */
+    mid = &gCharsA[CHARS_TEST_SIZE / 2];
+    for( n=0; n<80; n++ )
+    {
+        for( offset = -24; offset <= 24; offset++ )
+        {
+            FillCharsTestPattern( gCharsA, CHARS_TEST_SIZE );
+            FillCharsTestPattern( gCharsB, CHARS_TEST_SIZE );
+            CopyCharsScalar( &gCharsB[CHARS_TEST_SIZE / 2] + offset, &gCharsB[CHARS_TEST_SIZE / 2], n );
+            pfCopyChars( mid + offset, mid, n );
+            numErrors += CheckCharsMatch( "CMOVE", n, offset );
+
+            FillCharsTestPattern( gCharsA, CHARS_TEST_SIZE );
+            FillCharsTestPattern( gCharsB, CHARS_TEST_SIZE );
+            CopyCharsUpScalar( &gCharsB[CHARS_TEST_SIZE / 2] + offset, &gCharsB[CHARS_TEST_SIZE / 2], n );
+            pfCopyCharsUp( mid + offset, mid, n );
+            numErrors += CheckCharsMatch( "CMOVE>", n, offset );
+
+            FillCharsTestPattern( gCharsA, CHARS_TEST_SIZE );
+            FillCharsTestPattern( gCharsB, CHARS_TEST_SIZE );
+            FillCharsScalar( &gCharsB[CHARS_TEST_SIZE / 2] + offset, n, 'z' );
+            pfFillChars( mid + offset, n, 'z' );
+            numErrors += CheckCharsMatch( "FILL", n, offset );
+        }
+    }
+
+    /* Put a single hit at every position, and check each search finds it. */
+    for( n=0; n<80; n++ )
+    {
+        FillCharsTestPattern( gCharsA, CHARS_TEST_SIZE );
+        FillCharsTestPattern( gCharsB, CHARS_TEST_SIZE );
+        gCharsB[n] = '\n';
+        if( pfMatchChars( gCharsA, gCharsB, 80 ) != (ucell_t) n ) numErrors += ReportCharsError( "MATCH", n, 0 );
+        if( pfFindBlank( gCharsB, 80 ) != (ucell_t) n ) numErrors += ReportCharsError( "BLANK", n, 0 );
+        if( pfFindChar( gCharsB, 80, '\n' ) != FindCharScalar( gCharsB, 80, '\n' ) ) numErrors += ReportCharsError( "FIND", n, 0 );
+        FillCharsScalar( gCharsB, 80, '-' );
+        gCharsB[n] = '+';
+        if( pfSkipChar( gCharsB, 80, '-' ) != (ucell_t) n ) numErrors += ReportCharsError( "SKIP", n, 0 );
+        if( pfFindBlank( gCharsB, n ) != (ucell_t) n ) numErrors += ReportCharsError( "BLANK none", n, 0 );
+    }
+
+    if( numErrors == 0 )
+    {
+        FillCharsTestPattern( gCharsA, CHARS_BENCH_SIZE );
+        FillCharsTestPattern( gCharsB, CHARS_BENCH_SIZE );
+        MSG( "Character kernels, MB/sec at size:\n" );
+        BenchChars( "CMOVE  ", 0, FALSE );
+        BenchChars( "CMOVE  ", 0, TRUE );
+        BenchChars( "FILL   ", 1, FALSE );
+        BenchChars( "FILL   ", 1, TRUE );
+        FillCharsTestPattern( gCharsB, CHARS_BENCH_SIZE );
+        BenchChars( "COMPARE", 2, FALSE );
+        BenchChars( "COMPARE", 2, TRUE );
+        BenchChars( "SCAN   ", 3, FALSE );
+        BenchChars( "SCAN   ", 3, TRUE );
+    }
+    return numErrors;
+}
+#endif /* PF_UNIT_TEST */
@@ -26,6 +26,7 @@
 
 #include <string.h>  // Include string.h for standard library memory functions
 #include <stdlib.h>  // Include for exit function
+#include "pforth.h"  // cell_t and ucell_t
 
 /* Use standard library functions */
 #define pfCStringLength strlen
@@ -37,4 +38,21 @@
 char pfCharToUpper(char c);
 char pfCharToLower(char c);
 
+/* Bulk character kernels used by CMOVE, CMOVE>, FILL, COMPARE, SCAN and SKIP.
+** The copy functions keep the exact byte-by-byte results of the Forth words,
+** including when the regions overlap.
+** The search functions return the index of the first hit, or n if none.
+*/
+void   pfCopyChars( char *dst, const char *src, ucell_t n );
+void   pfCopyCharsUp( char *dst, const char *src, ucell_t n );
+void   pfFillChars( char *dst, ucell_t n, char c );
+ucell_t pfMatchChars( const char *s1, const char *s2, ucell_t n );
+ucell_t pfFindChar( const char *s, ucell_t n, char c );
+ucell_t pfFindBlank( const char *s, ucell_t n );
+ucell_t pfSkipChar( const char *s, ucell_t n, char c );
+
+#ifdef PF_UNIT_TEST
+cell_t pfUnitTestChars( void );
+#endif
+
 #endif /* _PF_CLIB_H */
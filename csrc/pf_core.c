@@ -42,39 +42,55 @@
 ** Global Data
 ***************************************************************/
 
-char            gScratch[TIB_SIZE];
-pfTaskData_t   *gCurrentTask = NULL;
+PF_THREAD_LOCAL char            gScratch[TIB_SIZE];
+PF_THREAD_LOCAL pfTaskData_t   *gCurrentTask = NULL;
+PF_THREAD_LOCAL pfTaskData_t   *gTaskList = NULL;
 pfDictionary_t *gCurrentDictionary;
 cell_t          gNumPrimitives;
 
-ExecToken       gLocalCompiler_XT;   /* custom compiler for local variables */
+PF_THREAD_LOCAL ExecToken       gLocalCompiler_XT;   /* custom compiler for local variables */
 ExecToken       gNumberQ_XT;         /* XT of NUMBER? */
 ExecToken       gQuitP_XT;           /* XT of (QUIT) */
 ExecToken       gAcceptP_XT;         /* XT of ACCEPT */
 
 /* Depth of data stack when colon called. */
-cell_t          gDepthAtColon;
+PF_THREAD_LOCAL cell_t          gDepthAtColon;
 
 /* Global Forth variables.
 * These must be initialized in pfInit below.
+* PF_THREAD_LOCAL ones are initialized for each thread by pfInitThreadGlobals.
 */
 cell_t          gVarContext;      /* Points to last name field. */
-cell_t          gVarState;        /* 1 if compiling. */
-cell_t          gVarBase;         /* Numeric Base. */
+PF_THREAD_LOCAL cell_t          gVarState;        /* 1 if compiling. */
+PF_THREAD_LOCAL cell_t          gVarBase;         /* Numeric Base. */
 cell_t          gVarByeCode;      /* Echo input. */
-cell_t          gVarEcho;         /* Echo input. */
-cell_t          gVarTraceLevel;   /* Trace Level for Inner Interpreter. */
-cell_t          gVarTraceStack;   /* Dump Stack each time if true. */
-cell_t          gVarTraceFlags;   /* Enable various internal debug messages. */
+PF_THREAD_LOCAL cell_t          gVarEcho;         /* Echo input. */
+PF_THREAD_LOCAL cell_t          gVarTraceLevel;   /* Trace Level for Inner Interpreter. */
+PF_THREAD_LOCAL cell_t          gVarTraceStack;   /* Dump Stack each time if true. */
+PF_THREAD_LOCAL cell_t          gVarTraceFlags;   /* Enable various internal debug messages. */
 cell_t          gVarQuiet;        /* Suppress unnecessary messages, OK, etc. */
 cell_t          gVarReturnCode;   /* Returned to caller of Forth, eg. UNIX shell. */
+cell_t          gVarParGrain;     /* Indices per chunk for PAR-DO, 0 for automatic. */
+cell_t          gVarDicCompress;  /* Compress names and code in SAVE-FORTH. */
+cell_t          gVarPHeapActive;  /* ALLOCATE from the persistent heap. */
+cell_t          gVarHeapTrack;    /* Track ALLOCATE for HEAP-LEAKS. */
+
+/* Batch mode reads stdin like a file and stops at its end. Set by pfSetBatch(). */
+cell_t          gBatchMode;
+#ifndef PF_MAX_EVALUATE
+#define PF_MAX_EVALUATE  (32)
+#endif
+static const char *gEvaluateLines[PF_MAX_EVALUATE]; /* From -e on the command line. */
+static cell_t      gNumEvaluateLines;
 
 /* data for INCLUDE that allows multiple nested files. */
-IncludeFrame    gIncludeStack[MAX_INCLUDE_DEPTH];
-cell_t          gIncludeIndex;
+PF_THREAD_LOCAL IncludeFrame    gIncludeStack[MAX_INCLUDE_DEPTH];
+PF_THREAD_LOCAL cell_t          gIncludeIndex;
 
 static void pfResetForthTask( void );
+static void pfInitThreadGlobals( void );
 static void pfInit( void );
+static void pfParStop( void );
 static void pfTerm( void );
 
 #define DEFAULT_RETURN_DEPTH (512)
@@ -91,32 +107,45 @@ static void pfTerm( void );
 /* Initialize globals in a function to simplify loading on
  * embedded systems which may not support initialization of data section.
  */
-static void pfInit( void )
+static void pfInitThreadGlobals( void )
 {
 /* all zero */
     gCurrentTask = NULL;
-    gCurrentDictionary = NULL;
-    gNumPrimitives = 0;
+    gTaskList = NULL;
     gLocalCompiler_XT = 0;
-    gVarContext = (cell_t)NULL;   /* Points to last name field. */
     gVarState = 0;        /* 1 if compiling. */
-    gVarByeCode = 0;      /* BYE-CODE */
     gVarEcho = 0;         /* Echo input. */
     gVarTraceLevel = 0;   /* Trace Level for Inner Interpreter. */
     gVarTraceFlags = 0;   /* Enable various internal debug messages. */
-    gVarReturnCode = 0;   /* Returned to caller of Forth, eg. UNIX shell. */
     gIncludeIndex = 0;
 
 /* non-zero */
     gVarBase = 10;        /* Numeric Base. */
     gDepthAtColon = DEPTH_AT_COLON_INVALID;
     gVarTraceStack = 1;
+}
+
+static void pfInit( void )
+{
+    pfInitThreadGlobals();
+
+/* all zero */
+    gCurrentDictionary = NULL;
+    gNumPrimitives = 0;
+    gVarContext = (cell_t)NULL;   /* Points to last name field. */
+    gVarByeCode = 0;      /* BYE-CODE */
+    gVarReturnCode = 0;   /* Returned to caller of Forth, eg. UNIX shell. */
+    gVarParGrain = 0;
+    gVarDicCompress = 0;
+    gVarPHeapActive = 0;
+    gVarHeapTrack = 0;
 
     pfInitMemoryAllocator();
     ioInit();
 }
 static void pfTerm( void )
 {
+    pfRaylibTerm();
     ioTerm();
 }
 
@@ -129,6 +158,9 @@ void pfDeleteTask( PForthTask task )
     pfTaskData_t *cftd = (pfTaskData_t *)task;
     FREE_VAR( cftd->td_ReturnLimit );
     FREE_VAR( cftd->td_StackLimit );
+#ifdef PF_SUPPORT_FP
+    FREE_VAR( cftd->td_FloatStackLimit );
+#endif
     pfFreeMem( cftd );
 }
 
@@ -169,6 +201,7 @@ PForthTask pfCreateTask( cell_t UserStackDepth, cell_t ReturnStackDepth )
 
     cftd->td_SourcePtr = &cftd->td_TIB[0];
     cftd->td_SourceNum = 0;
+    cftd->td_HLD = (cell_t) &cftd->td_Pad[PF_HOLD_SIZE];
 
     return (PForthTask) cftd;
 
@@ -204,6 +237,8 @@ void pfDeleteDictionary( PForthDictionary dictionary )
     pfDictionary_t *dic = (pfDictionary_t *) dictionary;
     if( !dic ) return;
 
+    pfBufferFreeAll();
+    pfZStringFreeAll();
     if( dic->dic_Flags & PF_DICF_ALLOCATED_SEGMENTS )
     {
         FREE_VAR( dic->dic_HeaderBaseUnaligned );
@@ -268,6 +303,457 @@ nomem:
     return NULL;
 }
 
+/***************************************************************
+** Cooperative multitasking.
+**
+** Background tasks are kept in gTaskList. When the main task calls
+** PAUSE, pfRunTasks() runs each awake task in turn until it calls
+** PAUSE itself, returns from its word, or throws.
+** Each task runs in its own call to pfCatch() so switching tasks
+** only saves and loads the stack pointers in pfTaskData_t.
+***************************************************************/
+
+/* Create a sleeping task that will run XT when woken. Returns NULL if out of memory. */
+PForthTask pfCreateBackgroundTask( ExecToken XT )
+{
+    pfTaskData_t *cftd, **link;
+
+    cftd = (pfTaskData_t *) pfCreateTask( DEFAULT_USER_DEPTH, DEFAULT_RETURN_DEPTH );
+    if( cftd == NULL ) return NULL;
+    cftd->td_TaskXT = XT;
+    cftd->td_TaskState = TASK_ASLEEP;
+
+/* Append so tasks run in the order they were created. */
+    link = &gTaskList;
+    while( *link != NULL ) link = &(*link)->td_NextTask;
+    *link = cftd;
+    return (PForthTask) cftd;
+}
+
+static void pfDeleteBackgroundTasks( void )
+{
+    pfTaskData_t *cftd;
+    while( gTaskList != NULL )
+    {
+        cftd = gTaskList;
+        gTaskList = cftd->td_NextTask;
+        pfDeleteTask( (PForthTask) cftd );
+    }
+}
+
+/* Run every awake background task once.
+** A task that returns from its word, or throws, goes back to sleep.
+** Returns the first THROW code from a task, or 0.
+*/
+ThrowCode pfRunTasks( void )
+{
+    pfTaskData_t *mainTask = gCurrentTask;
+    pfTaskData_t *cftd;
+    ThrowCode Result = 0;
+
+#ifdef PF_SUPPORT_THREADS
+/* Nothing to run so let other threads run, eg. one we are waiting for on a channel. */
+    if( gTaskList == NULL ) sdYieldThread();
+#endif
+
+    for( cftd = gTaskList; (cftd != NULL) && (Result == 0); cftd = cftd->td_NextTask )
+    {
+        if( cftd->td_TaskState != TASK_AWAKE ) continue;
+        if( cftd->td_WaitFrames > 0 )
+        {
+            cftd->td_WaitFrames -= 1;
+            continue;
+        }
+
+        gCurrentTask = cftd;
+/* PAUSE only stops a task whose pfCatch() started at the bottom of the return stack. */
+        cftd->td_ReturnPtr = cftd->td_ReturnBase;
+        if( cftd->td_PausedReturnPtr == NULL )
+        {
+            cftd->td_StackPtr = cftd->td_StackBase;
+#ifdef PF_SUPPORT_FP
+            cftd->td_FloatStackPtr = cftd->td_FloatStackBase;
+#endif
+            Result = pfCatch( cftd->td_TaskXT );
+        }
+        else
+        {
+            Result = pfCatch( ID_TASK_RESUME );
+        }
+        if( cftd->td_PausedReturnPtr == NULL ) cftd->td_TaskState = TASK_ASLEEP;
+    }
+
+    gCurrentTask = mainTask;
+    return Result;
+}
+
+/***************************************************************
+** OS threads.
+**
+** Each thread runs one word with its own task, BASE, STATE, TIB and
+** include stack. The dictionary is shared. Compiling takes the
+** dictionary lock, see pfLockDictionary().
+***************************************************************/
+
+#ifdef PF_SUPPORT_THREADS
+typedef struct pfThread_s
+{
+    cell_t        th_Handle;  /* From sdCreateThread() */
+    pfTaskData_t *th_Task;
+    ExecToken     th_XT;
+    cell_t        th_Base;    /* BASE of the thread that called THREAD */
+    ThrowCode     th_Result;
+} pfThread_t;
+
+static void *pfThreadMain( void *arg )
+{
+    pfThread_t *th = (pfThread_t *) arg;
+
+    pfInitThreadGlobals();
+    gVarBase = th->th_Base;
+    gCurrentTask = th->th_Task;
+
+    th->th_Result = pfCatch( th->th_XT );
+
+/* Do not leave the dictionary locked if XT threw in the middle of a definition. */
+    pfReleaseDictionary();
+    pfDeleteBackgroundTasks();
+    ioFlush();
+    return NULL;
+}
+#endif /* PF_SUPPORT_THREADS */
+
+/* Run XT on a new OS thread. Returns a handle for pfJoinThread() or 0. */
+cell_t pfCreateThread( ExecToken XT )
+{
+#ifdef PF_SUPPORT_THREADS
+    pfThread_t *th;
+
+    th = (pfThread_t *) pfAllocMem( sizeof(pfThread_t) );
+    if( th == NULL ) return 0;
+    pfSetMemory( th, 0, sizeof(pfThread_t) );
+    th->th_Task = (pfTaskData_t *) pfCreateTask( DEFAULT_USER_DEPTH, DEFAULT_RETURN_DEPTH );
+    if( th->th_Task == NULL ) goto error;
+    th->th_XT = XT;
+    th->th_Base = gVarBase;
+    th->th_Handle = sdCreateThread( pfThreadMain, th );
+    if( th->th_Handle == 0 ) goto error;
+    return (cell_t) th;
+
+error:
+    if( th->th_Task ) pfDeleteTask( (PForthTask) th->th_Task );
+    pfFreeMem( th );
+#else
+    (void) XT;
+#endif /* PF_SUPPORT_THREADS */
+    return 0;
+}
+
+/* Wait for a thread to finish then free it. Returns its THROW code. */
+ThrowCode pfJoinThread( cell_t Thread )
+{
+#ifdef PF_SUPPORT_THREADS
+    pfThread_t *th = (pfThread_t *) Thread;
+    ThrowCode Result;
+
+    if( sdJoinThread( th->th_Handle ) ) return THROW_UNSUPPORTED;
+    Result = th->th_Result;
+    pfDeleteTask( (PForthTask) th->th_Task );
+    pfFreeMem( th );
+    return Result;
+#else
+    (void) Thread;
+    return THROW_UNSUPPORTED;
+#endif /* PF_SUPPORT_THREADS */
+}
+
+/***************************************************************
+** Parallel loops for PAR-DO and PAR-MAP.
+**
+** A fixed pool of workers is started the first time it is needed,
+** one per processor. The calling thread is worker 0. Each worker has
+** its own task and starts with an equal share of the indices. It takes
+** PAR-GRAIN indices at a time from the front of its share. When its
+** share is empty it steals the back half of the largest share left.
+** The first THROW stops all workers and is returned to the caller.
+**
+** Without PF_SUPPORT_THREADS there is only worker 0.
+** A PAR-DO inside a worker, or while another thread has the pool,
+** runs in the calling task one index at a time.
+***************************************************************/
+
+#define PF_PAR_MAX_WORKERS  (16)
+
+typedef struct pfParWorker_s
+{
+    cell_t        pw_Next;     /* Next index to run. */
+    cell_t        pw_Limit;    /* One past last index in our share. */
+    pfTaskData_t *pw_Task;
+    cell_t        pw_Thread;   /* From sdCreateThread(), 0 for worker 0. */
+    cell_t        pw_JobsSeen;
+} pfParWorker_t;
+
+/* Guarded by PF_LOCK_PARALLEL. */
+static pfParWorker_t gParWorkers[PF_PAR_MAX_WORKERS];
+static cell_t    gParNumWorkers;  /* 0 until first use. */
+static cell_t    gParActive;      /* True while a job is running. */
+static cell_t    gParJobCount;    /* Incremented to start the workers. */
+static cell_t    gParNumBusy;     /* Workers still running the job, not counting worker 0. */
+static cell_t    gParQuit;
+static ThrowCode gParResult;
+
+/* Set before the job starts. */
+static ExecToken gParXT;
+static cell_t   *gParSrc;
+static cell_t   *gParDst;
+static cell_t    gParGrain;
+
+#ifdef PF_SUPPORT_THREADS
+    #define LOCK_PARALLEL    sdLock( PF_LOCK_PARALLEL )
+    #define UNLOCK_PARALLEL  sdUnlock( PF_LOCK_PARALLEL )
+#else
+    #define LOCK_PARALLEL    /* noop */
+    #define UNLOCK_PARALLEL  /* noop */
+#endif
+
+/* Get the next chunk of indices for a worker. Returns 0 when there are none left. */
+static int pfParTakeChunk( pfParWorker_t *pw, cell_t *LoPtr, cell_t *HiPtr )
+{
+    pfParWorker_t *victim = NULL;
+    cell_t i, left, most = 0;
+    int found = 0;
+
+    LOCK_PARALLEL;
+    if( gParResult == 0 )
+    {
+        if( pw->pw_Next >= pw->pw_Limit )
+        {
+/* Steal the back half of the largest share. */
+            for( i=0; i<gParNumWorkers; i++ )
+            {
+                left = gParWorkers[i].pw_Limit - gParWorkers[i].pw_Next;
+                if( left > most )
+                {
+                    most = left;
+                    victim = &gParWorkers[i];
+                }
+            }
+            if( victim != NULL )
+            {
+                pw->pw_Limit = victim->pw_Limit;
+                pw->pw_Next = victim->pw_Next + (most / 2);
+                victim->pw_Limit = pw->pw_Next;
+            }
+        }
+        if( pw->pw_Next < pw->pw_Limit )
+        {
+            *LoPtr = pw->pw_Next;
+            pw->pw_Next += gParGrain;
+            if( pw->pw_Next > pw->pw_Limit ) pw->pw_Next = pw->pw_Limit;
+            *HiPtr = pw->pw_Next;
+            found = 1;
+        }
+    }
+    UNLOCK_PARALLEL;
+    return found;
+}
+
+/* Run chunks until there are none left. */
+static void pfParRunWorker( pfParWorker_t *pw )
+{
+    pfTaskData_t *savedTask = gCurrentTask;
+    pfTaskData_t *cftd = pw->pw_Task;
+    ThrowCode Result = 0;
+    cell_t lo, hi;
+
+    gCurrentTask = cftd;
+    while( (Result == 0) && pfParTakeChunk( pw, &lo, &hi ) )
+    {
+        for( ; lo < hi; lo++ )
+        {
+            cftd->td_StackPtr = cftd->td_StackBase;
+#ifdef PF_SUPPORT_FP
+            cftd->td_FloatStackPtr = cftd->td_FloatStackBase;
+#endif
+            cftd->td_ReturnPtr = cftd->td_ReturnBase;
+            *(--cftd->td_StackPtr) = (gParSrc == NULL) ? lo : gParSrc[lo];
+            Result = pfCatch( gParXT );
+            if( Result != 0 )
+            {
+                LOCK_PARALLEL;
+                if( gParResult == 0 ) gParResult = Result;
+                UNLOCK_PARALLEL;
+                break;
+            }
+            if( gParDst != NULL )
+            {
+                gParDst[lo] = (cftd->td_StackPtr < cftd->td_StackBase) ? *cftd->td_StackPtr : 0;
+            }
+        }
+    }
+    gCurrentTask = savedTask;
+}
+
+/* Run XT in the current task for each index. */
+static ThrowCode pfParSerial( ExecToken XT, cell_t *Src, cell_t *Dst, cell_t NumItems )
+{
+    cell_t *savedStackPtr = gCurrentTask->td_StackPtr;
+    ThrowCode Result = 0;
+    cell_t i;
+
+    for( i=0; (i<NumItems) && (Result == 0); i++ )
+    {
+        *(--gCurrentTask->td_StackPtr) = (Src == NULL) ? i : Src[i];
+        Result = pfCatch( XT );
+        if( (Result == 0) && (Dst != NULL) )
+        {
+            Dst[i] = (gCurrentTask->td_StackPtr < savedStackPtr) ? *gCurrentTask->td_StackPtr : 0;
+        }
+        gCurrentTask->td_StackPtr = savedStackPtr;
+    }
+    return Result;
+}
+
+#ifdef PF_SUPPORT_THREADS
+static void *pfParWorkerMain( void *arg )
+{
+    pfParWorker_t *pw = (pfParWorker_t *) arg;
+
+    pfInitThreadGlobals();
+
+    LOCK_PARALLEL;
+    for(;;)
+    {
+        while( !gParQuit && (pw->pw_JobsSeen == gParJobCount) ) sdWaitCondition( PF_LOCK_PARALLEL );
+        if( gParQuit ) break;
+        pw->pw_JobsSeen = gParJobCount;
+        UNLOCK_PARALLEL;
+
+        pfParRunWorker( pw );
+        ioFlush();
+
+        LOCK_PARALLEL;
+        if( --gParNumBusy == 0 ) sdSignalCondition( PF_LOCK_PARALLEL );
+    }
+    UNLOCK_PARALLEL;
+    return NULL;
+}
+#endif /* PF_SUPPORT_THREADS */
+
+/* Start the workers. Returns the number started. */
+static cell_t pfParStart( void )
+{
+    cell_t i, num = 1;
+    pfParWorker_t *pw;
+
+#ifdef PF_SUPPORT_THREADS
+    num = sdNumProcessors();
+    if( num > PF_PAR_MAX_WORKERS ) num = PF_PAR_MAX_WORKERS;
+#endif
+    for( i=0; i<num; i++ )
+    {
+        pw = &gParWorkers[i];
+        pfSetMemory( pw, 0, sizeof(pfParWorker_t) );
+        pw->pw_Task = (pfTaskData_t *) pfCreateTask( DEFAULT_USER_DEPTH, DEFAULT_RETURN_DEPTH );
+        if( pw->pw_Task == NULL ) break;
+#ifdef PF_SUPPORT_THREADS
+        if( i > 0 )
+        {
+            pw->pw_JobsSeen = gParJobCount;
+            pw->pw_Thread = sdCreateThread( pfParWorkerMain, pw );
+            if( pw->pw_Thread == 0 )
+            {
+                pfDeleteTask( (PForthTask) pw->pw_Task );
+                break;
+            }
+        }
+#endif
+    }
+    gParNumWorkers = i;
+    return i;
+}
+
+/* Stop the workers and free their tasks. */
+static void pfParStop( void )
+{
+    cell_t i;
+
+    LOCK_PARALLEL;
+    gParQuit = 1;
+#ifdef PF_SUPPORT_THREADS
+    sdSignalCondition( PF_LOCK_PARALLEL );
+#endif
+    UNLOCK_PARALLEL;
+
+    for( i=0; i<gParNumWorkers; i++ )
+    {
+#ifdef PF_SUPPORT_THREADS
+        if( gParWorkers[i].pw_Thread ) sdJoinThread( gParWorkers[i].pw_Thread );
+#endif
+        pfDeleteTask( (PForthTask) gParWorkers[i].pw_Task );
+    }
+    gParNumWorkers = 0;
+    gParQuit = 0;
+}
+
+/* Call XT for each index from 0 to NumItems-1.
+** If Src is not NULL then Src[i] is passed instead of i.
+** If Dst is not NULL then the top of stack is stored in Dst[i].
+** Returns the first THROW code, or 0.
+*/
+ThrowCode pfParallel( ExecToken XT, cell_t *Src, cell_t *Dst, cell_t NumItems )
+{
+    cell_t i, busy;
+
+    if( NumItems <= 0 ) return 0;
+
+    LOCK_PARALLEL;
+    busy = gParActive;
+    gParActive = 1;
+    UNLOCK_PARALLEL;
+    if( busy ) return pfParSerial( XT, Src, Dst, NumItems );
+
+    if( (gParNumWorkers == 0) && (pfParStart() == 0) )
+    {
+        LOCK_PARALLEL;
+        gParActive = 0;
+        UNLOCK_PARALLEL;
+        return pfParSerial( XT, Src, Dst, NumItems );
+    }
+
+    gParXT = XT;
+    gParSrc = Src;
+    gParDst = Dst;
+    gParGrain = gVarParGrain;
+    if( gParGrain <= 0 ) gParGrain = NumItems / (gParNumWorkers * 8);
+    if( gParGrain <= 0 ) gParGrain = 1;
+    gParResult = 0;
+    for( i=0; i<gParNumWorkers; i++ )
+    {
+        gParWorkers[i].pw_Next = (NumItems * i) / gParNumWorkers;
+        gParWorkers[i].pw_Limit = (NumItems * (i + 1)) / gParNumWorkers;
+    }
+
+    LOCK_PARALLEL;
+    gParNumBusy = gParNumWorkers - 1;
+    gParJobCount += 1;
+#ifdef PF_SUPPORT_THREADS
+    sdSignalCondition( PF_LOCK_PARALLEL );
+#endif
+    UNLOCK_PARALLEL;
+
+    pfParRunWorker( &gParWorkers[0] );
+
+    LOCK_PARALLEL;
+#ifdef PF_SUPPORT_THREADS
+    while( gParNumBusy > 0 ) sdWaitCondition( PF_LOCK_PARALLEL );
+#endif
+    gParActive = 0;
+    UNLOCK_PARALLEL;
+
+    return gParResult;
+}
+
 /***************************************************************
 ** Used by Quit and other routines to restore system.
 ***************************************************************/
@@ -287,6 +773,7 @@ static void pfResetForthTask( void )
 /* Advance >IN to end of input. */
     gCurrentTask->td_IN = gCurrentTask->td_SourceNum;
     gVarState = 0;
+    pfReleaseDictionary();
 }
 
 /***************************************************************
@@ -316,6 +803,55 @@ cell_t  pfQueryQuiet( void )
     return gVarQuiet;
 }
 
+/***************************************************************
+** Set Batch Flag.
+***************************************************************/
+
+void pfSetBatch( cell_t IfBatch )
+{
+    gBatchMode = IfBatch ? FTRUE : FFALSE;
+}
+
+/***************************************************************
+** Add a line of Forth to be interpreted after the source file.
+** The string is not copied. Return 0 or -1 if there are too many.
+***************************************************************/
+
+cell_t pfAddEvaluate( const char *Line )
+{
+    if( gNumEvaluateLines >= PF_MAX_EVALUATE ) return -1;
+    gEvaluateLines[gNumEvaluateLines++] = Line;
+    return 0;
+}
+
+/***************************************************************
+** Interpret the lines from pfAddEvaluate() using EVALUATE.
+** Stop at the first error and report it.
+***************************************************************/
+
+static ThrowCode pfEvaluateLines( void )
+{
+    ThrowCode Result = 0;
+    ExecToken EvaluateXT;
+    cell_t i;
+
+    if( gNumEvaluateLines == 0 ) return 0;
+    if( !ffFindC( "EVALUATE", &EvaluateXT ) ) return THROW_UNDEFINED_WORD;
+
+    for( i=0; i<gNumEvaluateLines; i++ )
+    {
+        PUSH_DATA_STACK( (cell_t) gEvaluateLines[i] );
+        PUSH_DATA_STACK( (cell_t) pfCStringLength( gEvaluateLines[i] ) );
+        Result = pfCatch( EvaluateXT );
+        if( Result != 0 )
+        {
+            if( Result != THROW_BYE ) pfReportThrow( Result );
+            break;
+        }
+    }
+    return Result;
+}
+
 /***************************************************************
 ** Top level interpreter.
 ***************************************************************/
@@ -335,6 +871,8 @@ ThrowCode pfQuit( void )
         switch( exception )
         {
         case 0:
+/* Only reached at the end of stdin in batch mode. */
+            if( gBatchMode ) go = 0;
             break;
 
         case THROW_BYE:
@@ -347,6 +885,8 @@ ThrowCode pfQuit( void )
             pfReportThrow( exception );
             pfHandleIncludeError();
             pfResetForthTask();
+/* A filter should not carry on after an error. */
+            if( gBatchMode ) return exception;
             break;
         }
     }
@@ -545,12 +1085,7 @@ ThrowCode pfDoForth( const char *DicFileName, const char *SourceName, cell_t IfI
 #ifndef PF_NO_SHELL
         else
         {
-            if( SourceName == NULL )
-            {
-                pfDebugMessage("pfDoForth: pfQuit\n");
-                Result = pfQuit();
-            }
-            else
+            if( SourceName != NULL )
             {
                 if( !gVarQuiet )
                 {
@@ -560,12 +1095,26 @@ ThrowCode pfDoForth( const char *DicFileName, const char *SourceName, cell_t IfI
                 }
                 Result = pfIncludeFile( SourceName );
             }
+            if( Result == 0 )
+            {
+                Result = pfEvaluateLines();
+            }
+            if( (Result == 0) && (SourceName == NULL) )
+            {
+                pfDebugMessage("pfDoForth: pfQuit\n");
+                Result = pfQuit();
+            }
+/* BYE is not an error. Return BYE-CODE. */
+            if( Result == THROW_BYE ) Result = 0;
         }
 #endif /* PF_NO_SHELL */
 
     /* Clean up after running Forth. */
         pfExecIfDefined("AUTO.TERM");
         pfDeleteDictionary( dic );
+        pfDeleteBackgroundTasks();
+        pfParStop();
+        pfTermFileRequests();
         pfDeleteTask( cftd );
     }
 
@@ -592,6 +1141,7 @@ cell_t pfUnitTest( void )
 {
     cell_t numErrors = 0;
     numErrors += pfUnitTestText();
+    numErrors += pfUnitTestChars();
     return numErrors;
 }
 #endif
@@ -33,6 +33,13 @@ void   pfDebugPrintDecimalNumber( int n );
 
 cell_t pfUnitTestText( void );
 
+PForthTask pfCreateBackgroundTask( ExecToken XT );
+ThrowCode  pfRunTasks( void );
+
+cell_t     pfCreateThread( ExecToken XT );
+ThrowCode  pfJoinThread( cell_t Thread );
+ThrowCode  pfParallel( ExecToken XT, cell_t *Src, cell_t *Dst, cell_t NumItems );
+
 #ifdef __cplusplus
 }
 #endif
@@ -4,7 +4,6 @@
 
 #include "pf_io.h"
 #include "pf_float.h"
-#include "pf_raylib.h"
 
 /***************************************************************
 ** Include file for PForth, a Forth based on 'C'
@@ -60,15 +59,47 @@
 ** FV8 - 980818 - Added Endian flag.
 ** FV9 - 20100503 - Added support for 64-bit CELL.
 ** FV10 - 20170103 - Added ID_FILE_FLUSH ID_FILE_RENAME ID_FILE_RESIZE
+** FV11 - 20261019 - Added typed array words, which moved the Raylib IDs.
+** FV12 - 20261019 - Added ID_D_STAR ID_D_MSTARSLASH ID_D_SLASHMOD
+** FV13 - 20261019 - Added multitasking words, ran out of reserved.
+** FV14 - 20261019 - Added ID_THREAD ID_JOIN_THREAD
+** FV15 - 20261019 - Added ID_PAR_DO ID_PAR_MAP ID_VAR_PAR_GRAIN
+** FV16 - 20261019 - Added channel words.
+** FV17 - 20261019 - Added asynchronous file words.
+** FV18 - 20261019 - Added ID_FILE_MAP ID_FILE_UNMAP ID_FILE_SYNC_MAPPED
+** FV19 - 20261019 - Added ID_VAR_BATCH
+** FV20 - 20261019 - Added ID_INCLUDE_CACHE
+** FV21 - 20261019 - Added ID_SAVE_DELTA_P
+** FV22 - 20261019 - Added ID_VAR_DIC_COMPRESS
+** FV23 - 20261019 - Added ID_ARENA ID_ARENA_ALLOT ID_ARENA_MARK ID_ARENA_RELEASE ID_ARENA_RESET
+** FV24 - 20261019 - Added ID_POOL ID_POOL_GET ID_POOL_PUT ID_POOL_EACH
+** FV25 - 20261019 - Added ID_HEAP_STATS ID_HEAP_LEAKS ID_HEAP_DUMP
+** FV26 - 20261019 - Added ID_PHEAP_OPEN ID_PHEAP_CLOSE ID_PHEAP_SYNC ID_PHEAP_ROOT_STORE
+**                    ID_PHEAP_ROOT_FETCH ID_PHEAP_REL ID_PHEAP_ABS ID_VAR_PHEAP_ACTIVE
+** FV27 - 20261019 - Added ID_BUFFER_COLON_P ID_BUFFER_P
+** FV28 - 20261019 - Replaced the raylib IDs with ID_RL_* generated from "raylib.h".
+**                    A dictionary only works with the raylib.h it was built with.
+** FV29 - 20261019 - Added ID_HANDLE_TO_ADDR. raylib resources are handles.
+** FV30 - 20261019 - Added ID_VAR_DRAW_BATCH
+** FV31 - 20261019 - Added ID_TO_ZSTRING
+** FV32 - 20261019 - Added ID_ALLOT ID_COMMA ID_C_COMMA ID_W_COMMA ID_ALIGN
+** FV33 - 20261019 - Added ID_VAR_HEAP_TRACK
+** FV34 - 20261019 - Added ID_UTIME
+** FV35 - 20261019 - Added sd_RaylibHash to the dictionary info
+** FV36 - 20261019 - Added ID_VAR_HLD ID_PAD
+** FV37 - 20261019 - Removed ID_VAR_DRAW_BATCH
 */
-#define PF_FILE_VERSION (10)   /* Bump this whenever primitives added. */
-#define PF_EARLIEST_FILE_VERSION (9)  /* earliest one still compatible */
+#define PF_FILE_VERSION (37)   /* Bump this whenever primitives added. */
+#define PF_EARLIEST_FILE_VERSION (37)  /* earliest one still compatible */
 
 /***************************************************************
 ** Sizes and other constants
 ***************************************************************/
 
 #define TIB_SIZE (256)
+/* Pictured numeric output is built down from PAD, see "numberio.fth". */
+#define PF_HOLD_SIZE (2 * 8 * sizeof(cell_t) + 16)
+#define PF_PAD_SIZE (TIB_SIZE)
 
 #ifndef FALSE
     #define FALSE (0)
@@ -77,6 +108,13 @@
     #define TRUE (1)
 #endif
 
+/* State of each Forth interpreter is kept per OS thread. See THREAD. */
+#ifdef PF_SUPPORT_THREADS
+    #define PF_THREAD_LOCAL _Thread_local
+#else
+    #define PF_THREAD_LOCAL
+#endif
+
 #define FFALSE (0)
 #define FTRUE (-1)
 #define SPACE_CHARACTER (' ')
@@ -311,18 +349,70 @@ enum cforth_primitive_ids
     ID_SLEEP_P,        /* (SLEEP) V2.0.0 */
     ID_VAR_BYE_CODE,   /* BYE-CODE */
     ID_VERSION_CODE,
-/* If you add a word here, take away one reserved word below. */
+    ID_D_STAR,         /* D* */
+    ID_D_MSTARSLASH,   /* M star slash */
+    ID_D_SLASHMOD,     /* D/MOD */
+    ID_PAUSE,          /* PAUSE */
+    ID_WAIT_FRAMES,    /* WAIT-FRAMES */
+    ID_TASK_CREATE,    /* (TASK) */
+    ID_TASK_WAKE,      /* WAKE */
+    ID_TASK_SLEEP,     /* SLEEP */
+    ID_TASK_RESUME,    /* No name. Used by pfRunTasks() to continue a task. */
+    ID_THREAD,         /* THREAD */
+    ID_JOIN_THREAD,    /* JOIN-THREAD */
+    ID_PAR_DO,         /* PAR-DO */
+    ID_PAR_MAP,        /* PAR-MAP */
+    ID_VAR_PAR_GRAIN,  /* PAR-GRAIN */
+    ID_CHANNEL,        /* CHANNEL */
+    ID_TRY_SEND,       /* TRY-SEND */
+    ID_TRY_RECV,       /* TRY-RECV */
+    ID_TRY_SEND_N,     /* TRY-SEND-N */
+    ID_TRY_RECV_N,     /* TRY-RECV-N */
+    ID_FILE_READ_ASYNC,   /* READ-FILE-ASYNC */
+    ID_FILE_WRITE_ASYNC,  /* WRITE-FILE-ASYNC */
+    ID_REQ_DONEQ,      /* REQ-DONE? */
+    ID_REQ_WAIT,       /* REQ-WAIT */
+    ID_FILE_MAP,       /* MAP-FILE */
+    ID_FILE_UNMAP,     /* UNMAP-FILE */
+    ID_FILE_SYNC_MAPPED,  /* SYNC-MAPPED */
+    ID_VAR_BATCH,      /* BATCH */
+    ID_INCLUDE_CACHE,  /* INCLUDE-CACHE */
+    ID_SAVE_DELTA_P,   /* (SAVE-DELTA) */
+    ID_VAR_DIC_COMPRESS,  /* DIC-COMPRESS */
+    ID_ARENA,
+    ID_ARENA_ALLOT,
+    ID_ARENA_MARK,
+    ID_ARENA_RELEASE,
+    ID_ARENA_RESET,
+    ID_POOL,
+    ID_POOL_GET,
+    ID_POOL_PUT,
+    ID_POOL_EACH,
+    ID_HEAP_STATS,
+    ID_HEAP_LEAKS,
+    ID_HEAP_DUMP,
+    ID_PHEAP_OPEN,
+    ID_PHEAP_CLOSE,
+    ID_PHEAP_SYNC,
+    ID_PHEAP_ROOT_STORE,
+    ID_PHEAP_ROOT_FETCH,
+    ID_PHEAP_REL,
+    ID_PHEAP_ABS,
+    ID_VAR_PHEAP_ACTIVE,
+    ID_BUFFER_COLON_P,
+    ID_BUFFER_P,
+    ID_HANDLE_TO_ADDR,
+    ID_TO_ZSTRING,
+    ID_ALLOT,
+    ID_COMMA,
+    ID_C_COMMA,
+    ID_W_COMMA,
+    ID_ALIGN,
+    ID_VAR_HEAP_TRACK,
+    ID_UTIME,
+    ID_VAR_HLD,
+    ID_PAD,
 #ifdef PF_SUPPORT_FP
-/* Only reserve space if we are adding FP so that we can detect
-** unsupported primitives when loading dictionary.
-*/
-    ID_RESERVED03,
-    ID_RESERVED04,
-    ID_RESERVED05,
-    ID_RESERVED06,
-    ID_RESERVED07,
-    ID_RESERVED08,
-    ID_RESERVED09,
     ID_FP_D_TO_F,
     ID_FP_FSTORE,
     ID_FP_FTIMES,
@@ -371,10 +461,60 @@ enum cforth_primitive_ids
     ID_FP_FTAN,
     ID_FP_FTANH,
     ID_FP_FPICK,
+/* Typed array words. */
+    ID_FP_DFV_PLUS,
+    ID_FP_DFV_MINUS,
+    ID_FP_DFV_TIMES,
+    ID_FP_DFV_PLUS_S,
+    ID_FP_DFV_MINUS_S,
+    ID_FP_DFV_TIMES_S,
+    ID_FP_DFV_FMA,
+    ID_FP_DFV_FMA_S,
+    ID_FP_DFV_DOT,
+    ID_FP_DFV_SUM,
+    ID_FP_DFV_MIN,
+    ID_FP_DFV_MAX,
+    ID_FP_DFV_CLAMP,
+    ID_FP_SFV_PLUS,
+    ID_FP_SFV_MINUS,
+    ID_FP_SFV_TIMES,
+    ID_FP_SFV_PLUS_S,
+    ID_FP_SFV_MINUS_S,
+    ID_FP_SFV_TIMES_S,
+    ID_FP_SFV_FMA,
+    ID_FP_SFV_FMA_S,
+    ID_FP_SFV_DOT,
+    ID_FP_SFV_SUM,
+    ID_FP_SFV_MIN,
+    ID_FP_SFV_MAX,
+    ID_FP_SFV_CLAMP,
+    ID_FP_IV_PLUS,
+    ID_FP_IV_MINUS,
+    ID_FP_IV_TIMES,
+    ID_FP_IV_PLUS_S,
+    ID_FP_IV_MINUS_S,
+    ID_FP_IV_TIMES_S,
+    ID_FP_IV_FMA,
+    ID_FP_IV_FMA_S,
+    ID_FP_IV_DOT,
+    ID_FP_IV_SUM,
+    ID_FP_IV_MIN,
+    ID_FP_IV_MAX,
+    ID_FP_IV_CLAMP,
+    ID_FP_CELLS_TO_DFV,
+    ID_FP_DFV_TO_CELLS,
+    ID_FP_CELLS_TO_SFV,
+    ID_FP_SFV_TO_CELLS,
+    ID_FP_CELLS_TO_IV,
+    ID_FP_IV_TO_CELLS,
+    ID_FP_SFV_TO_DFV,
+    ID_FP_DFV_TO_SFV,
 #endif
 
-    /* Add the Raylib XT values */
-    RAYLIB_XT_VALUES,
+/* raylib words, generated from "raylib.h", see "mkraylib.c". */
+#define PF_RAYLIB_IDS
+#include "pf_raylib_api.h"
+#undef PF_RAYLIB_IDS
 
 /* Add new IDs by replacing reserved IDs or extending FP routines. */
 /* Do NOT change the order of these IDs or dictionary files will break! */
@@ -391,11 +531,14 @@ enum cforth_primitive_ids
 #define THROW_ABORT_QUOTE      (-2)
 #define THROW_STACK_OVERFLOW   (-3)
 #define THROW_STACK_UNDERFLOW  (-4)
+#define THROW_DIVIDE_BY_ZERO  (-10)
 #define THROW_UNDEFINED_WORD  (-13)
 #define THROW_EXECUTING       (-14)
+#define THROW_UNSUPPORTED     (-21)
 #define THROW_PAIRS           (-22)
 #define THROW_FLOAT_STACK_UNDERFLOW  ( -45)
 #define THROW_QUIT            (-56)
+#define THROW_ALLOCATE        (-59)
 #define THROW_FLUSH_FILE      (-68)
 #define THROW_RESIZE_FILE     (-74)
 
@@ -403,6 +546,8 @@ enum cforth_primitive_ids
 #define THROW_BYE            (-256) /* Exit program. */
 #define THROW_SEMICOLON      (-257) /* Error detected at ; */
 #define THROW_DEFERRED       (-258) /* Not a deferred word. Used in system.fth */
+#define THROW_PAUSE          (-259) /* Task cannot PAUSE inside CATCH or a C callback. */
+#define THROW_RAYLIB_HANDLE  (-260) /* raylib resource was unloaded or is the wrong type. */
 
 /***************************************************************
 ** Structures
@@ -430,8 +575,20 @@ typedef struct pfTaskData_s
     char   *td_SourcePtr;       /* Pointer to TIB or other source. */
     cell_t   td_LineNumber;      /* Incremented on every refill. */
     cell_t    td_OUT;             /* Current output column. */
+/* Number output. Each task has its own so threads can convert at once. */
+    cell_t    td_HLD;             /* Last character added by HOLD. */
+    char    td_Pad[PF_HOLD_SIZE + PF_PAD_SIZE]; /* PAD is at td_Pad[PF_HOLD_SIZE]. */
+/* Cooperative multitasking. See PAUSE and pfRunTasks(). */
+    struct pfTaskData_s *td_NextTask; /* Next background task. */
+    ExecToken td_TaskXT;          /* Word run by a background task, 0 for the main task. */
+    cell_t    td_TaskState;       /* TASK_ASLEEP or TASK_AWAKE */
+    cell_t    td_WaitFrames;      /* Frames left to skip before running again. */
+    cell_t   *td_PausedReturnPtr; /* Return stack saved by PAUSE, or NULL if not started. */
 } pfTaskData_t;
 
+#define TASK_ASLEEP  (0)
+#define TASK_AWAKE   (1)
+
 typedef struct pfNode
 {
     struct pfNode *n_Next;
@@ -473,6 +630,7 @@ typedef struct pfDictionary_s
 typedef struct IncludeFrame
 {
     FileStream   *inf_FileID;
+    char          *inf_SourcePtr;  /* Not the TIB during EVALUATE */
     cell_t         inf_LineNumber;
     cell_t         inf_SourceNum;
     cell_t         inf_IN;
@@ -498,34 +656,41 @@ ThrowCode pfCatch( ExecToken XT );
 /***************************************************************
 ** External Globals
 ***************************************************************/
-extern pfTaskData_t *gCurrentTask;
+/* PF_THREAD_LOCAL variables belong to one interpreter. The rest are shared. */
+extern PF_THREAD_LOCAL pfTaskData_t *gCurrentTask;
+extern PF_THREAD_LOCAL pfTaskData_t *gTaskList; /* Background tasks, in the order run by PAUSE. */
 extern pfDictionary_t *gCurrentDictionary;
-extern char          gScratch[TIB_SIZE];
+extern PF_THREAD_LOCAL char gScratch[TIB_SIZE];
 extern cell_t         gNumPrimitives;
 
-extern ExecToken     gLocalCompiler_XT;      /* CFA of (LOCAL) compiler. */
+extern PF_THREAD_LOCAL ExecToken gLocalCompiler_XT; /* CFA of (LOCAL) compiler. */
 extern ExecToken     gNumberQ_XT;         /* XT of NUMBER? */
 extern ExecToken     gQuitP_XT;           /* XT of (QUIT) */
 extern ExecToken     gAcceptP_XT;         /* XT of ACCEPT */
 
 #define DEPTH_AT_COLON_INVALID (-100)
-extern cell_t         gDepthAtColon;
+extern PF_THREAD_LOCAL cell_t gDepthAtColon;
 
 /* Global variables. */
 extern cell_t        gVarContext;    /* Points to last name field. */
-extern cell_t        gVarState;      /* 1 if compiling. */
-extern cell_t        gVarBase;       /* Numeric Base. */
+extern PF_THREAD_LOCAL cell_t gVarState; /* 1 if compiling. */
+extern PF_THREAD_LOCAL cell_t gVarBase;  /* Numeric Base. */
 extern cell_t        gVarByeCode;    /* BYE-CODE returned on exit */
-extern cell_t        gVarEcho;       /* Echo input from file. */
+extern PF_THREAD_LOCAL cell_t gVarEcho; /* Echo input from file. */
 extern cell_t        gVarEchoAccept; /* Echo input from ACCEPT. */
-extern cell_t        gVarTraceLevel;
-extern cell_t        gVarTraceStack;
-extern cell_t        gVarTraceFlags;
+extern PF_THREAD_LOCAL cell_t gVarTraceLevel;
+extern PF_THREAD_LOCAL cell_t gVarTraceStack;
+extern PF_THREAD_LOCAL cell_t gVarTraceFlags;
 extern cell_t        gVarQuiet;      /* Suppress unnecessary messages, OK, etc. */
 extern cell_t        gVarReturnCode; /* Returned to caller of Forth, eg. UNIX shell. */
-
-extern IncludeFrame  gIncludeStack[MAX_INCLUDE_DEPTH];
-extern cell_t         gIncludeIndex;
+extern cell_t        gVarParGrain;   /* Indices per chunk for PAR-DO, 0 for automatic. */
+extern cell_t        gVarDicCompress; /* Compress names and code in SAVE-FORTH. */
+extern cell_t        gVarPHeapActive; /* ALLOCATE from the persistent heap. */
+extern cell_t        gVarHeapTrack;  /* Track ALLOCATE for HEAP-LEAKS. */
+extern cell_t        gBatchMode;     /* Read stdin like a file, no terminal setup. */
+
+extern PF_THREAD_LOCAL IncludeFrame gIncludeStack[MAX_INCLUDE_DEPTH];
+extern PF_THREAD_LOCAL cell_t gIncludeIndex;
 /***************************************************************
 ** Macros
 ***************************************************************/
@@ -535,9 +700,46 @@ extern cell_t         gIncludeIndex;
 
 ** different endian-ness.
 
+** If the compiler knows the byte order of the host then a dictionary in the
+** same order is read directly, and one in the other order with a single byte
+** swap. Otherwise every access goes through the functions in pf_save.c.
+** PF_DIC_CONVERT is defined if dictionary cells cannot be read directly.
+
 */
 
+#if defined(PF_BIG_ENDIAN_DIC) || defined(PF_LITTLE_ENDIAN_DIC)
+    #if defined(__GNUC__) && defined(__BYTE_ORDER__)
+        #if (defined(PF_BIG_ENDIAN_DIC) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)) || \
+            (defined(PF_LITTLE_ENDIAN_DIC) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
+            #define PF_DIC_HOST_ORDER
+        #else
+            #define PF_DIC_SWAP_ORDER
+            #define PF_DIC_CONVERT
+        #endif
+    #else
+        #define PF_DIC_CONVERT
+    #endif
+#endif
+
+#if defined(PF_DIC_SWAP_ORDER)
+
+#define PF_SWAP_CELL(x)             ((sizeof(ucell_t) == 8) ? \
+                                     (ucell_t) __builtin_bswap64( (uint64_t)(x) ) : \
+                                     (ucell_t) __builtin_bswap32( (uint32_t)(x) ))
+
 #if defined(PF_BIG_ENDIAN_DIC)
+#define WRITE_FLOAT_DIC             WriteFloatBigEndian
+#define READ_FLOAT_DIC              ReadFloatBigEndian
+#else
+#define WRITE_FLOAT_DIC             WriteFloatLittleEndian
+#define READ_FLOAT_DIC              ReadFloatLittleEndian
+#endif
+#define WRITE_CELL_DIC(addr,data)   { *((ucell_t *)(addr)) = PF_SWAP_CELL(data); }
+#define WRITE_SHORT_DIC(addr,data)  { *((uint16_t *)(addr)) = __builtin_bswap16( (uint16_t)(data) ); }
+#define READ_CELL_DIC(addr)         PF_SWAP_CELL( *((const ucell_t *)(addr)) )
+#define READ_SHORT_DIC(addr)        __builtin_bswap16( *((const uint16_t *)(addr)) )
+
+#elif defined(PF_DIC_CONVERT) && defined(PF_BIG_ENDIAN_DIC)
 
 #define WRITE_FLOAT_DIC             WriteFloatBigEndian
 #define WRITE_CELL_DIC(addr,data)   WriteCellBigEndian((uint8_t *)(addr),(ucell_t)(data))
@@ -546,7 +748,7 @@ extern cell_t         gIncludeIndex;
 #define READ_CELL_DIC(addr)         ReadCellBigEndian((const uint8_t *)(addr))
 #define READ_SHORT_DIC(addr)        Read16BigEndian((const uint8_t *)(addr))
 
-#elif defined(PF_LITTLE_ENDIAN_DIC)
+#elif defined(PF_DIC_CONVERT) && defined(PF_LITTLE_ENDIAN_DIC)
 
 #define WRITE_FLOAT_DIC             WriteFloatLittleEndian
 #define WRITE_CELL_DIC(addr,data)   WriteCellLittleEndian((uint8_t *)(addr),(ucell_t)(data))
@@ -570,6 +772,7 @@ extern cell_t         gIncludeIndex;
 #define HEADER_HERE (gCurrentDictionary->dic_HeaderPtr.Cell)
 #define CODE_HERE (gCurrentDictionary->dic_CodePtr.Cell)
 #define CODE_COMMA( N ) WRITE_CELL_DIC(CODE_HERE++,(N))
+#define CELL_ALIGN( addr ) (((addr) + sizeof(cell_t) - 1) & ~((ucell_t) sizeof(cell_t) - 1))
 #define NAME_BASE (gCurrentDictionary->dic_HeaderBase)
 #define CODE_BASE (gCurrentDictionary->dic_CodeBase)
 #define NAME_SIZE (gCurrentDictionary->dic_HeaderLimit - gCurrentDictionary->dic_HeaderBase)
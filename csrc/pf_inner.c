@@ -32,7 +32,6 @@
 
 #include "raylib.h"
 #include "pf_all.h"
-#include "pf_raylib.h"
 
 #if defined(WIN32) && !defined(__MINGW32__)
 #include <crtdbg.h>
@@ -221,6 +220,171 @@ static int UdIsUint64( ucell_t Hi )
         : Hi == 0);
 }
 
+/***************************************************************
+** Double cell arithmetic.
+** Use a native integer twice as wide as a cell when the compiler has one.
+** Otherwise split each cell into half cell quantities.
+*/
+#if (PF_SIZEOF_CELL == 4)
+    typedef uint64_t udcell_t;
+    #define PF_NATIVE_UDCELL  (1)
+#elif defined(__SIZEOF_INT128__) && !defined(PF_NO_INT128)
+    __extension__ typedef unsigned __int128 udcell_t;
+    #define PF_NATIVE_UDCELL  (1)
+#endif
+
+/* Assume 8-bit char and calculate cell width. */
+#define NBITS ((sizeof(ucell_t)) * 8)
+/* Define half the number of bits in a cell. */
+#define HNBITS (NBITS / 2)
+/* Assume two-complement arithmetic to calculate lower half. */
+#define LOWER_HALF(n) ((n) & (((ucell_t)1 << HNBITS) - 1))
+#define HIGH_BIT ((ucell_t)1 << (NBITS - 1))
+
+#define DULT(du1l,du1h,du2l,du2h) ( (du2h<du1h) ? FALSE : ( (du2h==du1h) ? (du1l<du2l) : TRUE) )
+
+/* Negate the double cell lo/hi in place. */
+#define DNEGATE(lo,hi) \
+    { \
+        (lo) = ~(lo) + 1; \
+        (hi) = ~(hi) + (((lo) == 0) ? 1 : 0); \
+    }
+
+/* Perform cell*cell bit multiply for a 2 cell result.
+ * The portable version factors into half cell quantities,
+ * using an improved algorithm suggested by Steve Green.
+ * Converted to 64-bit by Aleksej Saushev.
+ */
+static void pfUMStar( ucell_t a, ucell_t b, ucell_t *loPtr, ucell_t *hiPtr )
+{
+#ifdef PF_NATIVE_UDCELL
+    udcell_t product = ((udcell_t) a) * b;
+    *loPtr = (ucell_t) product;
+    *hiPtr = (ucell_t) (product >> NBITS);
+#else
+    ucell_t ahi, alo, bhi, blo; /* input parts */
+    ucell_t lo, hi, temp;
+/* Break into hi and lo 16 bit parts. */
+    alo = LOWER_HALF(a);
+    ahi = a >> HNBITS;
+    blo = LOWER_HALF(b);
+    bhi = b >> HNBITS;
+
+    lo = 0;
+    hi = 0;
+/* higher part: ahi * bhi */
+    hi += ahi * bhi;
+/* middle (overlapping) part: ahi * blo */
+    temp = ahi * blo;
+    lo += LOWER_HALF(temp);
+    hi += temp >> HNBITS;
+/* middle (overlapping) part: alo * bhi  */
+    temp = alo * bhi;
+    lo += LOWER_HALF(temp);
+    hi += temp >> HNBITS;
+/* lower part: alo * blo */
+    temp = alo * blo;
+/* its higher half overlaps with middle's lower half: */
+    lo += temp >> HNBITS;
+/* process carry: */
+    hi += lo >> HNBITS;
+    lo = LOWER_HALF(lo);
+/* combine lower part of result: */
+    lo = (lo << HNBITS) + LOWER_HALF(temp);
+
+    *loPtr = lo;
+    *hiPtr = hi;
+#endif
+}
+
+/* Perform 2 cell by 1 cell divide for 1 cell quotient and remainder.
+ * The quotient is only valid if ah < bdiv.
+ * The portable version uses shift and subtract.
+ */
+static ucell_t pfUMSlashMod( ucell_t al, ucell_t ah, ucell_t bdiv, ucell_t *remPtr )
+{
+#ifdef PF_NATIVE_UDCELL
+    udcell_t dividend = (((udcell_t) ah) << NBITS) | al;
+    *remPtr = (ucell_t) (dividend % bdiv);
+    return (ucell_t) (dividend / bdiv);
+#else
+    ucell_t q,di, bl,bh, sl,sh;
+    bh = bdiv;
+    bl = 0;
+    q = 0;
+    for( di=0; di<NBITS; di++ )
+    {
+        if( !DULT(al,ah,bl,bh) )
+        {
+            sh = 0;
+            sl = al - bl;
+            if( al < bl ) sh = 1; /* Borrow */
+            sh = ah - bh - sh;
+            ah = sh;
+            al = sl;
+            q |= 1;
+        }
+        q = q << 1;
+        bl = (bl >> 1) | (bh << (NBITS-1));
+        bh = bh >> 1;
+    }
+    if( !DULT(al,ah,bl,bh) )
+    {
+
+        al = al - bl;
+        q |= 1;
+    }
+    *remPtr = al;
+    return q;
+#endif
+}
+
+/* Perform 2 cell by 2 cell unsigned divide for 2 cell quotient and remainder. */
+static void pfUDSlashMod( ucell_t nl, ucell_t nh, ucell_t dl, ucell_t dh,
+                          ucell_t *qlPtr, ucell_t *qhPtr, ucell_t *rlPtr, ucell_t *rhPtr )
+{
+#ifdef PF_NATIVE_UDCELL
+    udcell_t n = (((udcell_t) nh) << NBITS) | nl;
+    udcell_t d = (((udcell_t) dh) << NBITS) | dl;
+    udcell_t q = n / d;
+    udcell_t r = n % d;
+    *qlPtr = (ucell_t) q;
+    *qhPtr = (ucell_t) (q >> NBITS);
+    *rlPtr = (ucell_t) r;
+    *rhPtr = (ucell_t) (r >> NBITS);
+#else
+    ucell_t rl, rh, carry, di;
+    if( dh == 0 )
+    {
+/* Single cell divisor, so divide one cell at a time. */
+        *qhPtr = nh / dl;
+        *qlPtr = pfUMSlashMod( nl, nh % dl, dl, rlPtr );
+        *rhPtr = 0;
+        return;
+    }
+/* Shift the dividend into the remainder one bit at a time. */
+    rl = rh = 0;
+    for( di=0; di<2*NBITS; di++ )
+    {
+        carry = rh >> (NBITS-1);
+        rh = (rh << 1) | (rl >> (NBITS-1));
+        rl = (rl << 1) | (nh >> (NBITS-1));
+        nh = (nh << 1) | (nl >> (NBITS-1));
+        nl = nl << 1;
+        if( carry || !DULT(rl,rh,dl,dh) )
+        {
+            rh = rh - dh - ((rl < dl) ? 1 : 0); /* Borrow */
+            rl = rl - dl;
+            nl |= 1;
+        }
+    }
+    *qlPtr = nl;
+    *qhPtr = nh;
+    *rlPtr = rl;
+    *rhPtr = rh;
+#endif
+}
+
 static const char *pfSelectFileModeCreate( cell_t fam );
 static const char *pfSelectFileModeOpen( cell_t fam );
 
@@ -466,38 +630,70 @@ DBUG(("pfCatch: Token = 0x%x\n", Token ));
             TOS = (cell_t) LOCAL_CODEREL_TO_ABS( READ_CELL_DIC(InsPtr++) );
             endcase;
 
-/* Allocate some extra and put validation identifier at base */
-#define PF_MEMORY_VALIDATOR  (0xA81B4D69)
-        case ID_ALLOCATE:
-            /* Allocate at least one cell's worth because we clobber first cell. */
-            if ( TOS < sizeof(cell_t) )
-            {
-                Temp = sizeof(cell_t);
-            }
-            else
-            {
-                Temp = TOS;
-            }
-            /* Allocate extra cells worth because we store validation info. */
-            CellPtr = (cell_t *) pfAllocMem( Temp + sizeof(cell_t) );
-            if( CellPtr )
-            {
-/* This was broken into two steps because different compilers incremented
-** CellPtr before or after the XOR step. */
-                Temp = (cell_t)CellPtr ^ PF_MEMORY_VALIDATOR;
-                *CellPtr++ = Temp;
-                M_PUSH( (cell_t) CellPtr );
-                TOS = 0;
-            }
-            else
-            {
-                M_PUSH( 0 );
-                TOS = -1;  /* FIXME Fix error code. */
-            }
+/* See "Heap Tracking" in "pf_mem.c". */
+        case ID_ALLOCATE:  /* ( u -- addr result ) */
+            CharPtr = gVarPHeapActive ? pfPHeapAlloc( TOS ) : pfHeapAlloc( TOS, (cell_t) InsPtr );
+            M_PUSH( (cell_t) CharPtr );
+            TOS = (CharPtr != NULL) ? 0 : -1;  /* FIXME Fix error code. */
             endcase;
 
         case ID_AND:     BINARY_OP( & ); endcase;
 
+/* Arenas. See "pf_mem.c". */
+        case ID_ARENA:  /* ( size -- arena | 0 ) */
+            Temp = pfArenaSize( TOS );
+/* Allocated like ALLOCATE so that FREE can free it. */
+            CharPtr = (Temp > 0) ? pfHeapAlloc( Temp, (cell_t) InsPtr ) : NULL;
+            if( CharPtr ) pfInitArena( CharPtr, TOS );
+            TOS = (cell_t) CharPtr;
+            endcase;
+
+        case ID_ARENA_ALLOT:  /* ( arena n -- addr | 0 ) */
+            TOS = (cell_t) pfArenaAllot( (pfArena_t *) M_POP, TOS );
+            endcase;
+
+        case ID_ARENA_MARK:  /* ( arena -- mark ) */
+            TOS = ((pfArena_t *) TOS)->ar_Used;
+            endcase;
+
+        case ID_ARENA_RELEASE:  /* ( arena mark -- ) */
+            pfArenaRelease( (pfArena_t *) M_POP, TOS );
+            M_DROP;
+            endcase;
+
+        case ID_ARENA_RESET:  /* ( arena -- ) */
+            ((pfArena_t *) TOS)->ar_Used = 0;
+            M_DROP;
+            endcase;
+
+/* Object pools. See "pf_mem.c". */
+        case ID_POOL:  /* ( object-size count -- pool | 0 ) */
+            Scratch = M_POP; /* object-size */
+            Temp = pfPoolSize( Scratch, TOS );
+/* Allocated like ALLOCATE so that FREE can free it. */
+            CharPtr = (Temp > 0) ? pfHeapAlloc( Temp, (cell_t) InsPtr ) : NULL;
+            if( CharPtr ) pfInitPool( CharPtr, Scratch, TOS );
+            TOS = (cell_t) CharPtr;
+            endcase;
+
+        case ID_POOL_GET:  /* ( pool -- addr | 0 ) */
+            TOS = (cell_t) pfPoolGet( (pfPool_t *) TOS );
+            endcase;
+
+        case ID_POOL_PUT:  /* ( addr pool -- ) */
+            pfPoolPut( (pfPool_t *) TOS, (char *) M_POP );
+            M_DROP;
+            endcase;
+
+        case ID_POOL_EACH:  /* ( xt pool -- , call xt ( addr -- ) for each live object ) */
+            Scratch = M_POP; /* xt */
+            SAVE_REGISTERS;
+            Temp = pfPoolEach( (pfPool_t *) TOS, (ExecToken) Scratch );
+            LOAD_REGISTERS;
+            M_DROP;
+            if( Temp ) M_THROW( Temp );
+            endcase;
+
         case ID_ARSHIFT:     BINARY_OP( >> ); endcase;  /* Arithmetic right shift */
 
         case ID_BODY_OFFSET:
@@ -505,6 +701,18 @@ DBUG(("pfCatch: Token = 0x%x\n", Token ));
             TOS = CREATE_BODY_OFFSET;
             endcase;
 
+/* BUFFER: data is kept out of the dictionary. See "pf_mem.c". */
+        case ID_BUFFER_COLON_P:  /* ( u -- , compile the body ) */
+            pfBufferCreate( TOS );
+            M_DROP;
+            endcase;
+
+        case ID_BUFFER_P:  /* ( body -- addr ) */
+            CharPtr = pfBufferAddress( (cell_t *) TOS );
+            if( CharPtr == NULL ) M_THROW( THROW_ALLOCATE );
+            TOS = (cell_t) CharPtr;
+            endcase;
+
 /* Branch is followed by an offset relative to address of offset. */
         case ID_BRANCH:
 DBUGX(("Before Branch: IP = 0x%x\n", InsPtr ));
@@ -513,12 +721,13 @@ DBUGX(("After Branch: IP = 0x%x\n", InsPtr ));
             endcase;
 
         case ID_BYE:
-            EMIT_CR;
+            if( !gBatchMode ) EMIT_CR;
             M_THROW( THROW_BYE );
             endcase;
 
         case ID_BAIL:
             MSG("Emergency exit.\n");
+            ioFlush();
             EXIT(1);
             endcase;
 
@@ -557,22 +766,16 @@ DBUGX(("After Branch: IP = 0x%x\n", InsPtr ));
             {
                 register char *DstPtr = (char *) M_POP; /* dst */
                 CharPtr = (char *) M_POP;    /* src */
-                for( Scratch=0; (ucell_t) Scratch < (ucell_t) TOS ; Scratch++ )
-                {
-                    *DstPtr++ = *CharPtr++;
-                }
+                pfCopyChars( DstPtr, CharPtr, (ucell_t) TOS );
                 M_DROP;
             }
             endcase;
 
         case ID_CMOVE_UP: /* ( src dst n -- ) */
             {
-                register char *DstPtr = ((char *) M_POP) + TOS; /* dst */
-                CharPtr = ((char *) M_POP) + TOS;;    /* src */
-                for( Scratch=0; (ucell_t) Scratch < (ucell_t) TOS ; Scratch++ )
-                {
-                    *(--DstPtr) = *(--CharPtr);
-                }
+                register char *DstPtr = (char *) M_POP; /* dst */
+                CharPtr = (char *) M_POP;    /* src */
+                pfCopyCharsUp( DstPtr, CharPtr, (ucell_t) TOS );
                 M_DROP;
             }
             endcase;
@@ -691,187 +894,165 @@ DBUGX(("After Branch: IP = 0x%x\n", InsPtr ));
             }
             endcase;
 
-/* Assume 8-bit char and calculate cell width. */
-#define NBITS ((sizeof(ucell_t)) * 8)
-/* Define half the number of bits in a cell. */
-#define HNBITS (NBITS / 2)
-/* Assume two-complement arithmetic to calculate lower half. */
-#define LOWER_HALF(n) ((n) & (((ucell_t)1 << HNBITS) - 1))
-#define HIGH_BIT ((ucell_t)1 << (NBITS - 1))
-
-/* Perform cell*cell bit multiply for a 2 cell result, by factoring into half cell quantities.
- * Using an improved algorithm suggested by Steve Green.
- * Converted to 64-bit by Aleksej Saushev.
- */
         case ID_D_UMTIMES:  /* UM* ( a b -- lo hi ) */
             {
-                ucell_t ahi, alo, bhi, blo; /* input parts */
-                ucell_t lo, hi, temp;
-/* Get values from stack. */
-                ahi = M_POP;
-                bhi = TOS;
-/* Break into hi and lo 16 bit parts. */
-                alo = LOWER_HALF(ahi);
-                ahi = ahi >> HNBITS;
-                blo = LOWER_HALF(bhi);
-                bhi = bhi >> HNBITS;
-
-                lo = 0;
-                hi = 0;
-/* higher part: ahi * bhi */
-                hi += ahi * bhi;
-/* middle (overlapping) part: ahi * blo */
-                temp = ahi * blo;
-                lo += LOWER_HALF(temp);
-                hi += temp >> HNBITS;
-/* middle (overlapping) part: alo * bhi  */
-                temp = alo * bhi;
-                lo += LOWER_HALF(temp);
-                hi += temp >> HNBITS;
-/* lower part: alo * blo */
-                temp = alo * blo;
-/* its higher half overlaps with middle's lower half: */
-                lo += temp >> HNBITS;
-/* process carry: */
-                hi += lo >> HNBITS;
-                lo = LOWER_HALF(lo);
-/* combine lower part of result: */
-                lo = (lo << HNBITS) + LOWER_HALF(temp);
-
+                ucell_t lo, hi;
+                pfUMStar( (ucell_t) M_POP, (ucell_t) TOS, &lo, &hi );
                 M_PUSH( lo );
                 TOS = hi;
             }
             endcase;
 
-/* Perform cell*cell bit multiply for 2 cell result, using shift and add. */
         case ID_D_MTIMES:  /* M* ( a b -- pl ph ) */
             {
-                ucell_t ahi, alo, bhi, blo; /* input parts */
-                ucell_t lo, hi, temp;
+                ucell_t a, b, lo, hi;
                 int sg;
 /* Get values from stack. */
-                ahi = M_POP;
-                bhi = TOS;
+                a = M_POP;
+                b = TOS;
 
 /* Calculate product sign: */
-                sg = ((cell_t)(ahi ^ bhi) < 0);
+                sg = ((cell_t)(a ^ b) < 0);
 /* Take absolute values and reduce to um* */
-                if ((cell_t)ahi < 0) ahi = (ucell_t)(-(cell_t)ahi);
-                if ((cell_t)bhi < 0) bhi = (ucell_t)(-(cell_t)bhi);
-
-/* Break into hi and lo 16 bit parts. */
-                alo = LOWER_HALF(ahi);
-                ahi = ahi >> HNBITS;
-                blo = LOWER_HALF(bhi);
-                bhi = bhi >> HNBITS;
-
-                lo = 0;
-                hi = 0;
-/* higher part: ahi * bhi */
-                hi += ahi * bhi;
-/* middle (overlapping) part: ahi * blo */
-                temp = ahi * blo;
-                lo += LOWER_HALF(temp);
-                hi += temp >> HNBITS;
-/* middle (overlapping) part: alo * bhi  */
-                temp = alo * bhi;
-                lo += LOWER_HALF(temp);
-                hi += temp >> HNBITS;
-/* lower part: alo * blo */
-                temp = alo * blo;
-/* its higher half overlaps with middle's lower half: */
-                lo += temp >> HNBITS;
-/* process carry: */
-                hi += lo >> HNBITS;
-                lo = LOWER_HALF(lo);
-/* combine lower part of result: */
-                lo = (lo << HNBITS) + LOWER_HALF(temp);
+                if ((cell_t)a < 0) a = (ucell_t)0 - a;
+                if ((cell_t)b < 0) b = (ucell_t)0 - b;
+                pfUMStar( a, b, &lo, &hi );
 
 /* Negate product if one operand negative. */
-                if(sg)
-                {
-                    /* lo = (ucell_t)(- lo); */
-                    lo = ~lo + 1;
-                    hi = ~hi + ((lo == 0) ? 1 : 0);
-                }
+                if(sg) DNEGATE( lo, hi );
 
                 M_PUSH( lo );
                 TOS = hi;
             }
             endcase;
 
-#define DULT(du1l,du1h,du2l,du2h) ( (du2h<du1h) ? FALSE : ( (du2h==du1h) ? (du1l<du2l) : TRUE) )
-/* Perform 2 cell by 1 cell divide for 1 cell result and remainder, using shift and subtract. */
-        case ID_D_UMSMOD:  /* UM/MOD ( al ah bdiv -- rem q ) */
+/* Multiply two double cell numbers, keeping the low double cell. */
+        case ID_D_STAR:  /* D* ( al ah bl bh -- pl ph ) */
             {
-                ucell_t ah,al, q,di, bl,bh, sl,sh;
+                ucell_t al, ah, bl, lo, hi;
+#define bh ((ucell_t)TOS)
+                bl = M_POP;
                 ah = M_POP;
                 al = M_POP;
-                bh = TOS;
-                bl = 0;
-                q = 0;
-                for( di=0; di<NBITS; di++ )
+                pfUMStar( al, bl, &lo, &hi );
+                hi += (al * bh) + (ah * bl);
+                M_PUSH( lo );
+                TOS = hi;
+#undef bh
+            }
+            endcase;
+
+/* Scale a double by n1/n2, using a triple cell intermediate product.
+ * The quotient is rounded toward zero, like SM/REM.
+ */
+        case ID_D_MSTARSLASH:  /* ( dl dh n1 n2 -- ql qh ) */
+            {
+                ucell_t dl, dh, n1, n2, t0, t1, t2, temp, rem;
+                int sg;
+                n1 = M_POP;
+                dh = M_POP;
+                dl = M_POP;
+                if( TOS == 0 )
                 {
-                    if( !DULT(al,ah,bl,bh) )
-                    {
-                        sh = 0;
-                        sl = al - bl;
-                        if( al < bl ) sh = 1; /* Borrow */
-                        sh = ah - bh - sh;
-                        ah = sh;
-                        al = sl;
-                        q |= 1;
-                    }
-                    q = q << 1;
-                    bl = (bl >> 1) | (bh << (NBITS-1));
-                    bh = bh >> 1;
+                    M_THROW( THROW_DIVIDE_BY_ZERO );
                 }
-                if( !DULT(al,ah,bl,bh) )
+                else
                 {
+                    sg = (((cell_t) dh < 0) != ((cell_t) n1 < 0)) != (TOS < 0);
+                    if( (cell_t) dh < 0 ) DNEGATE( dl, dh );
+                    if( (cell_t) n1 < 0 ) n1 = (ucell_t)0 - n1;
+                    n2 = (TOS < 0) ? ((ucell_t)0 - (ucell_t)TOS) : (ucell_t)TOS;
+/* t2:t1:t0 = |d| * |n1| */
+                    pfUMStar( dl, n1, &t0, &t1 );
+                    pfUMStar( dh, n1, &temp, &t2 );
+                    t1 += temp;
+                    if( t1 < temp ) t2 += 1; /* Carry */
+/* Divide by |n2| one cell at a time. A quotient that does not fit in a double is truncated. */
+                    t2 = t2 % n2;
+                    t1 = pfUMSlashMod( t1, t2, n2, &rem );
+                    t0 = pfUMSlashMod( t0, rem, n2, &rem );
+                    if( sg ) DNEGATE( t0, t1 );
+                    M_PUSH( t0 );
+                    TOS = t1;
+                }
+            }
+            endcase;
 
-                    al = al - bl;
-                    q |= 1;
+/* Divide 2 cell by 1 cell for 1 cell result and remainder. */
+        case ID_D_UMSMOD:  /* UM/MOD ( al ah bdiv -- rem q ) */
+            {
+                ucell_t ah, al, rem;
+                ah = M_POP;
+                al = M_POP;
+                if( TOS == 0 )
+                {
+                    M_THROW( THROW_DIVIDE_BY_ZERO );
+                }
+                else
+                {
+                    TOS = pfUMSlashMod( al, ah, (ucell_t) TOS, &rem );
+                    M_PUSH( rem );
                 }
-                M_PUSH( al );  /* rem */
-                TOS = q;
             }
             endcase;
 
-/* Perform 2 cell by 1 cell divide for 2 cell result and remainder, using shift and subtract. */
+/* Divide 2 cell by 1 cell for 2 cell result and remainder.
+ * Divide the high cell first so that each step fits in UM/MOD.
+ */
         case ID_D_MUSMOD:  /* MU/MOD ( al am bdiv -- rem ql qh ) */
             {
-                register ucell_t ah,am,al,ql,qh,di;
+                ucell_t am, al, ql, qh, rem;
 #define bdiv ((ucell_t)TOS)
-                ah = 0;
                 am = M_POP;
                 al = M_POP;
-                qh = ql = 0;
-                for( di=0; di<2*NBITS; di++ )
+                if( bdiv == 0 )
                 {
-                    if( bdiv <= ah )
-                    {
-                        ah = ah - bdiv;
-                        ql |= 1;
-                    }
-                    qh = (qh << 1) | (ql >> (NBITS-1));
-                    ql = ql << 1;
-                    ah = (ah << 1) | (am >> (NBITS-1));
-                    am = (am << 1) | (al >> (NBITS-1));
-                    al = al << 1;
-DBUG(("XX ah,m,l = 0x%8x,%8x,%8x - qh,l = 0x%8x,%8x\n", ah,am,al, qh,ql ));
+                    M_THROW( THROW_DIVIDE_BY_ZERO );
                 }
-                if( bdiv <= ah )
+                else
                 {
-                    ah = ah - bdiv;
-                    ql |= 1;
+                    qh = am / bdiv;
+                    ql = pfUMSlashMod( al, am % bdiv, bdiv, &rem );
+                    M_PUSH( rem );
+                    M_PUSH( ql );
+                    TOS = qh;
                 }
-                M_PUSH( ah ); /* rem */
-                M_PUSH( ql );
-                TOS = qh;
 #undef bdiv
             }
             endcase;
 
+/* Divide double by double, rounding the quotient toward zero.
+ * The remainder has the sign of the dividend, like SM/REM.
+ */
+        case ID_D_SLASHMOD:  /* D/MOD ( nl nh dl dh -- rl rh ql qh ) */
+            {
+                ucell_t nl, nh, dl, dh, ql, qh, rl, rh;
+                int nsg, dsg;
+                dh = (ucell_t) TOS;
+                dl = M_POP;
+                nh = M_POP;
+                nl = M_POP;
+                if( (dl | dh) == 0 )
+                {
+                    M_THROW( THROW_DIVIDE_BY_ZERO );
+                }
+                else
+                {
+                    nsg = ((cell_t) nh < 0);
+                    dsg = ((cell_t) dh < 0);
+                    if( nsg ) DNEGATE( nl, nh );
+                    if( dsg ) DNEGATE( dl, dh );
+                    pfUDSlashMod( nl, nh, dl, dh, &ql, &qh, &rl, &rh );
+                    if( nsg ) DNEGATE( rl, rh );
+                    if( nsg != dsg ) DNEGATE( ql, qh );
+                    M_PUSH( rl );
+                    M_PUSH( rh );
+                    M_PUSH( ql );
+                    TOS = qh;
+                }
+            }
+            endcase;
+
 #ifndef PF_NO_SHELL
         case ID_DEFER:
             ffDefer( );
@@ -956,7 +1137,7 @@ DBUG(("XX ah,m,l = 0x%8x,%8x,%8x - qh,l = 0x%8x,%8x\n", ah,am,al, qh,ql ));
             endcase;
 
         case ID_FETCH:
-#if (defined(PF_BIG_ENDIAN_DIC) || defined(PF_LITTLE_ENDIAN_DIC))
+#ifdef PF_DIC_CONVERT
             if( IN_DICS( TOS ) )
             {
                 TOS = (cell_t) READ_CELL_DIC((cell_t *)TOS);
@@ -1032,6 +1213,48 @@ DBUG(("XX ah,m,l = 0x%8x,%8x,%8x - qh,l = 0x%8x,%8x\n", ah,am,al, qh,ql ));
             }
             endcase;
 
+        case ID_FILE_MAP: /* ( c-addr u fam -- addr len ior ) */
+            Scratch = M_POP; /* u */
+            Temp = M_POP;    /* caddr */
+            if( Scratch < TIB_SIZE-2 )
+            {
+/* R/W and W/O maps are writable. BIN makes no difference. */
+                cell_t writable = ((TOS & ~PF_FAM_BINARY_FLAG) != PF_FAM_READ_ONLY);
+                pfCopyMemory( gScratch, (char *) Temp, (ucell_t) Scratch );
+                gScratch[Scratch] = '\0';
+                DBUG(("Map file = %s\n", gScratch ));
+                CharPtr = (char *) sdMapFile( gScratch, (int) writable, &Temp );
+                M_PUSH( (cell_t) CharPtr );
+                if( Temp < 0 )
+                {
+                    M_PUSH( 0 );
+                    TOS = -1;
+                }
+                else
+                {
+                    M_PUSH( Temp );
+                    TOS = 0;
+                }
+            }
+            else
+            {
+                ERR("Filename too large for name buffer.\n");
+                M_PUSH( 0 );
+                M_PUSH( 0 );
+                TOS = -2;
+            }
+            endcase;
+
+        case ID_FILE_UNMAP: /* ( addr len -- ior ) */
+            Scratch = M_POP; /* addr */
+            TOS = sdUnmapFile( (void *) Scratch, TOS ) ? -1 : 0;
+            endcase;
+
+        case ID_FILE_SYNC_MAPPED: /* ( addr len -- ior ) */
+            Scratch = M_POP; /* addr */
+            TOS = sdSyncMapped( (void *) Scratch, TOS ) ? -1 : 0;
+            endcase;
+
         case ID_FILE_CLOSE: /* ( fid -- ior ) */
             TOS = sdCloseFile( (FileStream *) TOS );
             endcase;
@@ -1084,6 +1307,25 @@ DBUG(("XX ah,m,l = 0x%8x,%8x,%8x - qh,l = 0x%8x,%8x\n", ah,am,al, qh,ql ));
             TOS = (Temp != Scratch) ? -3 : 0;
             endcase;
 
+/* Asynchronous file I/O. See "pf_aio.c". */
+        case ID_FILE_READ_ASYNC: /* ( addr len fid -- req ) */
+        case ID_FILE_WRITE_ASYNC: /* ( addr len fid -- req ) */
+            FileID = (FileStream *) TOS;
+            Scratch = M_POP;
+            CharPtr = (char *) M_POP;
+            TOS = pfStartFileRequest( (Token == ID_FILE_WRITE_ASYNC), CharPtr, Scratch, FileID );
+            endcase;
+
+        case ID_REQ_DONEQ: /* ( req -- flag ) */
+            TOS = pfFileRequestDone( TOS ) ? FTRUE : FFALSE;
+            endcase;
+
+        case ID_REQ_WAIT: /* ( req -- u ior ) */
+            Scratch = pfWaitFileRequest( TOS, &Temp );
+            M_PUSH( Scratch );
+            TOS = Temp;
+            endcase;
+
         case ID_FILE_REPOSITION: /* ( ud fid -- ior ) */
             {
                 file_offset_t offset;
@@ -1176,10 +1418,7 @@ DBUG(("XX ah,m,l = 0x%8x,%8x,%8x - qh,l = 0x%8x,%8x\n", ah,am,al, qh,ql ));
                 register char *DstPtr;
                 Temp = M_POP;    /* num */
                 DstPtr = (char *) M_POP; /* dst */
-                for( Scratch=0; (ucell_t) Scratch < (ucell_t) Temp ; Scratch++ )
-                {
-                    *DstPtr++ = (char) TOS;
-                }
+                pfFillChars( DstPtr, (ucell_t) Temp, (char) TOS );
                 M_DROP;
             }
             endcase;
@@ -1197,38 +1436,96 @@ DBUG(("XX ah,m,l = 0x%8x,%8x,%8x - qh,l = 0x%8x,%8x\n", ah,am,al, qh,ql ));
 #endif  /* !PF_NO_SHELL */
 
         case ID_FLUSHEMIT:
-            sdTerminalFlush();
+            ioFlush();
             endcase;
 
-/* Validate memory before freeing. Clobber validator and first word. */
+/* Validate memory before freeing. */
         case ID_FREE:   /* ( addr -- result ) */
             if( TOS == 0 )
             {
                 ERR("FREE passed NULL!\n");
                 TOS = -2; /* FIXME error code */
             }
+            else if( pfPHeapContains( (void *) TOS ) )
+            {
+                TOS = (pfPHeapFree( (void *) TOS ) == 0) ? 0 : -2;
+            }
             else
             {
-                CellPtr = (cell_t *) TOS;
-                CellPtr--;
-                if( ((ucell_t)*CellPtr) != ((ucell_t)CellPtr ^ PF_MEMORY_VALIDATOR))
-                {
-                    TOS = -2; /* FIXME error code */
-                }
-                else
-                {
-                    CellPtr[0] = 0xDeadBeef;
-                    pfFreeMem((char *)CellPtr);
-                    TOS = 0;
-                }
+                TOS = (pfHeapFree( (void *) TOS ) == 0) ? 0 : -2; /* FIXME error code */
+            }
+            endcase;
+
+        case ID_HANDLE_TO_ADDR:  /* ( handle -- addr , of a raylib resource ) */
+            CharPtr = (char *) pfRaylibHandleData( TOS, -1 );
+            if( CharPtr == NULL )
+            {
+                M_THROW( THROW_RAYLIB_HANDLE );
             }
+            else
+            {
+                TOS = (cell_t) CharPtr;
+            }
+            endcase;
+
+        case ID_HEAP_DUMP:  /* ( -- ) */
+            pfHeapDump();
+            endcase;
+
+        case ID_HEAP_LEAKS:  /* ( -- ) */
+            pfHeapLeaks();
+            endcase;
+
+        case ID_HEAP_STATS:  /* ( -- ) */
+            pfHeapStats();
             endcase;
 
 #include "pfinnrfp.h"
 
         case ID_HERE:
             PUSH_TOS;
+            pfLockDictionary();
             TOS = (cell_t)CODE_HERE;
+            pfUnlockDictionary();
+            endcase;
+
+/* These move HERE while holding the dictionary lock so that another
+** thread cannot compile into the same space. */
+        case ID_ALLOT: /* ( n -- ) */
+            pfLockDictionary();
+            gCurrentDictionary->dic_CodePtr.Byte += TOS;
+            pfUnlockDictionary();
+            M_DROP;
+            endcase;
+
+        case ID_ALIGN: /* ( -- ) */
+            pfLockDictionary();
+            CODE_HERE = (cell_t *) CELL_ALIGN( (ucell_t) CODE_HERE );
+            pfUnlockDictionary();
+            endcase;
+
+        case ID_COMMA: /* ( n -- ) */
+            pfLockDictionary();
+            CODE_HERE = (cell_t *) CELL_ALIGN( (ucell_t) CODE_HERE );
+            CODE_COMMA( TOS );
+            pfUnlockDictionary();
+            M_DROP;
+            endcase;
+
+        case ID_C_COMMA: /* ( c -- ) */
+            pfLockDictionary();
+            *gCurrentDictionary->dic_CodePtr.Byte++ = (uint8_t) TOS;
+            pfUnlockDictionary();
+            M_DROP;
+            endcase;
+
+        case ID_W_COMMA: /* ( w -- ) */
+            pfLockDictionary();
+            gCurrentDictionary->dic_CodePtr.Byte += ((ucell_t) CODE_HERE) & 1;
+            WRITE_SHORT_DIC( gCurrentDictionary->dic_CodePtr.Byte, (uint16_t) TOS );
+            gCurrentDictionary->dic_CodePtr.Byte += 2;
+            pfUnlockDictionary();
+            M_DROP;
             endcase;
 
         case ID_NUMBERQ_P:   /* ( addr -- 0 | n 1 ) */
@@ -1247,6 +1544,11 @@ DBUG(("XX ah,m,l = 0x%8x,%8x,%8x - qh,l = 0x%8x,%8x\n", ah,am,al, qh,ql ));
             TOS = M_R_PICK(1);
             endcase;
 
+        case ID_INCLUDE_CACHE: /* ( c-addr u -- ior , directory for compiled includes ) */
+            CharPtr = (char *) M_POP;
+            TOS = ffSetIncludeCache( CharPtr, TOS );
+            endcase;
+
 #ifndef PF_NO_SHELL
         case ID_INCLUDE_FILE:
             FileID = (FileStream *) TOS;
@@ -1448,6 +1750,56 @@ DBUG(("XX ah,m,l = 0x%8x,%8x,%8x - qh,l = 0x%8x,%8x\n", ah,am,al, qh,ql ));
             TOS = M_STACK(1);
             endcase;
 
+/* Persistent heap. See "pf_pheap.c". */
+        case ID_PHEAP_ABS:  /* ( offset -- addr ) */
+            TOS = (cell_t) pfPHeapToAbs( TOS );
+            endcase;
+
+        case ID_PHEAP_CLOSE:  /* ( -- ior ) */
+            PUSH_TOS;
+            TOS = pfPHeapClose();
+            endcase;
+
+        case ID_PHEAP_OPEN:  /* ( c-addr u size -- ior ) */
+            Scratch = M_POP; /* u */
+            Temp = M_POP;    /* caddr */
+            if( Scratch < TIB_SIZE-2 )
+            {
+                pfCopyMemory( gScratch, (char *) Temp, (ucell_t) Scratch );
+                gScratch[Scratch] = '\0';
+                TOS = pfPHeapOpen( gScratch, TOS );
+            }
+            else
+            {
+                ERR("PHEAP-OPEN - filename too large for name buffer.\n");
+                TOS = -1;
+            }
+            endcase;
+
+        case ID_PHEAP_REL:  /* ( addr -- offset ) */
+            TOS = pfPHeapToRel( (void *) TOS );
+            endcase;
+
+        case ID_PHEAP_ROOT_FETCH:  /* ( -- addr ) */
+            PUSH_TOS;
+            TOS = pfPHeapGetRoot();
+            endcase;
+
+        case ID_PHEAP_ROOT_STORE:  /* ( addr -- ) */
+            pfPHeapSetRoot( TOS );
+            M_DROP;
+            endcase;
+
+        case ID_PHEAP_SYNC:  /* ( -- ior ) */
+            PUSH_TOS;
+            TOS = pfPHeapSync();
+            endcase;
+
+        case ID_PAD:  /* ( -- addr ) */
+            PUSH_TOS;
+            TOS = (cell_t) &gCurrentTask->td_Pad[PF_HOLD_SIZE];
+            endcase;
+
         case ID_PICK: /* ( ... n -- sp(n) ) */
             TOS = M_STACK(TOS);
             endcase;
@@ -1455,7 +1807,7 @@ DBUG(("XX ah,m,l = 0x%8x,%8x,%8x - qh,l = 0x%8x,%8x\n", ah,am,al, qh,ql ));
         case ID_PLUS:     BINARY_OP( + ); endcase;
 
         case ID_PLUS_STORE:   /* ( n addr -- , add n to *addr ) */
-#if (defined(PF_BIG_ENDIAN_DIC) || defined(PF_LITTLE_ENDIAN_DIC))
+#ifdef PF_DIC_CONVERT
             if( IN_DICS( TOS ) )
             {
                 Scratch = READ_CELL_DIC((cell_t *)TOS);
@@ -1520,6 +1872,7 @@ DBUG(("XX ah,m,l = 0x%8x,%8x,%8x - qh,l = 0x%8x,%8x\n", ah,am,al, qh,ql ));
 
         case ID_QTERMINAL:  /* WARNING: Typically not fully implemented! */
             PUSH_TOS;
+            ioFlush();
             TOS = sdQueryTerminal();
             endcase;
 
@@ -1551,39 +1904,33 @@ DBUG(("XX ah,m,l = 0x%8x,%8x,%8x - qh,l = 0x%8x,%8x\n", ah,am,al, qh,ql ));
 
 /* Resize memory allocated by ALLOCATE. */
         case ID_RESIZE:  /* ( addr1 u -- addr2 result ) */
+            CharPtr = (char *) M_POP;
+            if( pfPHeapContains( CharPtr ) )
             {
-                cell_t *Addr1 = (cell_t *) M_POP;
-                /* Point to validator below users address. */
-                cell_t *FreePtr = Addr1 - 1;
-                if( ((ucell_t)*FreePtr) != ((ucell_t)FreePtr ^ PF_MEMORY_VALIDATOR))
+                Scratch = (cell_t) pfPHeapResize( CharPtr, TOS );
+                M_PUSH( Scratch ? Scratch : (cell_t) CharPtr );
+                TOS = Scratch ? 0 : -4;
+            }
+            else if( !pfHeapValid( CharPtr ) )
+            {
+                /* 090218 - Fixed bug, was returning zero. */
+                M_PUSH( CharPtr );
+                TOS = -3;
+            }
+            else
+            {
+                /* Copies the data and frees the old memory if it can allocate. */
+                Scratch = (cell_t) pfHeapResize( CharPtr, TOS, (cell_t) InsPtr );
+                if( Scratch )
                 {
-                    /* 090218 - Fixed bug, was returning zero. */
-                    M_PUSH( Addr1 );
-                    TOS = -3;
+                    M_PUSH( Scratch );
+                    TOS = 0; /* Result code. */
                 }
                 else
                 {
-                    /* Try to allocate. */
-                    CellPtr = (cell_t *) pfAllocMem( TOS + sizeof(cell_t) );
-                    if( CellPtr )
-                    {
-                        /* Copy memory including validation. */
-                        pfCopyMemory( (char *) CellPtr, (char *) FreePtr, TOS + sizeof(cell_t) );
-                        *CellPtr = (cell_t)(((ucell_t)CellPtr) ^ (ucell_t)PF_MEMORY_VALIDATOR);
-                        /* 090218 - Fixed bug that was incrementing the address twice. Thanks Reinhold Straub. */
-                        /* Increment past validator to user address. */
-                        M_PUSH( (cell_t) (CellPtr + 1) );
-                        TOS = 0; /* Result code. */
-                        /* Mark old cell as dead so we can't free it twice. */
-                        FreePtr[0] = 0xDeadBeef;
-                        pfFreeMem((char *) FreePtr);
-                    }
-                    else
-                    {
-                        /* 090218 - Fixed bug, was returning zero. */
-                        M_PUSH( Addr1 );
-                        TOS = -4;  /* FIXME Fix error code. */
-                    }
+                    /* 090218 - Fixed bug, was returning zero. */
+                    M_PUSH( CharPtr );
+                    TOS = -4;  /* FIXME Fix error code. */
                 }
             }
             endcase;
@@ -1637,7 +1984,26 @@ DBUG(("XX ah,m,l = 0x%8x,%8x,%8x - qh,l = 0x%8x,%8x\n", ah,am,al, qh,ql ));
                 NameSize = M_POP;
                 EntryPoint = M_POP;
                 ForthStringToC( gScratch, (char *) M_POP, sizeof(gScratch) );
-                TOS =  ffSaveForth( gScratch, EntryPoint, NameSize, CodeSize );
+                SAVE_REGISTERS;  /* AUTO.TERM and AUTO.INIT are run. */
+                Scratch = ffSaveForth( gScratch, EntryPoint, NameSize, CodeSize );
+                LOAD_REGISTERS;
+                TOS = Scratch;
+            }
+            endcase;
+
+        case ID_SAVE_DELTA_P:   /* ( $base $name Entry NameSize CodeSize -- err ) */
+            {
+                cell_t NameSize, CodeSize, EntryPoint;
+                char BaseName[TIB_SIZE];
+                CodeSize = TOS;
+                NameSize = M_POP;
+                EntryPoint = M_POP;
+                ForthStringToC( gScratch, (char *) M_POP, sizeof(gScratch) );
+                ForthStringToC( BaseName, (char *) M_POP, sizeof(BaseName) );
+                SAVE_REGISTERS;
+                Scratch = ffSaveDelta( BaseName, gScratch, EntryPoint, NameSize, CodeSize );
+                LOAD_REGISTERS;
+                TOS = Scratch;
             }
             endcase;
 #endif
@@ -1646,6 +2012,15 @@ DBUG(("XX ah,m,l = 0x%8x,%8x,%8x - qh,l = 0x%8x,%8x\n", ah,am,al, qh,ql ));
             TOS = sdSleepMillis(TOS);
             endcase;
 
+        case ID_UTIME:  /* ( -- ud , microseconds ) */
+            {
+                uint64_t Micros = sdMicroseconds();
+                PUSH_TOS;
+                M_PUSH( (cell_t) Micros );
+                TOS = (sizeof(cell_t) < sizeof(uint64_t)) ? (cell_t) (Micros >> 32) : 0;
+            }
+            endcase;
+
         case ID_SP_FETCH:    /* ( -- sp , address of top of stack, sorta ) */
             PUSH_TOS;
             TOS = (cell_t)STKPTR;
@@ -1657,7 +2032,7 @@ DBUG(("XX ah,m,l = 0x%8x,%8x,%8x - qh,l = 0x%8x,%8x\n", ah,am,al, qh,ql ));
             endcase;
 
         case ID_STORE: /* ( n addr -- , write n to addr ) */
-#if (defined(PF_BIG_ENDIAN_DIC) || defined(PF_LITTLE_ENDIAN_DIC))
+#ifdef PF_DIC_CONVERT
             if( IN_DICS( TOS ) )
             {
                 WRITE_CELL_DIC((cell_t *)TOS,M_POP);
@@ -1743,6 +2118,138 @@ DBUG(("XX ah,m,l = 0x%8x,%8x,%8x - qh,l = 0x%8x,%8x\n", ah,am,al, qh,ql ));
             *STKPTR = Scratch;
             endcase;
 
+/* Cooperative multitasking. See pfRunTasks() in "pf_core.c". */
+        case ID_PAUSE:  /* ( -- ) */
+            PUSH_TOS;
+            TOS = 1;
+            /* fall through */
+        case ID_WAIT_FRAMES:  /* ( n -- , let the other tasks run N times ) */
+            Scratch = TOS;
+            M_DROP;
+            if( Scratch <= 0 )
+            {
+                endcase;
+            }
+            if( gCurrentTask->td_TaskXT == 0 )
+            {
+/* Main task. Run the background tasks once per frame. */
+                SAVE_REGISTERS;
+                Temp = 0;
+                while( (Scratch-- > 0) && (Temp == 0) )
+                {
+                    Temp = pfRunTasks();
+                }
+                LOAD_REGISTERS;
+                if( Temp ) M_THROW( Temp );
+            }
+            else if( InitialReturnStack != gCurrentTask->td_ReturnBase )
+            {
+/* Nested pfCatch() whose C caller cannot be saved. */
+                M_THROW( THROW_PAUSE );
+            }
+            else
+            {
+/* Background task. Save our place then return to pfRunTasks(). */
+                if( InsPtr == &FakeSecondary[1] )
+                {
+                    InsPtr = (cell_t *) M_R_POP; /* Do the EXIT after EXECUTE now, FakeSecondary is gone on resume. */
+                }
+                M_R_PUSH( LocalsPtr );
+                gCurrentTask->td_InsPtr = InsPtr;
+                gCurrentTask->td_PausedReturnPtr = TORPTR;
+                gCurrentTask->td_WaitFrames = Scratch - 1;
+                TORPTR = InitialReturnStack;
+            }
+            endcase;
+
+        case ID_TASK_RESUME:  /* Only passed to pfCatch() by pfRunTasks(). */
+            TORPTR = gCurrentTask->td_PausedReturnPtr;
+            gCurrentTask->td_PausedReturnPtr = NULL;
+            LocalsPtr = (cell_t *) M_R_POP;
+            InsPtr = gCurrentTask->td_InsPtr;
+            endcase;
+
+        case ID_TASK_CREATE:  /* (TASK) ( xt -- task | 0 ) */
+            TOS = (cell_t) pfCreateBackgroundTask( (ExecToken) TOS );
+            endcase;
+
+        case ID_TASK_SLEEP:  /* ( task -- ) */
+            ((pfTaskData_t *) TOS)->td_TaskState = TASK_ASLEEP;
+            M_DROP;
+            endcase;
+
+        case ID_TASK_WAKE:  /* ( task -- ) */
+            ((pfTaskData_t *) TOS)->td_TaskState = TASK_AWAKE;
+            ((pfTaskData_t *) TOS)->td_WaitFrames = 0;
+            M_DROP;
+            endcase;
+
+/* OS threads. See pfCreateThread() in "pf_core.c". */
+        case ID_THREAD:  /* ( xt -- thread | 0 ) */
+            TOS = pfCreateThread( (ExecToken) TOS );
+            endcase;
+
+        case ID_JOIN_THREAD:  /* ( thread -- throw-code ) */
+            TOS = pfJoinThread( TOS );
+            endcase;
+
+/* Channels. See "pf_chan.c". */
+        case ID_CHANNEL:  /* ( capacity -- channel | 0 ) */
+            Temp = pfChannelSize( TOS );
+/* Allocated like ALLOCATE so that FREE can free it. */
+            CharPtr = (Temp > 0) ? pfHeapAlloc( Temp, (cell_t) InsPtr ) : NULL;
+            if( CharPtr ) pfInitChannel( CharPtr, TOS );
+            TOS = (cell_t) CharPtr;
+            endcase;
+
+        case ID_TRY_SEND:  /* ( x channel -- flag , true if sent ) */
+            Scratch = M_POP;
+            TOS = pfChannelSend( TOS, &Scratch, 1 ) ? FTRUE : FFALSE;
+            endcase;
+
+        case ID_TRY_RECV:  /* ( channel -- x true | false ) */
+            if( pfChannelRecv( TOS, &Scratch, 1 ) )
+            {
+                M_PUSH( Scratch );
+                TOS = FTRUE;
+            }
+            else
+            {
+                TOS = FFALSE;
+            }
+            endcase;
+
+        case ID_TRY_SEND_N:  /* ( addr n channel -- n-sent ) */
+            Scratch = M_POP; /* n */
+            TOS = pfChannelSend( TOS, (cell_t *) M_POP, Scratch );
+            endcase;
+
+        case ID_TRY_RECV_N:  /* ( addr n channel -- n-received ) */
+            Scratch = M_POP; /* n */
+            TOS = pfChannelRecv( TOS, (cell_t *) M_POP, Scratch );
+            endcase;
+
+/* Parallel loops. See pfParallel() in "pf_core.c". */
+        case ID_PAR_DO:  /* ( xt n -- , call xt ( i -- ) for i = 0 to n-1 ) */
+            Scratch = M_POP; /* xt */
+            SAVE_REGISTERS;
+            Temp = pfParallel( (ExecToken) Scratch, NULL, NULL, TOS );
+            LOAD_REGISTERS;
+            M_DROP;
+            if( Temp ) M_THROW( Temp );
+            endcase;
+
+        case ID_PAR_MAP:  /* ( xt src dst n -- , dst[i] = xt ( src[i] -- x ) ) */
+            Scratch = M_POP; /* dst */
+            CellPtr = (cell_t *) M_POP; /* src */
+            Temp = M_POP; /* xt */
+            SAVE_REGISTERS;
+            Temp = pfParallel( (ExecToken) Temp, CellPtr, (cell_t *) Scratch, TOS );
+            LOAD_REGISTERS;
+            M_DROP;
+            if( Temp ) M_THROW( Temp );
+            endcase;
+
         case ID_TEST1:
             PUSH_TOS;
             M_PUSH( 0x11 );
@@ -1793,13 +2300,31 @@ DBUG(("XX ah,m,l = 0x%8x,%8x,%8x - qh,l = 0x%8x,%8x\n", ah,am,al, qh,ql ));
             M_DROP;
             endcase;
 
+        case ID_TO_ZSTRING:  /* ( c-addr u -- c-addr' u , copy with a zero after it ) */
+            Scratch = (cell_t) pfZString( M_STACK(0), TOS );
+            if( Scratch == 0 )
+            {
+                M_THROW( THROW_ALLOCATE );
+            }
+            else
+            {
+                M_STACK(0) = Scratch;
+            }
+            endcase;
+
         case ID_VAR_BASE: DO_VAR(gVarBase); endcase;
+        case ID_VAR_BATCH: DO_VAR(gBatchMode); endcase;
         case ID_VAR_BYE_CODE: DO_VAR(gVarByeCode); endcase;
+        case ID_VAR_PAR_GRAIN: DO_VAR(gVarParGrain); endcase;
         case ID_VAR_CODE_BASE: DO_VAR(gCurrentDictionary->dic_CodeBase); endcase;
         case ID_VAR_CODE_LIMIT: DO_VAR(gCurrentDictionary->dic_CodeLimit); endcase;
         case ID_VAR_CONTEXT: DO_VAR(gVarContext); endcase;
+        case ID_VAR_DIC_COMPRESS: DO_VAR(gVarDicCompress); endcase;
         case ID_VAR_DP: DO_VAR(gCurrentDictionary->dic_CodePtr.Cell); endcase;
         case ID_VAR_ECHO: DO_VAR(gVarEcho); endcase;
+        case ID_VAR_PHEAP_ACTIVE: DO_VAR(gVarPHeapActive); endcase;
+        case ID_VAR_HEAP_TRACK: DO_VAR(gVarHeapTrack); endcase;
+        case ID_VAR_HLD: DO_VAR(gCurrentTask->td_HLD); endcase;
         case ID_VAR_HEADERS_BASE: DO_VAR(gCurrentDictionary->dic_HeaderBase); endcase;
         case ID_VAR_HEADERS_LIMIT: DO_VAR(gCurrentDictionary->dic_HeaderLimit); endcase;
         case ID_VAR_HEADERS_PTR: DO_VAR(gCurrentDictionary->dic_HeaderPtr); endcase;
@@ -1822,7 +2347,7 @@ DBUG(("XX ah,m,l = 0x%8x,%8x,%8x - qh,l = 0x%8x,%8x\n", ah,am,al, qh,ql ));
             endcase;
 
         case ID_WORD_FETCH: /* ( waddr -- w ) */
-#if (defined(PF_BIG_ENDIAN_DIC) || defined(PF_LITTLE_ENDIAN_DIC))
+#ifdef PF_DIC_CONVERT
             if( IN_DICS( TOS ) )
             {
                 TOS = (uint16_t) READ_SHORT_DIC((uint16_t *)TOS);
@@ -1838,7 +2363,7 @@ DBUG(("XX ah,m,l = 0x%8x,%8x,%8x - qh,l = 0x%8x,%8x\n", ah,am,al, qh,ql ));
 
         case ID_WORD_STORE: /* ( w waddr -- ) */
 
-#if (defined(PF_BIG_ENDIAN_DIC) || defined(PF_LITTLE_ENDIAN_DIC))
+#ifdef PF_DIC_CONVERT
             if( IN_DICS( TOS ) )
             {
                 WRITE_SHORT_DIC((uint16_t *)TOS,(uint16_t)M_POP);
@@ -1872,7 +2397,10 @@ DBUGX(("After 0Branch: IP = 0x%x\n", InsPtr ));
             endcase;
 
 
-            RAYLIB_WORDS
+/* raylib words, generated from "raylib.h", see "mkraylib.c". */
+#define PF_RAYLIB_CASES
+#include "pf_raylib_api.h"
+#undef PF_RAYLIB_CASES
 
             default:
                 // ExceptionReturnCode = THROW_UNDEFINED_WORD;
@@ -1884,18 +2412,6 @@ DBUGX(("After 0Branch: IP = 0x%x\n", InsPtr ));
                 InsPtr = 0;
         } // switch(Token)
 
-        // Try Raylib words.
-        // ExceptionReturnCode = pfRaylibCatch(XT, &TopOfStack, DataStackPtr, ReturnStackPtr);
-
-        // if (ExceptionReturnCode == THROW_UNDEFINED_WORD) {
-        //   ERR("pfCatch: Unrecognised token = 0x");
-        //   ffDotHex(Token);
-        //   ERR(" at 0x");
-        //   ffDotHex((cell_t)InsPtr);
-        //   EMIT_CR;
-        //   InsPtr = 0;
-        // }
-
         if (InsPtr) {
           Token = READ_CELL_DIC(
               InsPtr++); /* Traverse to next token in secondary. */
@@ -23,6 +23,16 @@
 
 #include "pf_all.h"
 
+/* Characters are collected here and sent to the terminal in one go
+** by ioFlush(), rather than calling the system for every character.
+** Each thread has its own buffer so lines from threads do not mix.
+*/
+#ifndef PF_EMIT_BUFFER_SIZE
+#define PF_EMIT_BUFFER_SIZE  (1024)
+#endif
+static PF_THREAD_LOCAL char   gEmitBuffer[PF_EMIT_BUFFER_SIZE];
+static PF_THREAD_LOCAL cell_t gEmitCount;
+static PF_THREAD_LOCAL ucell_t gEmitTotal;  /* Characters sent since the start. */
 
 /***************************************************************
 ** Initialize I/O system.
@@ -30,11 +40,30 @@
 void ioInit( void )
 {
     /* System dependant terminal initialization. */
-    sdTerminalInit();
+    if( !gBatchMode ) sdTerminalInit();
 }
 void ioTerm( void )
 {
-    sdTerminalTerm();
+    ioFlush();
+    if( !gBatchMode ) sdTerminalTerm();
+}
+
+/***************************************************************
+** Send any buffered output to the terminal.
+** Called before reading the keyboard, by FLUSHEMIT, when the
+** buffer fills up and when pForth terminates.
+*/
+void ioFlush( void )
+{
+    cell_t i;
+    cell_t n = gEmitCount;
+
+    gEmitCount = 0;
+    for( i=0; i<n; i++ )
+    {
+        if( sdTerminalOut( gEmitBuffer[i] ) < 0 ) EXIT(1);
+    }
+    sdTerminalFlush();
 }
 
 /***************************************************************
@@ -42,17 +71,15 @@ void ioTerm( void )
 */
 void ioEmit( char c )
 {
-    cell_t Result;
-
-    Result = sdTerminalOut(c);
-    if( Result < 0 ) EXIT(1);
+    if( gEmitCount == PF_EMIT_BUFFER_SIZE ) ioFlush();
+    gEmitBuffer[gEmitCount++] = c;
+    gEmitTotal++;
 
     if( gCurrentTask )
     {
         if(c == '\n')
         {
             gCurrentTask->td_OUT = 0;
-            sdTerminalFlush();
         }
         else
         {
@@ -67,19 +94,49 @@ void ioEmit( char c )
 void ioType( const char *s, cell_t n )
 {
     cell_t i;
+    cell_t Room;
+
+    if( n <= 0 ) return;
+    gEmitTotal += (ucell_t) n;
 
-    for( i=0; i<n; i++)
+/* OUT counts the characters after the last newline. */
+    if( gCurrentTask )
     {
-        ioEmit ( *s++ );
+        for( i=n; i>0; i-- )
+        {
+            if( s[i-1] == '\n' ) break;
+        }
+        gCurrentTask->td_OUT = (i > 0) ? (n - i) : (gCurrentTask->td_OUT + n);
+    }
+
+    while( n > 0 )
+    {
+        if( gEmitCount == PF_EMIT_BUFFER_SIZE ) ioFlush();
+        Room = PF_EMIT_BUFFER_SIZE - gEmitCount;
+        if( Room > n ) Room = n;
+        pfCopyMemory( &gEmitBuffer[gEmitCount], s, Room );
+        gEmitCount += Room;
+        s += Room;
+        n -= Room;
     }
 }
 
+/***************************************************************
+** Return how many characters this thread has sent, so the include
+** cache can tell if a file printed anything.
+*/
+ucell_t ioOutputCount( void )
+{
+    return gEmitTotal;
+}
+
 /***************************************************************
 ** Return single character from input device, always keyboard.
 */
 cell_t ioKey( void )
 {
     cell_t c;
+    ioFlush();
     sdEnableInput();
     c = sdTerminalIn();
     sdDisableInput();
@@ -101,12 +158,21 @@ cell_t ioAccept( char *buffer, cell_t maxChars )
 
 DBUGX(("ioAccept(0x%x, 0x%x)\n", buffer, len ));
 
+/* Read a line without echo. There is no way to return EOF so use REFILL to check. */
+    if( gBatchMode )
+    {
+        ioFlush();
+        len = (int) ffReadLine( buffer, maxChars, PF_STDIN );
+        return (len < 0) ? 0 : len;
+    }
+
     sdEnableInput();
 
     p = buffer;
     len = 0;
     while(len < maxChars)
     {
+        ioFlush();
         c = sdTerminalIn();
         switch(c)
         {
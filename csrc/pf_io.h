@@ -39,6 +39,39 @@ int  sdQueryTerminal( void );
 void sdTerminalInit( void );
 void sdTerminalTerm( void );
 cell_t sdSleepMillis( cell_t msec );
+/* Microseconds from a clock that does not go backwards, for UTIME. */
+uint64_t sdMicroseconds( void );
+
+/* Map a whole file into memory. Changes to a writable map go to the file.
+** Returns the address and sets *LenPtr, or returns NULL if it fails.
+** An empty file gives a NULL address and a length of 0. */
+void  *sdMapFile( const char *FileName, int Writable, cell_t *LenPtr );
+/* These return 0 if OK. */
+cell_t sdUnmapFile( void *Address, cell_t Length );
+cell_t sdSyncMapped( void *Address, cell_t Length );
+
+#ifdef PF_SUPPORT_THREADS
+/* Locks shared by all threads. */
+#define PF_LOCK_DICTIONARY  (0)
+#define PF_LOCK_MEMORY      (1)
+#define PF_LOCK_PARALLEL    (2)
+#define PF_LOCK_ASYNC_IO    (3)
+#define PF_LOCK_HEAP        (4)
+#define PF_NUM_LOCKS        (5)
+void   sdLock( int Which );
+void   sdUnlock( int Which );
+/* Each lock has a condition. Wait with the lock held. */
+void   sdWaitCondition( int Which );
+void   sdSignalCondition( int Which );
+/* Let another thread run. */
+void   sdYieldThread( void );
+/* Number of processors available, at least 1. */
+cell_t sdNumProcessors( void );
+/* Run Func(Arg) on a new thread. Returns a handle for sdJoinThread() or 0. */
+cell_t sdCreateThread( void *(*Func)( void * ), void *Arg );
+/* Wait for the thread to finish and free the handle. Returns 0 if OK. */
+cell_t sdJoinThread( cell_t Thread );
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -177,6 +210,15 @@ cell_t ioAccept( char *Target, cell_t n1 );
 cell_t ioKey( void);
 void ioEmit( char c );
 void ioType( const char *s, cell_t n);
+ucell_t ioOutputCount( void );
+void ioFlush( void );
+
+#if defined(PF_SUPPORT_THREADS) && !defined(PF_NO_FILEIO)
+/* Read or write at Offset without using or moving the file position.
+** Safe to call from any thread. Return the number of bytes, or -1. */
+cell_t sdReadFileAt( FileStream *Stream, void *Buffer, cell_t NumBytes, file_offset_t Offset );
+cell_t sdWriteFileAt( FileStream *Stream, const void *Buffer, cell_t NumBytes, file_offset_t Offset );
+#endif
 
 #ifdef __cplusplus
 }
@@ -102,6 +102,28 @@ int main( int argc, char **argv )
                 pfSetQuiet( TRUE );
                 break;
 
+            case 'e':
+                /* -e "forth code", may be repeated. Implies -q and batch mode. */
+                if( *s == '\0' )
+                {
+                    if( (i+1) >= argc )
+                    {
+                        ERR(("-e needs some Forth code!\n"));
+                        Result = 1;
+                        goto on_error;
+                    }
+                    s = argv[++i];
+                }
+                if( pfAddEvaluate( s ) < 0 )
+                {
+                    ERR(("Too many -e options!\n"));
+                    Result = 1;
+                    goto on_error;
+                }
+                pfSetQuiet( TRUE );
+                pfSetBatch( TRUE );
+                break;
+
             case 'd':
                 if( *s != '\0' ) DicName = s;
                 /* Allow space after -d (Thanks Aleksej Saushev) */
@@ -118,7 +140,7 @@ int main( int argc, char **argv )
 
             default:
                 ERR(("Unrecognized option!\n"));
-                ERR(("pforth {-i} {-q} {-dfilename.dic} {sourcefilename}\n"));
+                ERR(("pforth {-i} {-q} {-dfilename.dic} {-e code} {sourcefilename}\n"));
                 Result = 1;
                 goto on_error;
                 break;
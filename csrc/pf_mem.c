@@ -25,6 +25,35 @@
 
 #include "pf_all.h"
 
+/***************************************************************
+** Index of highest and lowest set bit. Value must not be zero.
+** Also used by "pf_pheap.c".
+*/
+int memHighBit( ucell_t Value )
+{
+#if defined(__GNUC__)
+    return (int)(sizeof(unsigned long long) * 8) - 1 - __builtin_clzll( (unsigned long long) Value );
+#else
+    int Bit = 0;
+    while( Value >>= 1 ) Bit++;
+    return Bit;
+#endif
+}
+
+int memLowBit( ucell_t Value )
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll( (unsigned long long) Value );
+#else
+    int Bit = 0;
+    while( (Value & 1) == 0 )
+    {
+        Value >>= 1;
+        Bit++;
+    }
+    return Bit;
+#endif
+}
 
 #ifdef PF_NO_MALLOC
 
@@ -38,332 +67,1218 @@ static ucell_t gMemPoolSize;
 
 #define PF_MEM_BLOCK_SIZE (16)
 
+/* The pool is shared by all threads. */
+#ifdef PF_SUPPORT_THREADS
+    #define LOCK_POOL    sdLock( PF_LOCK_MEMORY )
+    #define UNLOCK_POOL  sdUnlock( PF_LOCK_MEMORY )
+#else
+    #define LOCK_POOL    /* noop */
+    #define UNLOCK_POOL  /* noop */
+#endif
+
 #ifndef PF_MALLOC_ADDRESS
     static char MemoryPool[PF_MEM_POOL_SIZE];
     #define PF_MALLOC_ADDRESS MemoryPool
 #endif
 
 /**********************************************************
-** Doubly Linked List Tools
+** Two level segregated fit allocator.
+**
+** Free blocks are kept on one list per size class. The first level
+** class is the highest set bit of the size, the second level splits
+** that power of two range into MEM_SL_COUNT equal parts.
+** A bitmap for each level says which lists are not empty so finding
+** a free block big enough takes two bit scans, not a list walk.
+** Every block starts with a header holding its size and a pointer
+** to the block physically below it, so a freed block can be merged
+** with its neighbours without searching.
+** Allocate and free take the same time no matter how many blocks
+** are in the pool.
 **********************************************************/
 
-typedef struct DoublyLinkedListNode_s
-{
-    struct DoublyLinkedListNode_s *dlln_Next;
-    struct DoublyLinkedListNode_s *dlln_Previous;
-} DoublyLinkedListNode;
-
-typedef struct DoublyLinkedList_s
-{
-    DoublyLinkedListNode *dll_First;
-    DoublyLinkedListNode *dll_Null;
-    DoublyLinkedListNode *dll_Last;
-} DoublyLinkedList;
+#define MEM_ALIGN_LOG2   (4)   /* log2( PF_MEM_BLOCK_SIZE ) */
+#define MEM_SL_LOG2      (4)
+#define MEM_SL_COUNT     (1 << MEM_SL_LOG2)
+/* Blocks smaller than this all go in first level class zero. */
+#define MEM_FL_SHIFT     (MEM_SL_LOG2 + MEM_ALIGN_LOG2)
+#define MEM_SMALL_BLOCK  (((ucell_t)1) << MEM_FL_SHIFT)
+#define MEM_FL_COUNT     ((int)(sizeof(ucell_t) * 8) - MEM_FL_SHIFT + 1)
 
-#define dllPreviousNode(n) ((n)->dlln_Previous)
-#define dllNextNode(n) ((n)->dlln_Next)
+/* Low bit of mb_Size marks a free block. Sizes are multiples of 16. */
+#define MEM_FREE_FLAG    ((ucell_t)1)
 
-void dllSetupList( DoublyLinkedList *dll )
+typedef struct MemBlock
 {
-    dll->dll_First = &(dll->dll_Null);
-    dll->dll_Null = (DoublyLinkedListNode *) NULL;
-    dll->dll_Last = &(dll->dll_First);
-}
+    struct MemBlock *mb_PrevPhys;  /* Block just below this one, or NULL. */
+    ucell_t          mb_Size;      /* Whole block including header, plus flag. */
+/* The rest is only valid in a free block. A used block holds data here. */
+    struct MemBlock *mb_NextFree;
+    struct MemBlock *mb_PrevFree;
+} MemBlock;
+
+#define MEM_HEADER_SIZE  (2 * sizeof(cell_t))
+#define MEM_MIN_BLOCK    ((sizeof(MemBlock) + PF_MEM_BLOCK_SIZE - 1) & ~(PF_MEM_BLOCK_SIZE - 1))
+
+#define mbSize(b)        ((b)->mb_Size & ~MEM_FREE_FLAG)
+#define mbIsFree(b)      (((b)->mb_Size & MEM_FREE_FLAG) != 0)
+#define mbNextPhys(b)    ((MemBlock *) (((char *) (b)) + mbSize(b)))
+#define mbFromMem(m)     ((MemBlock *) (((char *) (m)) - MEM_HEADER_SIZE))
+#define mbToMem(b)       (((char *) (b)) + MEM_HEADER_SIZE)
+
+static ucell_t   gMemFLBitmap;
+static uint32_t  gMemSLBitmap[MEM_FL_COUNT];
+static MemBlock *gMemFreeLists[MEM_FL_COUNT][MEM_SL_COUNT];
+static ucell_t   gMemUsedBytes;  /* Including headers. */
 
-void dllLinkNodes( DoublyLinkedListNode *Node0, DoublyLinkedListNode *Node1 )
+/***************************************************************
+** Find the list that a free block of this size belongs on.
+*/
+static void memMapping( ucell_t Size, int *FLPtr, int *SLPtr )
 {
-    Node0->dlln_Next = Node1;
-    Node1->dlln_Previous = Node0;
+    if( Size < MEM_SMALL_BLOCK )
+    {
+        *FLPtr = 0;
+        *SLPtr = (int) (Size >> MEM_ALIGN_LOG2);
+    }
+    else
+    {
+        int High = memHighBit( Size );
+        *FLPtr = High - MEM_FL_SHIFT + 1;
+        *SLPtr = (int) ((Size >> (High - MEM_SL_LOG2)) ^ MEM_SL_COUNT);
+    }
 }
 
-void dllInsertNodeBefore( DoublyLinkedListNode *NewNodePtr,
-    DoublyLinkedListNode *NodeInListPtr )
+static void memRemoveFree( MemBlock *mb )
 {
-    DoublyLinkedListNode *NodePreviousPtr = dllPreviousNode( NodeInListPtr );
-    dllLinkNodes( NodePreviousPtr, NewNodePtr );
-    dllLinkNodes( NewNodePtr, NodeInListPtr );
+    int fl, sl;
+    memMapping( mbSize(mb), &fl, &sl );
+    if( mb->mb_PrevFree != NULL )
+    {
+        mb->mb_PrevFree->mb_NextFree = mb->mb_NextFree;
+    }
+    else
+    {
+        gMemFreeLists[fl][sl] = mb->mb_NextFree;
+        if( mb->mb_NextFree == NULL )
+        {
+            gMemSLBitmap[fl] &= ~(((uint32_t)1) << sl);
+            if( gMemSLBitmap[fl] == 0 ) gMemFLBitmap &= ~(((ucell_t)1) << fl);
+        }
+    }
+    if( mb->mb_NextFree != NULL ) mb->mb_NextFree->mb_PrevFree = mb->mb_PrevFree;
+    mb->mb_Size &= ~MEM_FREE_FLAG;
 }
 
-void dllInsertNodeAfter( DoublyLinkedListNode *NewNodePtr,
-    DoublyLinkedListNode *NodeInListPtr )
+static void memInsertFree( MemBlock *mb )
 {
-    DoublyLinkedListNode *NodeNextPtr = dllNextNode( NodeInListPtr );
-    dllLinkNodes( NodeInListPtr, NewNodePtr );
-    dllLinkNodes( NewNodePtr, NodeNextPtr );
+    int fl, sl;
+    memMapping( mbSize(mb), &fl, &sl );
+    mb->mb_Size |= MEM_FREE_FLAG;
+    mb->mb_PrevFree = NULL;
+    mb->mb_NextFree = gMemFreeLists[fl][sl];
+    if( mb->mb_NextFree != NULL ) mb->mb_NextFree->mb_PrevFree = mb;
+    gMemFreeLists[fl][sl] = mb;
+    gMemSLBitmap[fl] |= ((uint32_t)1) << sl;
+    gMemFLBitmap |= ((ucell_t)1) << fl;
 }
 
-void dllDumpNode( DoublyLinkedListNode *NodePtr )
+/***************************************************************
+** Find a free block of at least Size bytes and take it off its list.
+** Size is rounded up to the next list boundary first so that any
+** block on the list found is big enough.
+*/
+static MemBlock *memFindFree( ucell_t Size )
 {
-    TOUCH(NodePtr);
-    DBUG(("  0x%x -> (0x%x) -> 0x%x\n",
-        dllPreviousNode( NodePtr ), NodePtr,
-        dllNextNode( NodePtr ) ));
-}
+    int fl, sl;
+    uint32_t SLMap;
+    ucell_t FLMap;
+    MemBlock *mb;
 
-cell_t dllCheckNode( DoublyLinkedListNode *NodePtr )
-{
-    if( (NodePtr->dlln_Next->dlln_Previous != NodePtr) ||
-        (NodePtr->dlln_Previous->dlln_Next != NodePtr))
+    if( Size >= MEM_SMALL_BLOCK )
     {
-        ERR("dllCheckNode: Bad Node!\n");
-        dllDumpNode( dllPreviousNode( NodePtr ) );
-        dllDumpNode( NodePtr );
-        dllDumpNode( dllNextNode( NodePtr ) );
-        return -1;
+        Size += (((ucell_t)1) << (memHighBit( Size ) - MEM_SL_LOG2)) - 1;
     }
-    else
+    memMapping( Size, &fl, &sl );
+    if( fl >= MEM_FL_COUNT ) return NULL;
+
+    SLMap = gMemSLBitmap[fl] & (~((uint32_t)0) << sl);
+    if( SLMap == 0 )
     {
-        return 0;
+/* Nothing left in this power of two so use the next one with anything. */
+        FLMap = (fl + 1 < MEM_FL_COUNT) ? (gMemFLBitmap & (~((ucell_t)0) << (fl + 1))) : 0;
+        if( FLMap == 0 ) return NULL;
+        fl = memLowBit( FLMap );
+        SLMap = gMemSLBitmap[fl];
     }
+    sl = memLowBit( SLMap );
+    mb = gMemFreeLists[fl][sl];
+    memRemoveFree( mb );
+    return mb;
 }
-void dllRemoveNode( DoublyLinkedListNode *NodePtr )
+
+#ifdef PF_DEBUG
+/***************************************************************
+** Dump every block in the pool, lowest address first.
+*/
+void maDumpList( void )
 {
-    if( dllCheckNode( NodePtr ) == 0 )
+    MemBlock *mb;
+
+    MSG("PForth MemList\n");
+
+    for( mb = (MemBlock *) gMemPoolPtr; mbSize(mb) != 0; mb = mbNextPhys(mb) )
     {
-        dllLinkNodes( dllPreviousNode( NodePtr ), dllNextNode( NodePtr ) );
+        MSG("  Node at = 0x"); ffDotHex((cell_t) mb);
+        MSG_NUM_H(", size = 0x", mbSize(mb));
+        if( mbIsFree(mb) ) MSG(" free\n");
     }
 }
+#endif
 
-void dllAddNodeToHead( DoublyLinkedList *ListPtr, DoublyLinkedListNode *NewNodePtr )
+/***************************************************************
+** Give a block back to the pool, merging it with free neighbours.
+*/
+static void pfFreeRawMem( MemBlock *mb )
 {
-    dllInsertNodeBefore( NewNodePtr, ListPtr->dll_First );
+    MemBlock *Next;
+
+    DBUG(("\npfFreeRawMem( 0x%x )\n", mb ));
+    gMemUsedBytes -= mbSize( mb );
+
+    Next = mbNextPhys( mb );
+    if( mbIsFree( Next ) )
+    {
+DBUG((" Merge (0x%x) -> 0x%x\n", mb, Next ));
+        memRemoveFree( Next );
+        mb->mb_Size += Next->mb_Size;
+    }
+    if( (mb->mb_PrevPhys != NULL) && mbIsFree( mb->mb_PrevPhys ) )
+    {
+        MemBlock *Prev = mb->mb_PrevPhys;
+DBUG((" Merge 0x%x -> (0x%x)\n", Prev, mb ));
+        memRemoveFree( Prev );
+        Prev->mb_Size += mb->mb_Size;
+        mb = Prev;
+    }
+    mbNextPhys( mb )->mb_PrevPhys = mb;
+    memInsertFree( mb );
 }
 
-void dllAddNodeToTail( DoublyLinkedList *ListPtr, DoublyLinkedListNode *NewNodePtr )
+/***************************************************************
+** Setup memory pool as one big free block. Initialize allocator.
+*/
+static void pfInitMemBlock( void *addr, ucell_t poolSize )
 {
-    dllInsertNodeAfter( NewNodePtr, ListPtr->dll_Last );
-}
+    char *AlignedMemory;
+    cell_t AlignedSize;
+    MemBlock *mb, *Sentinel;
+    int fl, sl;
 
-#define dllIsNodeInList( n ) (!((n)->dlln_Next == NULL) )
-#define dllIsLastNode( n ) ((n)->dlln_Next->dll_nNext == NULL )
-#define dllIsListEmpty( l ) ((l)->dll_First == ((DoublyLinkedListNode *) &((l)->dll_Null)) )
-#define dllFirstNode( l ) ((l)->dll_First)
+    pfDebugMessage("pfInitMemBlock()\n");
 
-static DoublyLinkedList gMemList;
+    gMemFLBitmap = 0;
+    gMemUsedBytes = 0;
+    for( fl = 0; fl < MEM_FL_COUNT; fl++ )
+    {
+        gMemSLBitmap[fl] = 0;
+        for( sl = 0; sl < MEM_SL_COUNT; sl++ ) gMemFreeLists[fl][sl] = NULL;
+    }
 
-typedef struct MemListNode
-{
-    DoublyLinkedListNode  mln_Node;
-    cell_t                 mln_Size;
-} MemListNode;
+/* Adjust to next highest aligned memory location. */
+    AlignedMemory = (char *) ((((ucell_t)addr) + PF_MEM_BLOCK_SIZE - 1) &
+                      ~(PF_MEM_BLOCK_SIZE - 1));
+
+/* Adjust size to reflect aligned memory. */
+    AlignedSize = poolSize - (AlignedMemory - (char *) addr);
+
+/* Align size of pool. */
+    AlignedSize = AlignedSize & ~(PF_MEM_BLOCK_SIZE - 1);
+
+/* Set globals. */
+    gMemPoolPtr = AlignedMemory;
+    gMemPoolSize = AlignedSize;
+
+/* A used block of size zero at the top stops merges going past the end. */
+    AlignedSize -= PF_MEM_BLOCK_SIZE;
+    mb = (MemBlock *) AlignedMemory;
+    mb->mb_PrevPhys = NULL;
+    mb->mb_Size = AlignedSize;
+    Sentinel = mbNextPhys( mb );
+    Sentinel->mb_PrevPhys = mb;
+    Sentinel->mb_Size = 0;
+
+/* Free to pool. */
+    memInsertFree( mb );
+}
 
-#ifdef PF_DEBUG
 /***************************************************************
-** Dump memory list.
+** Allocate a block that can hold NumBytes after its header.
+** Split off what is left over if it is big enough to be a block.
 */
-void maDumpList( void )
+static MemBlock *pfAllocRawMem( ucell_t NumBytes )
 {
-    MemListNode *mln;
+    MemBlock *mb;
+    ucell_t Size, RemSize;
 
-    MSG("PForth MemList\n");
+    pfDebugMessage("pfAllocRawMem()\n");
 
-    for( mln = (MemListNode *) dllFirstNode( &gMemList );
-         dllIsNodeInList( (DoublyLinkedListNode *) mln);
-         mln = (MemListNode *) dllNextNode( (DoublyLinkedListNode *) mln ) )
+/* Allocate in whole blocks of 16 bytes */
+    Size = (NumBytes + MEM_HEADER_SIZE + PF_MEM_BLOCK_SIZE - 1) & ~(PF_MEM_BLOCK_SIZE - 1);
+    if( Size < MEM_MIN_BLOCK ) Size = MEM_MIN_BLOCK;
+
+    DBUG(("\npfAllocRawMem( 0x%x )\n", Size ));
+
+    mb = memFindFree( Size );
+    if( mb != NULL )
     {
-        MSG("  Node at = 0x"); ffDotHex(mln);
-        MSG_NUM_H(", size = 0x", mln->mln_Size);
+/* Is there enough left in block to make it worth splitting? */
+        RemSize = mbSize(mb) - Size;
+        if( RemSize >= MEM_MIN_BLOCK )
+        {
+            MemBlock *Rem = (MemBlock *) (((char *) mb) + Size);
+            mb->mb_Size = Size;
+            Rem->mb_PrevPhys = mb;
+            Rem->mb_Size = RemSize;
+            mbNextPhys( Rem )->mb_PrevPhys = Rem;
+            memInsertFree( Rem );
+        }
+        gMemUsedBytes += mbSize( mb );
     }
+/*  maDumpList(); */
+    DBUG(("Allocate mem at 0x%x.\n", mb ));
+    return mb;
 }
-#endif
 
+/***************************************************************
+** Size is kept in the block header.
+*/
+char *pfAllocMem( cell_t NumBytes )
+{
+    MemBlock *mb;
+
+    if( (NumBytes <= 0) || ((ucell_t) NumBytes >= gMemPoolSize) ) return NULL;
+
+    LOCK_POOL;
+    mb = pfAllocRawMem( (ucell_t) NumBytes );
+    UNLOCK_POOL;
+
+    return (mb == NULL) ? NULL : mbToMem( mb );
+}
+
+/***************************************************************
+** Returns true if mb is the start of a block in use. The block
+** above always points back to the start of a real block, so this
+** also catches an old header left inside a block that was merged.
+*/
+static int memIsUsedBlock( MemBlock *mb )
+{
+    char *PoolEnd = gMemPoolPtr + gMemPoolSize - PF_MEM_BLOCK_SIZE;
+    ucell_t Size;
+
+    if( ((char *) mb < gMemPoolPtr) || ((char *) mb >= PoolEnd) || mbIsFree( mb ) ) return 0;
+    Size = mbSize( mb );
+    if( (Size < MEM_MIN_BLOCK) || ((Size & (PF_MEM_BLOCK_SIZE - 1)) != 0) ||
+        (Size > (ucell_t) (PoolEnd - (char *) mb)) ) return 0;
+    return mbNextPhys( mb )->mb_PrevPhys == mb;
+}
 
 /***************************************************************
-** Free mem of any size.
+** Free mem with mem size in block header.
 */
-static void pfFreeRawMem( char *Mem, cell_t NumBytes )
+void pfFreeMem( void *Mem )
 {
-    MemListNode *mln, *FreeNode;
-    MemListNode *AdjacentLower = NULL;
-    MemListNode *AdjacentHigher = NULL;
-    MemListNode *NextBiggest = NULL;
+    MemBlock *mb;
 
-/* Allocate in whole blocks of 16 bytes */
-    DBUG(("\npfFreeRawMem( 0x%x, 0x%x )\n", Mem, NumBytes ));
-    NumBytes = (NumBytes + PF_MEM_BLOCK_SIZE - 1) & ~(PF_MEM_BLOCK_SIZE - 1);
-    DBUG(("\npfFreeRawMem: Align NumBytes to 0x%x\n", NumBytes ));
+    if( Mem == NULL ) return;
+
+    mb = mbFromMem( Mem );
 
 /* Check memory alignment. */
-    if( ( ((cell_t)Mem) & (PF_MEM_BLOCK_SIZE - 1)) != 0)
+    if( ( ((ucell_t)mb) & (PF_MEM_BLOCK_SIZE - 1)) != 0)
     {
-        MSG_NUM_H("pfFreeRawMem: misaligned Mem = 0x", (cell_t) Mem );
+        MSG_NUM_H("pfFreeMem: misaligned Mem = 0x", (cell_t) Mem );
         return;
     }
 
-/* Scan list from low to high looking for various nodes. */
-    for( mln = (MemListNode *) dllFirstNode( &gMemList );
-         dllIsNodeInList( (DoublyLinkedListNode *) mln);
-         mln = (MemListNode *) dllNextNode( (DoublyLinkedListNode *) mln ) )
+    LOCK_POOL;
+    if( !memIsUsedBlock( mb ) )
     {
-        if( (((char *) mln) + mln->mln_Size) == Mem )
-        {
-            AdjacentLower = mln;
-        }
-        else if( ((char *) mln) == ( Mem + NumBytes ))
-        {
-            AdjacentHigher = mln;
-        }
-/* is this the next biggest node. */
-        else if( (NextBiggest == NULL) && (mln->mln_Size >= NumBytes) )
+        MSG_NUM_H("pfFreeMem: not in use, Mem = 0x", (cell_t) Mem );
+    }
+    else
+    {
+        pfFreeRawMem( mb );
+    }
+    UNLOCK_POOL;
+}
+
+void pfInitMemoryAllocator( void )
+{
+    pfInitMemBlock( PF_MALLOC_ADDRESS, PF_MEM_POOL_SIZE );
+}
+
+/***************************************************************
+** For HEAP-STATS. The largest free block is on the highest list
+** that is not empty.
+*/
+void pfMemPoolStats( ucell_t *UsedPtr, ucell_t *FreePtr, ucell_t *LargestPtr )
+{
+    MemBlock *mb;
+    int fl, sl;
+
+    LOCK_POOL;
+    *UsedPtr = gMemUsedBytes;
+/* The sentinel block is not free. */
+    *FreePtr = gMemPoolSize - PF_MEM_BLOCK_SIZE - gMemUsedBytes;
+    *LargestPtr = 0;
+    if( gMemFLBitmap != 0 )
+    {
+        fl = memHighBit( gMemFLBitmap );
+        sl = memHighBit( gMemSLBitmap[fl] );
+        for( mb = gMemFreeLists[fl][sl]; mb != NULL; mb = mb->mb_NextFree )
         {
-            NextBiggest = mln;
+            if( mbSize(mb) > *LargestPtr ) *LargestPtr = mbSize(mb);
         }
     }
+    UNLOCK_POOL;
+}
+#endif /* PF_NO_MALLOC */
+
+/**********************************************************
+** Arenas
+**
+** An arena is one big block that is handed out from the bottom up
+** by moving a pointer, for memory that is all thrown away at once,
+** eg. the temporary buffers used while drawing one frame.
+** The arena header is followed by the data, which starts on a
+** PF_ARENA_ALIGN boundary. Every ARENA-ALLOT keeps that alignment
+** so floats and typed arrays can go anywhere in an arena.
+**********************************************************/
+
+/***************************************************************
+** Returns the number of bytes needed for an arena, or 0 if Size < 0.
+*/
+cell_t pfArenaSize( cell_t Size )
+{
+    if( Size < 0 ) return 0;
+    Size = (Size + PF_ARENA_ALIGN - 1) & ~(PF_ARENA_ALIGN - 1);
+/* Room to align the data wherever the memory ends up. */
+    return sizeof(pfArena_t) + PF_ARENA_ALIGN - 1 + Size;
+}
+
+void pfInitArena( void *Mem, cell_t Size )
+{
+    pfArena_t *ar = (pfArena_t *) Mem;
+    ucell_t Data = (ucell_t) (ar + 1);
+    ar->ar_Data = (char *) ((Data + PF_ARENA_ALIGN - 1) & ~(PF_ARENA_ALIGN - 1));
+    ar->ar_Size = (Size + PF_ARENA_ALIGN - 1) & ~(PF_ARENA_ALIGN - 1);
+    ar->ar_Used = 0;
+}
 
-/* Check to see if we can merge nodes. */
-    if( AdjacentHigher )
+/***************************************************************
+** Returns NULL if there is not enough room left.
+*/
+char *pfArenaAllot( pfArena_t *ar, cell_t NumBytes )
+{
+    char *Mem;
+    if( (NumBytes < 0) || (NumBytes > (ar->ar_Size - ar->ar_Used)) ) return NULL;
+    Mem = ar->ar_Data + ar->ar_Used;
+/* Size is aligned so this cannot go past the end. */
+    ar->ar_Used += (NumBytes + PF_ARENA_ALIGN - 1) & ~(PF_ARENA_ALIGN - 1);
+    return Mem;
+}
+
+/***************************************************************
+** Give back everything allotted since the mark was taken.
+** A mark above the current top is ignored.
+*/
+void pfArenaRelease( pfArena_t *ar, cell_t Mark )
+{
+    if( (Mark >= 0) && (Mark <= ar->ar_Used) ) ar->ar_Used = Mark;
+}
+
+/**********************************************************
+** Object Pools
+**
+** A pool is one slab of Count objects of the same size with a free
+** list threaded through the first cell of each free object, so
+** POOL-GET and POOL-PUT are a couple of pointer moves.
+** A bitmap with one bit per object marks the live ones so that
+** POOL-EACH can visit them in memory order and skip empty runs
+** a cell at a time.
+**********************************************************/
+
+#define PF_POOL_BITS   ((cell_t)(sizeof(ucell_t) * 8))
+#define POOL_MAP_CELLS(count)   (((count) + PF_POOL_BITS - 1) / PF_POOL_BITS)
+
+/***************************************************************
+** Returns the number of bytes needed for a pool, or 0 if the size
+** or count are not positive or too big.
+*/
+cell_t pfPoolSize( cell_t ObjSize, cell_t Count )
+{
+    cell_t Stride;
+    if( (ObjSize <= 0) || (Count <= 0) ) return 0;
+    Stride = (ObjSize + sizeof(cell_t) - 1) & ~(sizeof(cell_t) - 1);
+    if( (ucell_t) Count > ((((ucell_t) -1) >> 2) / Stride) ) return 0;
+    return sizeof(pfPool_t) + (POOL_MAP_CELLS(Count) * sizeof(ucell_t))
+        + PF_ARENA_ALIGN - 1 + (Stride * Count);
+}
+
+void pfInitPool( void *Mem, cell_t ObjSize, cell_t Count )
+{
+    pfPool_t *po = (pfPool_t *) Mem;
+    ucell_t Data;
+    cell_t i;
+
+    po->po_Stride = (ObjSize + sizeof(cell_t) - 1) & ~(sizeof(cell_t) - 1);
+    po->po_Count = Count;
+    po->po_Live = (ucell_t *) (po + 1);
+    for( i=0; i<POOL_MAP_CELLS(Count); i++ ) po->po_Live[i] = 0;
+    Data = (ucell_t) (po->po_Live + POOL_MAP_CELLS(Count));
+    po->po_Data = (char *) ((Data + PF_ARENA_ALIGN - 1) & ~(PF_ARENA_ALIGN - 1));
+
+/* Link lowest address first so the pool fills from the bottom. */
+    po->po_Free = NULL;
+    for( i=Count-1; i>=0; i-- )
     {
-DBUG((" Merge (0x%x) -> 0x%x\n", Mem, AdjacentHigher ));
-        NumBytes += AdjacentHigher->mln_Size;
-        dllRemoveNode( (DoublyLinkedListNode *) AdjacentHigher );
+        char *Obj = po->po_Data + (i * po->po_Stride);
+        *((char **) Obj) = po->po_Free;
+        po->po_Free = Obj;
     }
-    if( AdjacentLower )
+}
+
+/***************************************************************
+** Returns NULL if all of the objects are in use.
+*/
+char *pfPoolGet( pfPool_t *po )
+{
+    char *Obj = po->po_Free;
+    if( Obj != NULL )
     {
-DBUG((" Merge 0x%x -> (0x%x)\n", AdjacentLower, Mem ));
-        AdjacentLower->mln_Size += NumBytes;
+        cell_t Index = (Obj - po->po_Data) / po->po_Stride;
+        po->po_Free = *((char **) Obj);
+        po->po_Live[Index / PF_POOL_BITS] |= ((ucell_t)1) << (Index % PF_POOL_BITS);
     }
-    else
+    return Obj;
+}
+
+/***************************************************************
+** Anything that is not a live object of this pool is ignored.
+*/
+void pfPoolPut( pfPool_t *po, char *Obj )
+{
+    cell_t Offset, Index;
+    ucell_t Bit;
+
+    Offset = Obj - po->po_Data;
+    if( (Offset < 0) || ((Offset % po->po_Stride) != 0) ) return;
+    Index = Offset / po->po_Stride;
+    if( Index >= po->po_Count ) return;
+    Bit = ((ucell_t)1) << (Index % PF_POOL_BITS);
+    if( (po->po_Live[Index / PF_POOL_BITS] & Bit) == 0 ) return;
+
+    po->po_Live[Index / PF_POOL_BITS] &= ~Bit;
+    *((char **) Obj) = po->po_Free;
+    po->po_Free = Obj;
+}
+
+/***************************************************************
+** Call XT ( addr -- ) for each live object, lowest address first.
+** XT may POOL-PUT the object it was given.
+** Stops at the first THROW and returns its code.
+*/
+ThrowCode pfPoolEach( pfPool_t *po, ExecToken XT )
+{
+    cell_t *savedStackPtr = gCurrentTask->td_StackPtr;
+    ThrowCode Result = 0;
+    cell_t w, Bit;
+    ucell_t Live;
+
+    for( w=0; (w<POOL_MAP_CELLS(po->po_Count)) && (Result == 0); w++ )
     {
-DBUG((" Link before 0x%x\n", NextBiggest ));
-        FreeNode = (MemListNode *) Mem;
-        FreeNode->mln_Size = NumBytes;
-        if( NextBiggest == NULL )
+        for( Bit=0; Bit<PF_POOL_BITS; Bit++ )
         {
-/* Nothing bigger so add to end of list. */
-            dllAddNodeToTail( &gMemList, (DoublyLinkedListNode *) FreeNode );
-        }
-        else
-        {
-/* Add this node before the next biggest one we found. */
-            dllInsertNodeBefore( (DoublyLinkedListNode *) FreeNode,
-                (DoublyLinkedListNode *) NextBiggest );
+/* Read the map again each time because XT can change it. */
+            Live = po->po_Live[w] >> Bit;
+            if( Live == 0 ) break;
+            if( (Live & 1) == 0 ) continue;
+            *(--gCurrentTask->td_StackPtr) =
+                (cell_t) (po->po_Data + (((w * PF_POOL_BITS) + Bit) * po->po_Stride));
+            Result = pfCatch( XT );
+            gCurrentTask->td_StackPtr = savedStackPtr;
+            if( Result != 0 ) break;
         }
     }
-
-/*  maDumpList(); */
+    return Result;
 }
 
+/**********************************************************
+** Heap Tracking
+**
+** Memory for ALLOCATE, RESIZE, CHANNEL, ARENA and POOL starts with a
+** pfHeapTag_t that holds its size and the validator that FREE checks.
+** That is all, unless HEAP-TRACK was set when it was allocated.
+** Then the header is a longer pfHeapBlock_t, linked in allocation
+** order so HEAP-LEAKS can list everything that is still allocated,
+** and which word allocated it. Only tracked blocks take the heap lock
+** and are counted by HEAP-STATS.
+** The validator says which header a block has, so FREE works
+** whatever HEAP-TRACK is now.
+**********************************************************/
+
+#ifdef PF_SUPPORT_THREADS
+    #define LOCK_HEAP    sdLock( PF_LOCK_HEAP )
+    #define UNLOCK_HEAP  sdUnlock( PF_LOCK_HEAP )
+#else
+    #define LOCK_HEAP    /* noop */
+    #define UNLOCK_HEAP  /* noop */
+#endif
 
+static pfHeapBlock_t *gHeapFirst;   /* Oldest block. */
+static pfHeapBlock_t *gHeapLast;    /* Newest block. */
+static cell_t  gHeapSerial;
+static cell_t  gHeapLiveBlocks;
+static cell_t  gHeapLiveBytes;
+static cell_t  gHeapPeakBytes;
+static cell_t  gHeapNumFrees;
+/* Count of allocations of up to 2^i bytes. */
+static cell_t  gHeapClassCounts[PF_HEAP_NUM_CLASSES];
+
+#define htFromMem(m)  (((pfHeapTag_t *) (m)) - 1)
+#define htToMem(ht)   ((char *) ((ht) + 1))
+#define hbFromTag(ht) ((pfHeapBlock_t *) ((ht) + 1) - 1)
+#define hbToMem(hb)   ((char *) ((hb) + 1))
+#define htValidator(ht,v)  ((cell_t) (((ucell_t) &(ht)->ht_Validator) ^ (v)))
+
+static int pfHeapClass( cell_t NumBytes )
+{
+    int Class = 0;
+    while( (Class < (PF_HEAP_NUM_CLASSES - 1)) && ((((cell_t)1) << Class) < NumBytes) ) Class++;
+    return Class;
+}
 
 /***************************************************************
-** Setup memory list. Initialize allocator.
+** Returns NULL if NumBytes is negative or there is not enough memory.
+** Site is the IP of the word that is allocating, or 0.
 */
-static void pfInitMemBlock( void *addr, ucell_t poolSize )
+char *pfHeapAlloc( cell_t NumBytes, cell_t Site )
 {
-    char *AlignedMemory;
-    cell_t AlignedSize;
+    pfHeapTag_t *ht;
+    pfHeapBlock_t *hb;
 
-    pfDebugMessage("pfInitMemBlock()\n");
-/* Set globals. */
-    gMemPoolPtr = addr;
-    gMemPoolSize = poolSize;
+    if( (NumBytes < 0) || (NumBytes > (cell_t)((((ucell_t) -1) >> 1) - sizeof(pfHeapBlock_t))) ) return NULL;
 
-    dllSetupList( &gMemList );
+    if( !gVarHeapTrack )
+    {
+        ht = (pfHeapTag_t *) pfAllocMem( sizeof(pfHeapTag_t) + NumBytes );
+        if( ht == NULL ) return NULL;
+        ht->ht_Size = NumBytes;
+        ht->ht_Validator = htValidator( ht, PF_MEMORY_VALIDATOR );
+        return htToMem( ht );
+    }
 
-/* Adjust to next highest aligned memory location. */
-    AlignedMemory = (char *) ((((cell_t)gMemPoolPtr) + PF_MEM_BLOCK_SIZE - 1) &
-                      ~(PF_MEM_BLOCK_SIZE - 1));
+    hb = (pfHeapBlock_t *) pfAllocMem( sizeof(pfHeapBlock_t) + NumBytes );
+    if( hb == NULL ) return NULL;
+
+    hb->hb_Tag.ht_Size = NumBytes;
+    hb->hb_Site = Site;
+    hb->hb_Tag.ht_Validator = htValidator( &hb->hb_Tag, PF_MEMORY_VALIDATOR_TRACKED );
+
+    LOCK_HEAP;
+    hb->hb_Serial = ++gHeapSerial;
+    hb->hb_Next = NULL;
+    hb->hb_Prev = gHeapLast;
+    if( gHeapLast != NULL ) gHeapLast->hb_Next = hb;
+    else gHeapFirst = hb;
+    gHeapLast = hb;
+    gHeapLiveBlocks += 1;
+    gHeapLiveBytes += NumBytes;
+    if( gHeapLiveBytes > gHeapPeakBytes ) gHeapPeakBytes = gHeapLiveBytes;
+    gHeapClassCounts[ pfHeapClass( NumBytes ) ] += 1;
+    UNLOCK_HEAP;
+
+    return hbToMem( hb );
+}
 
-/* Adjust size to reflect aligned memory. */
-    AlignedSize = gMemPoolSize - (AlignedMemory - gMemPoolPtr);
+/***************************************************************
+** Returns true if Mem was returned by pfHeapAlloc() and not freed.
+*/
+int pfHeapValid( void *Mem )
+{
+    pfHeapTag_t *ht;
+    if( Mem == NULL ) return 0;
+    ht = htFromMem( Mem );
+    return (ht->ht_Validator == htValidator( ht, PF_MEMORY_VALIDATOR ))
+        || (ht->ht_Validator == htValidator( ht, PF_MEMORY_VALIDATOR_TRACKED ));
+}
 
-/* Align size of pool. */
-    AlignedSize = AlignedSize & ~(PF_MEM_BLOCK_SIZE - 1);
+/***************************************************************
+** Returns 0, or -1 if Mem was not allocated by pfHeapAlloc().
+*/
+cell_t pfHeapFree( void *Mem )
+{
+    pfHeapTag_t *ht;
+    pfHeapBlock_t *hb;
 
-/* Free to pool. */
-    pfFreeRawMem( AlignedMemory, AlignedSize );
+    if( !pfHeapValid( Mem ) ) return -1;
+    ht = htFromMem( Mem );
+    if( ht->ht_Validator == htValidator( ht, PF_MEMORY_VALIDATOR ) )
+    {
+        ht->ht_Validator = 0xDeadBeef;
+        pfFreeMem( ht );
+        return 0;
+    }
 
+    hb = hbFromTag( ht );
+/* Clobber validator so it cannot be freed twice. */
+    ht->ht_Validator = 0xDeadBeef;
+
+    LOCK_HEAP;
+    if( hb->hb_Prev != NULL ) hb->hb_Prev->hb_Next = hb->hb_Next;
+    else gHeapFirst = hb->hb_Next;
+    if( hb->hb_Next != NULL ) hb->hb_Next->hb_Prev = hb->hb_Prev;
+    else gHeapLast = hb->hb_Prev;
+    gHeapLiveBlocks -= 1;
+    gHeapLiveBytes -= ht->ht_Size;
+    gHeapNumFrees += 1;
+    UNLOCK_HEAP;
+
+    pfFreeMem( hb );
+    return 0;
 }
 
 /***************************************************************
-** Allocate mem from list of free nodes.
+** Returns the new memory, or NULL if there was not enough and the
+** old memory is unchanged. Mem must be valid.
 */
-static char *pfAllocRawMem( cell_t NumBytes )
+char *pfHeapResize( void *Mem, cell_t NumBytes, cell_t Site )
 {
-    char *Mem = NULL;
-    MemListNode *mln;
-    pfDebugMessage("pfAllocRawMem()\n");
+    char *NewMem = pfHeapAlloc( NumBytes, Site );
+    if( NewMem != NULL )
+    {
+        cell_t OldSize = htFromMem( Mem )->ht_Size;
+        pfCopyMemory( NewMem, Mem, (OldSize < NumBytes) ? OldSize : NumBytes );
+        pfHeapFree( Mem );
+    }
+    return NewMem;
+}
 
-    if( NumBytes <= 0 ) return NULL;
+/***************************************************************
+** Print the name of the word that Site is in, and the offset.
+** Returns 0 if Site is not in a colon definition.
+*/
+static int pfHeapSiteName( cell_t Site, int Machine )
+{
+    const ForthString *NFA;
+    const ForthString *Best = NULL;
+    ExecToken XT, BestXT = 0, SiteXT;
 
-/* Allocate in whole blocks of 16 bytes */
-    NumBytes = (NumBytes + PF_MEM_BLOCK_SIZE - 1) & ~(PF_MEM_BLOCK_SIZE - 1);
+    if( ((ucell_t) Site < (ucell_t) CODE_BASE) ||
+        ((ucell_t) Site >= gCurrentDictionary->dic_CodeLimit) ) return 0;
+    SiteXT = (ExecToken) ABS_TO_CODEREL( Site );
+
+/* Secondary XTs are code offsets so the closest one below is the word. */
+    for( NFA = (const ForthString *) gVarContext; NFA != NULL; NFA = NameToPrevious( NFA ) )
+    {
+        XT = NameToToken( NFA );
+        if( (XT >= NUM_PRIMITIVES) && (XT <= SiteXT) && (XT > BestXT) )
+        {
+            Best = NFA;
+            BestXT = XT;
+        }
+    }
+    if( Best == NULL ) return 0;
+
+    ioType( (const char *) Best + 1, (ucell_t) (*Best) & MASK_NAME_SIZE );
+    MSG( Machine ? " " : " +" );
+    MSG( ConvertNumberToText( (cell_t) (SiteXT - BestXT), 10, TRUE, 1 ) );
+    return 1;
+}
+
+static void pfHeapNumber( cell_t n )
+{
+    MSG( ConvertNumberToText( n, 10, TRUE, 1 ) );
+    EMIT(' ');
+}
 
-    DBUG(("\npfAllocRawMem( 0x%x )\n", NumBytes ));
+/***************************************************************
+** HEAP-STATS
+*/
+void pfHeapStats( void )
+{
+    int i;
+#ifdef PF_NO_MALLOC
+    ucell_t Used, Free, Largest;
+#endif
 
-/* Scan list from low to high until we find a node big enough. */
-    for( mln = (MemListNode *) dllFirstNode( &gMemList );
-         dllIsNodeInList( (DoublyLinkedListNode *) mln);
-         mln = (MemListNode *) dllNextNode( (DoublyLinkedListNode *) mln ) )
+    LOCK_HEAP;
+    MSG("Heap: "); pfHeapNumber( gHeapLiveBlocks );
+    MSG("blocks, "); pfHeapNumber( gHeapLiveBytes );
+    MSG("bytes, peak "); pfHeapNumber( gHeapPeakBytes );
+    MSG("bytes\n      "); pfHeapNumber( gHeapSerial );
+    MSG("allocated, "); pfHeapNumber( gHeapNumFrees );
+    MSG("freed\n");
+    for( i=0; i<PF_HEAP_NUM_CLASSES; i++ )
     {
-        if( mln->mln_Size >= NumBytes )
+        if( gHeapClassCounts[i] != 0 )
         {
-            cell_t RemSize;
+            MSG("  up to "); pfHeapNumber( ((cell_t)1) << i );
+            MSG("bytes: "); pfHeapNumber( gHeapClassCounts[i] );
+            EMIT_CR;
+        }
+    }
+    UNLOCK_HEAP;
+
+#ifdef PF_NO_MALLOC
+    pfMemPoolStats( &Used, &Free, &Largest );
+    MSG("Pool: "); pfHeapNumber( (cell_t) Used );
+    MSG("bytes used, "); pfHeapNumber( (cell_t) Free );
+    MSG("free, largest free block "); pfHeapNumber( (cell_t) Largest );
+    EMIT_CR;
+#endif
+}
+
+/***************************************************************
+** HEAP-LEAKS, list everything still allocated, oldest first.
+*/
+void pfHeapLeaks( void )
+{
+    pfHeapBlock_t *hb;
 
-            Mem = (char *) mln;
+    LOCK_HEAP;
+    for( hb = gHeapFirst; hb != NULL; hb = hb->hb_Next )
+    {
+        MSG("  #"); pfHeapNumber( hb->hb_Serial );
+        pfHeapNumber( hb->hb_Tag.ht_Size );
+        MSG("bytes at "); ffDotHex( (cell_t) hbToMem( hb ) );
+        MSG("from ");
+        if( !pfHeapSiteName( hb->hb_Site, FALSE ) ) MSG("?");
+        EMIT_CR;
+    }
+    MSG_NUM_D("Blocks allocated = ", gHeapLiveBlocks );
+    UNLOCK_HEAP;
+}
 
-/* Remove this node from list. */
-            dllRemoveNode( (DoublyLinkedListNode *) mln );
+/***************************************************************
+** HEAP-DUMP, the same in decimal for other programs to read.
+**    heap live-blocks live-bytes peak-bytes allocated freed
+**    class max-bytes count
+**    block serial address bytes word offset  (word is - if unknown)
+**    pool used free largest  (PF_NO_MALLOC only)
+**    end
+*/
+void pfHeapDump( void )
+{
+    pfHeapBlock_t *hb;
+    int i;
+#ifdef PF_NO_MALLOC
+    ucell_t Used, Free, Largest;
+#endif
 
-/* Is there enough left in block to make it worth splitting? */
-            RemSize = mln->mln_Size - NumBytes;
-            if( RemSize >= PF_MEM_BLOCK_SIZE )
-            {
-                pfFreeRawMem( (Mem + NumBytes), RemSize );
-            }
-            break;
+    LOCK_HEAP;
+    MSG("heap "); pfHeapNumber( gHeapLiveBlocks ); pfHeapNumber( gHeapLiveBytes );
+    pfHeapNumber( gHeapPeakBytes ); pfHeapNumber( gHeapSerial ); pfHeapNumber( gHeapNumFrees );
+    EMIT_CR;
+    for( i=0; i<PF_HEAP_NUM_CLASSES; i++ )
+    {
+        if( gHeapClassCounts[i] != 0 )
+        {
+            MSG("class "); pfHeapNumber( ((cell_t)1) << i ); pfHeapNumber( gHeapClassCounts[i] );
+            EMIT_CR;
         }
+    }
+    for( hb = gHeapFirst; hb != NULL; hb = hb->hb_Next )
+    {
+        MSG("block "); pfHeapNumber( hb->hb_Serial );
+        MSG( ConvertNumberToText( (cell_t) hbToMem( hb ), 10, FALSE, 1 ) ); EMIT(' ');
+        pfHeapNumber( hb->hb_Tag.ht_Size );
+        if( !pfHeapSiteName( hb->hb_Site, TRUE ) ) MSG("- 0");
+        EMIT_CR;
+    }
+    UNLOCK_HEAP;
+#ifdef PF_NO_MALLOC
+    pfMemPoolStats( &Used, &Free, &Largest );
+    MSG("pool "); pfHeapNumber( (cell_t) Used ); pfHeapNumber( (cell_t) Free ); pfHeapNumber( (cell_t) Largest );
+    EMIT_CR;
+#endif
+    MSG("end\n");
+}
 
+/**********************************************************
+** Buffers for BUFFER:
+**
+** The body of a BUFFER: word holds only its size and a slot in
+** gBufferTable, so SAVE-FORTH saves two cells instead of the data.
+** The memory is allocated and cleared the first time the word runs.
+** After a dictionary is loaded the table is empty. The slot in the
+** body may then be wrong so it is looked for and fixed on first use.
+**
+** Once a buffer is allocated the word only reads the table, without
+** the heap lock. So entries are never moved. A forgotten buffer only
+** clears its entry, and an old table is kept when the table grows,
+** in case another thread is still reading it.
+**********************************************************/
+
+#ifdef PF_SUPPORT_THREADS
+    #define LOAD_ACQUIRE(p)       __atomic_load_n( (p), __ATOMIC_ACQUIRE )
+    #define STORE_RELEASE(p,v)    __atomic_store_n( (p), (v), __ATOMIC_RELEASE )
+#else
+    #define LOAD_ACQUIRE(p)       (*(p))
+    #define STORE_RELEASE(p,v)    (*(p) = (v))
+#endif
+
+typedef struct pfBuffer_s
+{
+    ucell_t  bu_Body;  /* 0 if the slot is empty. */
+    char    *bu_Data;
+} pfBuffer_t;
+
+static pfBuffer_t *gBufferTable;
+static cell_t  gBufferCount;
+static cell_t  gBufferMax;
+static pfBuffer_t *gBufferOldTables[sizeof(cell_t) * 8];  /* The table doubles each time. */
+static cell_t  gBufferOldCount;
+
+/***************************************************************
+** Compile the body of a new BUFFER: word at HERE.
+** Buffers at or above HERE were forgotten so free them first.
+*/
+void pfBufferCreate( cell_t Size )
+{
+    ucell_t Here = (ucell_t) CODE_HERE;
+    cell_t i;
+
+    LOCK_HEAP;
+    for( i=0; i<gBufferCount; i++ )
+    {
+        if( gBufferTable[i].bu_Body >= Here )
+        {
+            STORE_RELEASE( &gBufferTable[i].bu_Body, 0 );
+            pfFreeMem( gBufferTable[i].bu_Data );
+            gBufferTable[i].bu_Data = NULL;
+        }
     }
-/*  maDumpList(); */
-    DBUG(("Allocate mem at 0x%x.\n", Mem ));
-    return Mem;
+    UNLOCK_HEAP;
+
+    CODE_COMMA( (Size > 0) ? Size : 0 );
+    CODE_COMMA( -1 );  /* No slot yet. */
 }
 
 /***************************************************************
-** Keep mem size at first cell.
+** Find or allocate the buffer with the heap lock held.
 */
-char *pfAllocMem( cell_t NumBytes )
+static char *pfBufferAllocate( cell_t *Body )
 {
-    cell_t *IntMem;
+    cell_t Slot, Empty = -1;
+    cell_t Size;
+    char *Data;
 
-    if( NumBytes <= 0 ) return NULL;
+    for( Slot=0; Slot<gBufferCount; Slot++ )
+    {
+        if( gBufferTable[Slot].bu_Body == (ucell_t) Body ) goto found;
+        if( (Empty < 0) && (gBufferTable[Slot].bu_Body == 0) ) Empty = Slot;
+    }
 
-/* Allocate an extra cell for size. */
-    NumBytes += sizeof(cell_t);
+    if( (Empty < 0) && (gBufferCount == gBufferMax) )
+    {
+        cell_t NewMax = (gBufferMax > 0) ? (gBufferMax * 2) : 16;
+        pfBuffer_t *NewTable = (pfBuffer_t *) pfAllocMem( NewMax * sizeof(pfBuffer_t) );
+        if( NewTable == NULL ) return NULL;
+        if( gBufferTable != NULL )
+        {
+            pfCopyMemory( NewTable, gBufferTable, gBufferCount * sizeof(pfBuffer_t) );
+            gBufferOldTables[gBufferOldCount++] = gBufferTable;
+        }
+        STORE_RELEASE( &gBufferTable, NewTable );
+        gBufferMax = NewMax;
+    }
+    Size = (cell_t) READ_CELL_DIC( Body );
+    Data = pfAllocMem( (Size > 0) ? Size : 1 );
+    if( Data == NULL ) return NULL;
+    pfSetMemory( Data, 0, Size );
+
+    Slot = (Empty >= 0) ? Empty : gBufferCount;
+    gBufferTable[Slot].bu_Data = Data;
+    STORE_RELEASE( &gBufferTable[Slot].bu_Body, (ucell_t) Body );
+    if( Slot == gBufferCount ) STORE_RELEASE( &gBufferCount, gBufferCount + 1 );
+found:
+    WRITE_CELL_DIC( Body + 1, Slot );
+    return gBufferTable[Slot].bu_Data;
+}
 
-    IntMem = (cell_t *)pfAllocRawMem( NumBytes );
+/***************************************************************
+** Returns the data of the BUFFER: word with this body,
+** or NULL if there is not enough memory.
+*/
+char *pfBufferAddress( cell_t *Body )
+{
+    cell_t Slot = (cell_t) READ_CELL_DIC( Body + 1 );
+    cell_t Count = LOAD_ACQUIRE( &gBufferCount );  /* Before the table, which grows first. */
+    pfBuffer_t *Table = LOAD_ACQUIRE( &gBufferTable );
+    char *Data;
 
-    if( IntMem != NULL ) *IntMem++ = NumBytes;
+    if( (Slot >= 0) && (Slot < Count)
+        && (LOAD_ACQUIRE( &Table[Slot].bu_Body ) == (ucell_t) Body) )
+    {
+        return Table[Slot].bu_Data;
+    }
 
-    return (char *) IntMem;
+    LOCK_HEAP;
+    Data = pfBufferAllocate( Body );
+    UNLOCK_HEAP;
+    return Data;
 }
 
 /***************************************************************
-** Free mem with mem size at first cell.
+** Free every buffer when the dictionary is deleted.
 */
-void pfFreeMem( void *Mem )
+void pfBufferFreeAll( void )
 {
-    cell_t *IntMem;
-    cell_t NumBytes;
+    cell_t i;
+    LOCK_HEAP;
+    for( i=0; i<gBufferCount; i++ )
+    {
+        if( gBufferTable[i].bu_Data != NULL ) pfFreeMem( gBufferTable[i].bu_Data );
+    }
+    if( gBufferTable != NULL ) pfFreeMem( gBufferTable );
+    gBufferTable = NULL;
+    for( i=0; i<gBufferOldCount; i++ ) pfFreeMem( gBufferOldTables[i] );
+    gBufferOldCount = 0;
+    gBufferCount = 0;
+    gBufferMax = 0;
+    UNLOCK_HEAP;
+}
 
-    if( Mem == NULL ) return;
+/**********************************************************
+** Strings with a zero after them for >ZSTRING
+**
+** One copy with a zero after it is kept for each address that
+** >ZSTRING is given. If the text there has changed, the copy is
+** written again in place when it fits, so text that is made again
+** every frame in PAD or a buffer does not use more memory.
+** So the string from >ZSTRING is good until >ZSTRING is given the
+** same address again.
+**
+** Copies are found by their source address in gZSources, and by
+** their own address in gZCopies so pfIsZString() does not search.
+**********************************************************/
+
+typedef struct pfZCopy_s
+{
+    cell_t  zc_Len;
+    cell_t  zc_Room;     /* Most characters that fit, not counting the zero. */
+} pfZCopy_t;
+
+#define ZCOPY_DATA(zc)  ((char *) ((zc) + 1))
 
-/* Allocate an extra cell for size. */
-    IntMem = (cell_t *) Mem;
-    IntMem--;
-    NumBytes = *IntMem;
+/* Open addressing hash table. Key 0 is an empty slot. */
+typedef struct pfZSlot_s
+{
+    ucell_t     zt_Key;
+    pfZCopy_t  *zt_Copy;
+} pfZSlot_t;
+
+typedef struct pfZTable_s
+{
+    pfZSlot_t *zt_Slots;
+    cell_t     zt_Count;
+    cell_t     zt_Max;    /* Power of 2. */
+} pfZTable_t;
 
-    pfFreeRawMem( (char *) IntMem, NumBytes );
+static pfZTable_t gZSources;
+static pfZTable_t gZCopies;
+static char gZEmpty[1];          /* For address 0, which is not kept. */
 
+static cell_t pfZHash( ucell_t Key, cell_t Max )
+{
+    ucell_t h = (Key ^ (Key >> 13)) * (ucell_t) 0x9E3779B1;
+    return (cell_t) ((h >> 8) & (ucell_t) (Max - 1));
 }
 
-void pfInitMemoryAllocator( void )
+/* Find the slot for Key, or the empty slot where it goes. */
+static pfZSlot_t *pfZFind( pfZTable_t *Table, ucell_t Key )
 {
-    pfInitMemBlock( PF_MALLOC_ADDRESS, PF_MEM_POOL_SIZE );
+    cell_t i = pfZHash( Key, Table->zt_Max );
+    while( (Table->zt_Slots[i].zt_Key != 0) && (Table->zt_Slots[i].zt_Key != Key) )
+    {
+        i = (i + 1) & (Table->zt_Max - 1);
+    }
+    return &Table->zt_Slots[i];
 }
-#else /* PF_NO_MALLOC */
 
-int not_an_empty_file;  /* Stops nasty compiler warnings when PF_NO_MALLOC not defined. */
+/* Returns the copy for Key, or NULL. */
+static pfZCopy_t *pfZLookup( pfZTable_t *Table, ucell_t Key )
+{
+    return (Table->zt_Count == 0) ? NULL : pfZFind( Table, Key )->zt_Copy;
+}
 
-#endif /* PF_NO_MALLOC */
+/* Make room for one more, growing when half full.
+** Returns -1 if there is not enough memory. */
+static int pfZReserve( pfZTable_t *Table )
+{
+    pfZSlot_t *OldSlots = Table->zt_Slots;
+    cell_t OldMax = Table->zt_Max;
+    cell_t NewMax = (OldMax > 0) ? (OldMax * 2) : 64;
+    cell_t i;
+
+    if( (Table->zt_Count + 1) * 2 <= OldMax ) return 0;
+    Table->zt_Slots = (pfZSlot_t *) pfAllocMem( NewMax * sizeof(pfZSlot_t) );
+    if( Table->zt_Slots == NULL )
+    {
+        Table->zt_Slots = OldSlots;
+        return -1;
+    }
+    pfSetMemory( Table->zt_Slots, 0, NewMax * sizeof(pfZSlot_t) );
+    Table->zt_Max = NewMax;
+    for( i=0; i<OldMax; i++ )
+    {
+        if( OldSlots[i].zt_Key != 0 ) *pfZFind( Table, OldSlots[i].zt_Key ) = OldSlots[i];
+    }
+    if( OldSlots != NULL ) pfFreeMem( OldSlots );
+    return 0;
+}
+
+/* Remove Key, moving later slots back so that none are lost. */
+static void pfZRemove( pfZTable_t *Table, ucell_t Key )
+{
+    pfZSlot_t *Slots = Table->zt_Slots;
+    cell_t Mask = Table->zt_Max - 1;
+    cell_t Hole = pfZFind( Table, Key ) - Slots;
+    cell_t i = Hole;
+
+    if( Slots[Hole].zt_Key == 0 ) return;
+    Slots[Hole].zt_Key = 0;
+    Slots[Hole].zt_Copy = NULL;
+    Table->zt_Count--;
+    for(;;)
+    {
+        cell_t Home;
+        i = (i + 1) & Mask;
+        if( Slots[i].zt_Key == 0 ) break;
+        Home = pfZHash( Slots[i].zt_Key, Table->zt_Max );
+/* Move it back if its home is not between the hole and here. */
+        if( ((i - Home) & Mask) >= ((i - Hole) & Mask) )
+        {
+            Slots[Hole] = Slots[i];
+            Slots[i].zt_Key = 0;
+            Slots[i].zt_Copy = NULL;
+            Hole = i;
+        }
+    }
+}
+
+static void pfZFreeCopy( pfZCopy_t *Copy )
+{
+    pfZRemove( &gZCopies, (ucell_t) ZCOPY_DATA( Copy ) );
+    pfFreeMem( Copy );
+}
+
+/***************************************************************
+** >ZSTRING, returns a copy of the string with a zero after it,
+** or NULL if there is not enough memory.
+*/
+const char *pfZString( cell_t Addr, cell_t Len )
+{
+    pfZSlot_t *Source, *Slot;
+    pfZCopy_t *Copy, *Old;
+    char *Result = NULL;
+
+    if( Addr == 0 ) return gZEmpty;
+    if( Len < 0 ) Len = 0;
+    LOCK_HEAP;
+/* A copy is its own copy. */
+    Copy = pfZLookup( &gZCopies, (ucell_t) Addr );
+    if( (Copy != NULL) && (Copy->zc_Len == Len) )
+    {
+        Result = ZCOPY_DATA( Copy );
+        goto done;
+    }
+
+    if( (pfZReserve( &gZSources ) < 0) || (pfZReserve( &gZCopies ) < 0) ) goto done;
+    Source = pfZFind( &gZSources, (ucell_t) Addr );
+    Old = Source->zt_Copy;
+    if( (Old != NULL) && (Old->zc_Len == Len) &&
+        (pfMatchChars( ZCOPY_DATA( Old ), (const char *) Addr, (ucell_t) Len ) == (ucell_t) Len) )
+    {
+        Result = ZCOPY_DATA( Old );
+        goto done;
+    }
+
+    if( (Old != NULL) && (Len <= Old->zc_Room) )
+    {
+        Copy = Old;
+    }
+    else
+    {
+        Copy = (pfZCopy_t *) pfAllocMem( sizeof(pfZCopy_t) + Len + 1 );
+        if( Copy == NULL ) goto done;
+        Copy->zc_Room = Len;
+        if( Old != NULL )
+        {
+            pfZFreeCopy( Old );
+        }
+        else
+        {
+            Source->zt_Key = (ucell_t) Addr;
+            gZSources.zt_Count++;
+        }
+        Source->zt_Copy = Copy;
+        Slot = pfZFind( &gZCopies, (ucell_t) ZCOPY_DATA( Copy ) );
+        Slot->zt_Key = (ucell_t) ZCOPY_DATA( Copy );
+        Slot->zt_Copy = Copy;
+        gZCopies.zt_Count++;
+    }
+    Copy->zc_Len = Len;
+    pfCopyMemory( ZCOPY_DATA( Copy ), (const char *) Addr, (ucell_t) Len );
+    ZCOPY_DATA( Copy )[Len] = '\0';
+    Result = ZCOPY_DATA( Copy );
+done:
+    UNLOCK_HEAP;
+    return Result;
+}
+
+/***************************************************************
+** Returns true if the string has a zero after it, so it can be
+** passed to C without a copy. The zero is only looked for in the
+** dictionary and in copies from >ZSTRING.
+*/
+int pfIsZString( cell_t Addr, cell_t Len )
+{
+    const char *Start = (const char *) Addr;
+    const char *End = Start + Len;
+    pfZCopy_t *Copy;
+    int Result = 0;
+
+    if( (Addr == 0) || (Len < 0) ) return 0;
+    if( (gCurrentDictionary != NULL) && ((ucell_t) Start >= CODE_BASE)
+        && ((ucell_t) End < gCurrentDictionary->dic_CodeLimit) )
+    {
+        return *End == '\0';
+    }
+    if( gZCopies.zt_Count == 0 ) return 0;
+    LOCK_HEAP;
+    Copy = pfZLookup( &gZCopies, (ucell_t) Addr );
+    Result = (Copy != NULL) && (Copy->zc_Len == Len);
+    UNLOCK_HEAP;
+    return Result;
+}
+
+/***************************************************************
+** Free the copies when the dictionary is deleted.
+*/
+void pfZStringFreeAll( void )
+{
+    cell_t i;
+    LOCK_HEAP;
+    for( i=0; i<gZCopies.zt_Max; i++ )
+    {
+        if( gZCopies.zt_Slots[i].zt_Key != 0 ) pfFreeMem( gZCopies.zt_Slots[i].zt_Copy );
+    }
+    if( gZCopies.zt_Slots != NULL ) pfFreeMem( gZCopies.zt_Slots );
+    if( gZSources.zt_Slots != NULL ) pfFreeMem( gZSources.zt_Slots );
+    gZCopies.zt_Slots = gZSources.zt_Slots = NULL;
+    gZCopies.zt_Count = gZSources.zt_Count = 0;
+    gZCopies.zt_Max = gZSources.zt_Max = 0;
+    UNLOCK_HEAP;
+}
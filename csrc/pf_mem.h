@@ -30,6 +30,7 @@
     void  pfInitMemoryAllocator( void );
     char *pfAllocMem( cell_t NumBytes );
     void  pfFreeMem( void *Mem );
+    void  pfMemPoolStats( ucell_t *UsedPtr, ucell_t *FreePtr, ucell_t *LargestPtr );
 
     #ifdef __cplusplus
     }
@@ -50,4 +51,86 @@
 
 #endif /* PF_NO_MALLOC */
 
+/* Headers for ALLOCATE and friends. See "Heap Tracking" in "pf_mem.c". */
+#define PF_MEMORY_VALIDATOR  (0xA81B4D69)
+#define PF_MEMORY_VALIDATOR_TRACKED  (0x5D0C72B3)
+#define PF_HEAP_NUM_CLASSES  (32)
+
+/* Just before the memory of every block. */
+typedef struct pfHeapTag_s
+{
+    cell_t  ht_Size;       /* Bytes asked for. */
+    cell_t  ht_Validator;  /* Address of this cell XOR one of the validators. */
+} pfHeapTag_t;
+
+/* Blocks allocated while HEAP-TRACK is set have this longer header. */
+typedef struct pfHeapBlock_s
+{
+    struct pfHeapBlock_s *hb_Next;
+    struct pfHeapBlock_s *hb_Prev;
+    cell_t  hb_Site;       /* IP in the word that allocated it, or 0. */
+    cell_t  hb_Serial;     /* Counts up from 1. */
+    pfHeapTag_t hb_Tag;
+} pfHeapBlock_t;
+
+/* Arenas for ARENA ARENA-ALLOT ARENA-MARK ARENA-RELEASE ARENA-RESET.
+** Allocated with pfHeapAlloc() so that FREE can free them. */
+#define PF_ARENA_ALIGN (16)
+
+typedef struct pfArena_s
+{
+    char   *ar_Data;  /* Aligned start of data. */
+    cell_t  ar_Size;  /* Bytes of data. */
+    cell_t  ar_Used;  /* Bytes allotted, the mark. */
+} pfArena_t;
+
+/* Object pools for POOL POOL-GET POOL-PUT POOL-EACH.
+** Also allocated with pfHeapAlloc(). */
+typedef struct pfPool_s
+{
+    char    *po_Data;    /* First object, aligned like an arena. */
+    ucell_t *po_Live;    /* One bit per object, set if in use. */
+    char    *po_Free;    /* First free object, which holds the next. */
+    cell_t   po_Stride;  /* Object size rounded up to a whole cell. */
+    cell_t   po_Count;
+} pfPool_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int    memHighBit( ucell_t Value );
+int    memLowBit( ucell_t Value );
+
+char  *pfHeapAlloc( cell_t NumBytes, cell_t Site );
+char  *pfHeapResize( void *Mem, cell_t NumBytes, cell_t Site );
+cell_t pfHeapFree( void *Mem );
+int    pfHeapValid( void *Mem );
+void   pfHeapStats( void );
+void   pfHeapLeaks( void );
+void   pfHeapDump( void );
+
+cell_t pfArenaSize( cell_t Size );
+void   pfInitArena( void *Mem, cell_t Size );
+char  *pfArenaAllot( pfArena_t *ar, cell_t NumBytes );
+void   pfArenaRelease( pfArena_t *ar, cell_t Mark );
+
+cell_t pfPoolSize( cell_t ObjSize, cell_t Count );
+void   pfInitPool( void *Mem, cell_t ObjSize, cell_t Count );
+char  *pfPoolGet( pfPool_t *po );
+void   pfPoolPut( pfPool_t *po, char *Obj );
+ThrowCode pfPoolEach( pfPool_t *po, ExecToken XT );
+
+void   pfBufferCreate( cell_t Size );
+char  *pfBufferAddress( cell_t *Body );
+void   pfBufferFreeAll( void );
+
+const char *pfZString( cell_t Addr, cell_t Len );
+int    pfIsZString( cell_t Addr, cell_t Len );
+void   pfZStringFreeAll( void );
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* _pf_mem_h */
@@ -0,0 +1,372 @@
+/* @(#) pf_pheap.c 2026-10-19 */
+/***************************************************************
+** Persistent heap for PForth
+**
+** The persistent heap is a file mapped into memory that ALLOCATE
+** can use instead of the normal heap. Whatever is built in it is
+** still there the next time the file is opened, with no loading or
+** saving. The file may be mapped at a different address each time
+** so pointers kept in the heap must be stored as offsets from the
+** start of the file, like the dictionary does with CODEREL.
+** PHEAP-REL and PHEAP-ABS convert, and PHEAP-ROOT@ gives the one
+** pointer a program needs to find everything else.
+**
+** The file starts with a header that holds the allocator state.
+** Blocks are allocated from the bottom up. Each block header holds
+** its size and the size of the block below so a freed block can be
+** merged with both neighbours. Free blocks are kept on a list for
+** each power of two so allocating takes a bit scan and maybe a split.
+** Memory above the highest block, ph_Top, has never been used.
+** A free block at the top is given back to that space.
+**
+** Permission to use, copy, modify, and/or distribute this
+** software for any purpose with or without fee is hereby granted.
+**
+** THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+** WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+** THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+** CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+** FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+** CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+** OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**
+***************************************************************/
+
+#include "pf_all.h"
+
+#define PH_MAGIC        (0x50345048)   /* 'P4PH' */
+#define PH_VERSION      (1)
+#define PH_ORDER        (0x01020304)   /* Reads differently on the other byte order. */
+#define PH_ALIGN        (16)
+#define PH_NUM_CLASSES  ((int)(sizeof(ucell_t) * 8))
+#define PH_FREE_FLAG    ((ucell_t)1)
+
+/* The header at the start of the file. All offsets are from the
+** start of the file. Offset 0 means none. */
+typedef struct PHeapHeader
+{
+    uint32_t ph_Magic;
+    uint32_t ph_Version;
+    ucell_t  ph_CellSize;  /* sizeof(cell_t) of the program that made it. */
+    ucell_t  ph_Order;
+    ucell_t  ph_Size;      /* Bytes in the file. */
+    ucell_t  ph_Root;      /* Offset set by PHEAP-ROOT! */
+    ucell_t  ph_Top;       /* Nothing has been allocated at or above this. */
+    ucell_t  ph_Last;      /* Highest block below ph_Top. */
+    ucell_t  ph_ClassMap;  /* Bit set for each free list that has blocks. */
+    ucell_t  ph_Free[PH_NUM_CLASSES];  /* First free block of each size. */
+} PHeapHeader;
+
+typedef struct PHeapBlock
+{
+    ucell_t pb_PrevSize;   /* Size of the block just below, or 0. */
+    ucell_t pb_Size;       /* Whole block including header, plus flag. */
+/* The rest is only valid in a free block. */
+    ucell_t pb_Next;
+    ucell_t pb_Prev;
+} PHeapBlock;
+
+#define PH_HEADER_SIZE  (2 * sizeof(ucell_t))
+#define PH_MIN_BLOCK    ((sizeof(PHeapBlock) + PH_ALIGN - 1) & ~(ucell_t)(PH_ALIGN - 1))
+#define PH_FIRST_BLOCK  ((sizeof(PHeapHeader) + PH_ALIGN - 1) & ~(ucell_t)(PH_ALIGN - 1))
+
+#ifdef PF_SUPPORT_THREADS
+    #define LOCK_PHEAP    sdLock( PF_LOCK_HEAP )
+    #define UNLOCK_PHEAP  sdUnlock( PF_LOCK_HEAP )
+#else
+    #define LOCK_PHEAP    /* noop */
+    #define UNLOCK_PHEAP  /* noop */
+#endif
+
+static char   *gPHeapBase;   /* NULL if no persistent heap is open. */
+static ucell_t gPHeapMapSize;
+
+#define PH_HEADER      ((PHeapHeader *) gPHeapBase)
+#define PB(off)        ((PHeapBlock *) (gPHeapBase + (off)))
+#define pbSize(pb)     ((pb)->pb_Size & ~PH_FREE_FLAG)
+#define pbIsFree(pb)   (((pb)->pb_Size & PH_FREE_FLAG) != 0)
+
+static void phRemoveFree( ucell_t Off )
+{
+    PHeapHeader *ph = PH_HEADER;
+    PHeapBlock *pb = PB(Off);
+    int Class = memHighBit( pbSize(pb) );
+
+    if( pb->pb_Prev != 0 ) PB(pb->pb_Prev)->pb_Next = pb->pb_Next;
+    else
+    {
+        ph->ph_Free[Class] = pb->pb_Next;
+        if( pb->pb_Next == 0 ) ph->ph_ClassMap &= ~(((ucell_t)1) << Class);
+    }
+    if( pb->pb_Next != 0 ) PB(pb->pb_Next)->pb_Prev = pb->pb_Prev;
+    pb->pb_Size &= ~PH_FREE_FLAG;
+}
+
+static void phInsertFree( ucell_t Off )
+{
+    PHeapHeader *ph = PH_HEADER;
+    PHeapBlock *pb = PB(Off);
+    int Class = memHighBit( pbSize(pb) );
+
+    pb->pb_Size |= PH_FREE_FLAG;
+    pb->pb_Prev = 0;
+    pb->pb_Next = ph->ph_Free[Class];
+    if( pb->pb_Next != 0 ) PB(pb->pb_Next)->pb_Prev = Off;
+    ph->ph_Free[Class] = Off;
+    ph->ph_ClassMap |= ((ucell_t)1) << Class;
+}
+
+/***************************************************************
+** Check that a block offset looks like an allocated block.
+*/
+static int phValidBlock( ucell_t Off )
+{
+    PHeapBlock *pb;
+    if( (Off < PH_FIRST_BLOCK) || (Off >= PH_HEADER->ph_Top) || ((Off % PH_ALIGN) != 0) ) return 0;
+    pb = PB(Off);
+    return !pbIsFree(pb) && (pb->pb_Size >= PH_MIN_BLOCK) &&
+        (pb->pb_Size <= (PH_HEADER->ph_Top - Off));
+}
+
+int pfPHeapContains( const void *Mem )
+{
+    return (gPHeapBase != NULL) && ((const char *) Mem >= gPHeapBase) &&
+        ((const char *) Mem < (gPHeapBase + gPHeapMapSize));
+}
+
+/***************************************************************
+** Use the first block on the smallest list whose blocks are all
+** big enough, else take more from the top.
+*/
+char *pfPHeapAlloc( cell_t NumBytes )
+{
+    PHeapHeader *ph = PH_HEADER;
+    PHeapBlock *pb;
+    ucell_t Need, Off = 0, Rem, Mask;
+    int Class;
+
+    if( (gPHeapBase == NULL) || (NumBytes < 0) || ((ucell_t) NumBytes >= gPHeapMapSize) ) return NULL;
+    Need = (NumBytes + PH_HEADER_SIZE + PH_ALIGN - 1) & ~(ucell_t)(PH_ALIGN - 1);
+    if( Need < PH_MIN_BLOCK ) Need = PH_MIN_BLOCK;
+    Class = memHighBit( Need );
+    if( Need != (((ucell_t)1) << Class) ) Class++;
+
+    LOCK_PHEAP;
+    Mask = (Class < PH_NUM_CLASSES) ? (ph->ph_ClassMap & (~((ucell_t)0) << Class)) : 0;
+    if( Mask != 0 )
+    {
+        Off = ph->ph_Free[ memLowBit( Mask ) ];
+        phRemoveFree( Off );
+        pb = PB(Off);
+        Rem = pbSize(pb) - Need;
+        if( Rem >= PH_MIN_BLOCK )
+        {
+/* A free block is never the last block so there is one above. */
+            PHeapBlock *RemBlock = PB(Off + Need);
+            pb->pb_Size = Need;
+            RemBlock->pb_PrevSize = Need;
+            RemBlock->pb_Size = Rem;
+            PB(Off + Need + Rem)->pb_PrevSize = Rem;
+            phInsertFree( Off + Need );
+        }
+    }
+    else if( Need <= (ph->ph_Size - ph->ph_Top) )
+    {
+        Off = ph->ph_Top;
+        pb = PB(Off);
+        pb->pb_PrevSize = (ph->ph_Last != 0) ? pbSize( PB(ph->ph_Last) ) : 0;
+        pb->pb_Size = Need;
+        ph->ph_Last = Off;
+        ph->ph_Top += Need;
+    }
+    UNLOCK_PHEAP;
+
+    return (Off != 0) ? (gPHeapBase + Off + PH_HEADER_SIZE) : NULL;
+}
+
+cell_t pfPHeapFree( void *Mem )
+{
+    PHeapHeader *ph = PH_HEADER;
+    PHeapBlock *pb;
+    ucell_t Off, Size, Next, Prev;
+
+    if( !pfPHeapContains( Mem ) ) return -1;
+    Off = (ucell_t) (((char *) Mem) - gPHeapBase) - PH_HEADER_SIZE;
+
+    LOCK_PHEAP;
+    if( !phValidBlock( Off ) )
+    {
+        UNLOCK_PHEAP;
+        return -1;
+    }
+    pb = PB(Off);
+    Size = pbSize(pb);
+
+    Next = Off + Size;
+/* A header that ends up inside a bigger free block, or above the top,
+** is cleared so that freeing it again fails in phValidBlock(). */
+    if( (Next < ph->ph_Top) && pbIsFree( PB(Next) ) )
+    {
+        phRemoveFree( Next );
+        Size += pbSize( PB(Next) );
+        PB(Next)->pb_Size = 0;
+    }
+    if( pb->pb_PrevSize != 0 )
+    {
+        Prev = Off - pb->pb_PrevSize;
+        if( pbIsFree( PB(Prev) ) )
+        {
+            phRemoveFree( Prev );
+            Size += pbSize( PB(Prev) );
+            pb->pb_Size = 0;
+            Off = Prev;
+            pb = PB(Off);
+        }
+    }
+
+    Next = Off + Size;
+    if( Next == ph->ph_Top )
+    {
+/* Give it back to the top. The block below is not free. */
+        ph->ph_Top = Off;
+        ph->ph_Last = (pb->pb_PrevSize != 0) ? (Off - pb->pb_PrevSize) : 0;
+        pb->pb_Size = 0;
+    }
+    else
+    {
+        pb->pb_Size = Size;
+        PB(Next)->pb_PrevSize = Size;
+        phInsertFree( Off );
+    }
+    UNLOCK_PHEAP;
+    return 0;
+}
+
+/***************************************************************
+** Mem must be in the persistent heap.
+*/
+char *pfPHeapResize( void *Mem, cell_t NumBytes )
+{
+    char *NewMem;
+    ucell_t Off = (ucell_t) (((char *) Mem) - gPHeapBase) - PH_HEADER_SIZE;
+    cell_t OldSize;
+
+    if( !phValidBlock( Off ) ) return NULL;
+    OldSize = (cell_t) (pbSize( PB(Off) ) - PH_HEADER_SIZE);
+    NewMem = pfPHeapAlloc( NumBytes );
+    if( NewMem != NULL )
+    {
+        pfCopyMemory( NewMem, Mem, (OldSize < NumBytes) ? OldSize : NumBytes );
+        pfPHeapFree( Mem );
+    }
+    return NewMem;
+}
+
+cell_t pfPHeapToRel( const void *Mem )
+{
+    if( (Mem == NULL) || (gPHeapBase == NULL) ) return 0;
+    return (cell_t) (((const char *) Mem) - gPHeapBase);
+}
+
+char *pfPHeapToAbs( cell_t Offset )
+{
+    if( (Offset == 0) || (gPHeapBase == NULL) ) return NULL;
+    return gPHeapBase + Offset;
+}
+
+cell_t pfPHeapGetRoot( void )
+{
+    return (gPHeapBase == NULL) ? 0 : (cell_t) pfPHeapToAbs( (cell_t) PH_HEADER->ph_Root );
+}
+
+void pfPHeapSetRoot( cell_t Mem )
+{
+    if( gPHeapBase != NULL ) PH_HEADER->ph_Root = (ucell_t) pfPHeapToRel( (void *) Mem );
+}
+
+cell_t pfPHeapSync( void )
+{
+    if( gPHeapBase == NULL ) return -1;
+    return sdSyncMapped( gPHeapBase, (cell_t) gPHeapMapSize ) ? -1 : 0;
+}
+
+cell_t pfPHeapClose( void )
+{
+    cell_t Result;
+    if( gPHeapBase == NULL ) return -1;
+    Result = pfPHeapSync();
+    if( sdUnmapFile( gPHeapBase, (cell_t) gPHeapMapSize ) ) Result = -1;
+    gPHeapBase = NULL;
+    gPHeapMapSize = 0;
+    return Result;
+}
+
+/***************************************************************
+** Open a persistent heap file, or make a new one, of at least
+** MinSize bytes. An existing file is made bigger if needed.
+** Closes any persistent heap that is already open.
+** Returns -2 if the file is not a persistent heap for this program.
+*/
+cell_t pfPHeapOpen( const char *FileName, cell_t MinSize )
+{
+#ifdef PF_NO_FILEIO
+    TOUCH(FileName);
+    TOUCH(MinSize);
+    return -1;
+#else
+    PHeapHeader Header, *ph;
+    FileStream *File;
+    cell_t Len;
+    char *Base;
+    int IsNew;
+
+    if( gPHeapBase != NULL ) pfPHeapClose();
+    if( MinSize < (cell_t) (PH_FIRST_BLOCK + PH_MIN_BLOCK) ) MinSize = PH_FIRST_BLOCK + PH_MIN_BLOCK;
+    MinSize = (MinSize + PH_ALIGN - 1) & ~(PH_ALIGN - 1);
+
+    File = sdOpenFile( FileName, "r+b" );
+    if( File == NULL ) File = sdOpenFile( FileName, "w+b" );
+    if( File == NULL ) return -1;
+
+/* Check an old file before changing it. */
+    IsNew = (sdReadFile( &Header, 1, sizeof(Header), File ) == 0);
+    if( !IsNew && ((Header.ph_Magic != PH_MAGIC) || (Header.ph_Version != PH_VERSION) ||
+        (Header.ph_CellSize != sizeof(cell_t)) || (Header.ph_Order != PH_ORDER)) )
+    {
+        sdCloseFile( File );
+        return -2;
+    }
+    if( IsNew || ((ucell_t) MinSize > Header.ph_Size) )
+    {
+        if( sdResizeFile( File, (uint64_t) (IsNew ? MinSize : MAX( MinSize, (cell_t) Header.ph_Size )) ) != 0 )
+        {
+            sdCloseFile( File );
+            return -1;
+        }
+    }
+    sdCloseFile( File );
+
+    Base = (char *) sdMapFile( FileName, 1, &Len );
+    if( Base == NULL ) return -1;
+    ph = (PHeapHeader *) Base;
+    if( IsNew )
+    {
+        pfSetMemory( ph, 0, sizeof(PHeapHeader) );
+        ph->ph_Magic = PH_MAGIC;
+        ph->ph_Version = PH_VERSION;
+        ph->ph_CellSize = sizeof(cell_t);
+        ph->ph_Order = PH_ORDER;
+        ph->ph_Top = PH_FIRST_BLOCK;
+    }
+    else if( (ph->ph_Top > (ucell_t) Len) || (ph->ph_Top < PH_FIRST_BLOCK) )
+    {
+        sdUnmapFile( Base, Len );
+        return -2;
+    }
+    ph->ph_Size = (ucell_t) Len;
+    gPHeapBase = Base;
+    gPHeapMapSize = (ucell_t) Len;
+    return 0;
+#endif
+}
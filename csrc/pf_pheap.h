@@ -0,0 +1,49 @@
+/* @(#) pf_pheap.h 2026-10-19 */
+#ifndef _pf_pheap_h
+#define _pf_pheap_h
+
+/***************************************************************
+** Include file for the PForth persistent heap.
+**
+** Permission to use, copy, modify, and/or distribute this
+** software for any purpose with or without fee is hereby granted.
+**
+** THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+** WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+** THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+** CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+** FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+** CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+** OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**
+***************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* These return 0 if OK. */
+cell_t pfPHeapOpen( const char *FileName, cell_t MinSize );
+cell_t pfPHeapClose( void );
+cell_t pfPHeapSync( void );
+
+/* True if Mem is inside the persistent heap. */
+int    pfPHeapContains( const void *Mem );
+/* Return NULL if there is no room or no persistent heap. */
+char  *pfPHeapAlloc( cell_t NumBytes );
+char  *pfPHeapResize( void *Mem, cell_t NumBytes );
+/* Returns 0, or -1 if Mem was not allocated from the persistent heap. */
+cell_t pfPHeapFree( void *Mem );
+
+/* Offsets from the start of the file. Address 0 is offset 0. */
+cell_t pfPHeapToRel( const void *Mem );
+char  *pfPHeapToAbs( cell_t Offset );
+cell_t pfPHeapGetRoot( void );
+void   pfPHeapSetRoot( cell_t Mem );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _pf_pheap_h */
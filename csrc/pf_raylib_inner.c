@@ -1,38 +1,231 @@
-#include <stdio.h>
-#include "pf_clib.h"
-#include "pf_guts.h"
+/* @(#) pf_raylib_inner.c 2026-10-19 */
+/***************************************************************
+** Helpers for the raylib words in pfCatch().
+** The words themselves are generated, see "mkraylib.c".
+**
+** Permission to use, copy, modify, and/or distribute this
+** software for any purpose with or without fee is hereby granted.
+**
+** THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+** WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+** WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL
+** THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+** CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING
+** FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+** CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+** OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+**
+***************************************************************/
+
+#include "pf_all.h"
 #include "pf_raylib.h"
-#include "pforth.h"
-#include "raylib.h"
-
-
-#define STKPTR     (DataStackPtr)
-#define M_POP      (*(STKPTR++))
-#define M_PUSH(n)  {*(--(STKPTR)) = (cell_t) (n);}
-#define M_STACK(n) (STKPTR[n])
-
-#define TOS      (*TopOfStack)
-#define M_DROP   { TOS = M_POP; }
-
-
-// Raylib Primitive implementation of the Raylib words.
-ThrowCode pfRaylibCatch( ExecToken XT, cell_t *TopOfStack, cell_t *DataStackPtr, cell_t *ReturnStackPtr ) {
-  char *CharPtr = NULL;
-
-
-  switch (XT) {
-    case ID_TEST_WORD: {
-      printf("\nINFO: Test word\n");
-      M_PUSH(42);
-      M_PUSH(23);
-      // M_PUSH(16);
-      // M_PUSH(15);
-      // M_PUSH(8);
-      // M_PUSH(4);
-      TOS = -19; 
-    } break;
-    default:
-      return THROW_UNDEFINED_WORD;
-  }
-  return 0;
+
+/* Buffers for strings passed to raylib. They grow to fit the
+** longest string. Like raylib, these are only used by one thread.
+*/
+#define PF_RAYLIB_STRING_ROUND  (256)
+
+static char  *gRaylibStrings[PF_RAYLIB_MAX_STRINGS];
+static cell_t gRaylibStringSizes[PF_RAYLIB_MAX_STRINGS];
+
+/***************************************************************
+** Copy a Forth string to a NUL terminated string for raylib.
+** Strings from Z" and >ZSTRING already have one and are not copied.
+** If there is no memory for a longer buffer the string is cut short.
+*/
+const char *pfRaylibCString( cell_t Addr, cell_t Len, int Index )
+{
+    if( Addr == 0 ) return NULL;
+    if( Len < 0 ) Len = 0;
+    if( pfIsZString( Addr, Len ) ) return (const char *) Addr;
+
+    if( Len >= gRaylibStringSizes[Index] )
+    {
+        cell_t NewSize = (Len + PF_RAYLIB_STRING_ROUND) & ~((cell_t) PF_RAYLIB_STRING_ROUND - 1);
+        char *NewString = (char *) pfAllocMem( NewSize );
+        if( NewString != NULL )
+        {
+            if( gRaylibStrings[Index] != NULL ) pfFreeMem( gRaylibStrings[Index] );
+            gRaylibStrings[Index] = NewString;
+            gRaylibStringSizes[Index] = NewSize;
+        }
+        else if( gRaylibStrings[Index] == NULL )
+        {
+            return "";
+        }
+        else
+        {
+            Len = gRaylibStringSizes[Index] - 1;
+        }
+    }
+    pfCopyMemory( gRaylibStrings[Index], (const void *) Addr, (ucell_t) Len );
+    gRaylibStrings[Index][Len] = '\0';
+    return gRaylibStrings[Index];
+}
+
+/***************************************************************
+** Handle tables for raylib resources.
+** Each type has its own table of slabs. A slab holds the slot
+** headers followed by the resources, so they are next to each other.
+*/
+#define PF_RAYLIB_MAX_SLOTS   ((cell_t) 1 << PF_RAYLIB_INDEX_BITS)
+#define PF_RAYLIB_GEN_MASK    (((ucell_t) -1) >> PF_RAYLIB_GEN_SHIFT)
+#define PF_RAYLIB_LIVE        (-2)   /* NextFree of a slot in use. */
+
+typedef struct RaylibSlot
+{
+    ucell_t  rs_Generation;
+    cell_t   rs_NextFree;    /* Next free slot, -1 at the end, or PF_RAYLIB_LIVE. */
+} RaylibSlot;
+
+typedef struct RaylibTable
+{
+    char   **rt_Slabs;
+    cell_t   rt_NumSlabs;
+    cell_t   rt_ItemSize;
+    cell_t   rt_FreeHead;    /* First free slot or -1. */
+} RaylibTable;
+
+/* One more than needed so it is not empty if raylib.h has no resources. */
+static RaylibTable gRaylibTables[PF_RAYLIB_NUM_TYPES + 1];
+
+#define SLOT_OF(table,index) \
+    (&((RaylibSlot *) (table)->rt_Slabs[(index) / PF_RAYLIB_SLAB_SIZE])[(index) % PF_RAYLIB_SLAB_SIZE])
+#define DATA_OF(table,index) \
+    ((table)->rt_Slabs[(index) / PF_RAYLIB_SLAB_SIZE] + (PF_RAYLIB_SLAB_SIZE * sizeof(RaylibSlot)) \
+    + ((index) % PF_RAYLIB_SLAB_SIZE) * (table)->rt_ItemSize)
+
+/***************************************************************
+** Add a slab of free slots to a table. Returns -1 if out of memory.
+*/
+static int pfRaylibAddSlab( RaylibTable *Table )
+{
+    char **NewSlabs;
+    char *Slab;
+    cell_t First, i;
+
+    First = Table->rt_NumSlabs * PF_RAYLIB_SLAB_SIZE;
+    if( First >= PF_RAYLIB_MAX_SLOTS ) return -1;
+
+    Slab = (char *) pfAllocMem( PF_RAYLIB_SLAB_SIZE * (sizeof(RaylibSlot) + Table->rt_ItemSize) );
+    if( Slab == NULL ) return -1;
+    NewSlabs = (char **) pfAllocMem( (Table->rt_NumSlabs + 1) * sizeof(char *) );
+    if( NewSlabs == NULL )
+    {
+        pfFreeMem( Slab );
+        return -1;
+    }
+    if( Table->rt_Slabs != NULL )
+    {
+        pfCopyMemory( NewSlabs, Table->rt_Slabs, Table->rt_NumSlabs * sizeof(char *) );
+        pfFreeMem( Table->rt_Slabs );
+    }
+    NewSlabs[Table->rt_NumSlabs++] = Slab;
+    Table->rt_Slabs = NewSlabs;
+
+    for( i = 0; i < PF_RAYLIB_SLAB_SIZE; i++ )
+    {
+        RaylibSlot *Slot = SLOT_OF( Table, First + i );
+        Slot->rs_Generation = 1;
+        Slot->rs_NextFree = (i < PF_RAYLIB_SLAB_SIZE - 1) ? First + i + 1 : Table->rt_FreeHead;
+    }
+    Table->rt_FreeHead = First;
+    return 0;
+}
+
+/***************************************************************/
+void *pfRaylibNewHandle( int Type, cell_t Size, cell_t *HandlePtr )
+{
+    RaylibTable *Table = &gRaylibTables[Type];
+    RaylibSlot *Slot;
+    cell_t Index;
+
+    if( Table->rt_NumSlabs == 0 )
+    {
+        Table->rt_ItemSize = (Size + sizeof(cell_t) - 1) & ~((cell_t) sizeof(cell_t) - 1);
+        Table->rt_FreeHead = -1;
+    }
+    if( (Table->rt_FreeHead < 0) && (pfRaylibAddSlab( Table ) < 0) ) return NULL;
+
+    Index = Table->rt_FreeHead;
+    Slot = SLOT_OF( Table, Index );
+    Table->rt_FreeHead = Slot->rs_NextFree;
+    Slot->rs_NextFree = PF_RAYLIB_LIVE;
+
+    *HandlePtr = (cell_t) ((Slot->rs_Generation << PF_RAYLIB_GEN_SHIFT)
+        | ((ucell_t) Type << PF_RAYLIB_INDEX_BITS) | (ucell_t) Index);
+    return DATA_OF( Table, Index );
+}
+
+/***************************************************************
+** Find the slot of a handle. Returns NULL if it is not in use
+** or is from an earlier use of the slot.
+*/
+static RaylibSlot *pfRaylibFindSlot( cell_t Handle, int Type, RaylibTable **TablePtr, cell_t *IndexPtr )
+{
+    ucell_t Bits = (ucell_t) Handle;
+    int HandleType = (int) ((Bits >> PF_RAYLIB_INDEX_BITS) & ((1 << PF_RAYLIB_TYPE_BITS) - 1));
+    cell_t Index = (cell_t) (Bits & (PF_RAYLIB_MAX_SLOTS - 1));
+    RaylibTable *Table;
+    RaylibSlot *Slot;
+
+    if( (Type >= 0) && (HandleType != Type) ) return NULL;
+    if( HandleType >= PF_RAYLIB_NUM_TYPES ) return NULL;
+    Table = &gRaylibTables[HandleType];
+    if( Index >= Table->rt_NumSlabs * PF_RAYLIB_SLAB_SIZE ) return NULL;
+    Slot = SLOT_OF( Table, Index );
+    if( (Slot->rs_NextFree != PF_RAYLIB_LIVE) || (Slot->rs_Generation != (Bits >> PF_RAYLIB_GEN_SHIFT)) )
+    {
+        return NULL;
+    }
+    *TablePtr = Table;
+    *IndexPtr = Index;
+    return Slot;
+}
+
+/***************************************************************/
+void *pfRaylibHandleData( cell_t Handle, int Type )
+{
+    RaylibTable *Table;
+    cell_t Index;
+    if( pfRaylibFindSlot( Handle, Type, &Table, &Index ) == NULL ) return NULL;
+    return DATA_OF( Table, Index );
+}
+
+/***************************************************************
+** Put the slot back on the free list with a new generation,
+** so old copies of the handle are no longer valid.
+*/
+void pfRaylibFreeHandle( cell_t Handle )
+{
+    RaylibTable *Table;
+    cell_t Index;
+    RaylibSlot *Slot = pfRaylibFindSlot( Handle, -1, &Table, &Index );
+    if( Slot == NULL ) return;
+    Slot->rs_Generation = (Slot->rs_Generation + 1) & PF_RAYLIB_GEN_MASK;
+    if( Slot->rs_Generation == 0 ) Slot->rs_Generation = 1;
+    Slot->rs_NextFree = Table->rt_FreeHead;
+    Table->rt_FreeHead = Index;
+}
+
+/***************************************************************
+** Free the string buffers and the handle tables.
+** Resources that were not unloaded are lost.
+*/
+void pfRaylibTerm( void )
+{
+    int i;
+    cell_t j;
+    for( i = 0; i < PF_RAYLIB_MAX_STRINGS; i++ )
+    {
+        FREE_VAR( gRaylibStrings[i] );
+        gRaylibStringSizes[i] = 0;
+    }
+    for( i = 0; i < PF_RAYLIB_NUM_TYPES; i++ )
+    {
+        RaylibTable *Table = &gRaylibTables[i];
+        for( j = 0; j < Table->rt_NumSlabs; j++ ) pfFreeMem( Table->rt_Slabs[j] );
+        FREE_VAR( Table->rt_Slabs );
+        Table->rt_NumSlabs = 0;
+    }
 }
@@ -65,6 +65,21 @@ Chunks
     'P4CD'
     size
     Code portion of dictionary. (Big or Little Endian)
+
+A delta dictionary saved by SAVE-DELTA has P4BS, P4NP and P4CP in place of P4NM and P4CD.
+    'P4BS'
+    size
+    64 bit hash of the whole base file, then its name with a NUL.
+
+    'P4NP' and 'P4CP'
+    size
+    Patches to the names and code of the base.
+    Each is an offset, a byte count, then the bytes padded to a multiple of 4.
+
+If DIC-COMPRESS is set then P4NZ and P4CZ are saved in place of P4NM and P4CD.
+    'P4NZ' and 'P4CZ'
+    size
+    32 bit size before compression, 32 bit size after, then the LZ stream.
 */
 
 
@@ -300,6 +315,257 @@ int IsHostLittleEndian( void )
     return (int) (*bp); /* Return byte pointed to by address. If LSB then == 1 */
 }
 
+#ifndef PF_NO_FILEIO
+
+#define PF_HASH_START      (0xcbf29ce484222325ULL)   /* 64 bit FNV-1a */
+#define PF_HASH_PRIME      (0x100000001b3ULL)
+
+/***************************************************************/
+static uint64_t HashBytes( uint64_t Hash, const uint8_t *Data, ucell_t NumBytes )
+{
+    while( NumBytes-- > 0 )
+    {
+        Hash ^= *Data++;
+        Hash *= PF_HASH_PRIME;
+    }
+    return Hash;
+}
+
+/***************************************************************
+** LZ compression for dictionary chunks.
+** The stream is a series of sequences, like LZ4. Each starts with a
+** token byte holding a literal count in the high 4 bits and a match
+** length minus 4 in the low 4 bits. A count of 15 is continued in the
+** following bytes, adding each until one is less than 255. Then come
+** the literal bytes, a 16 bit little endian offset back into the
+** output, and more match length bytes if needed.
+** The last sequence only has literals.
+*/
+#define PF_LZ_MIN_MATCH   (4)
+#define PF_LZ_MAX_OFFSET  (65535)
+#define PF_LZ_HASH_BITS   (12)
+#define PF_LZ_BOUND(n)    ((n) + ((n)/255) + 16)   /* Worst case compressed size. */
+
+static uint32_t LzHash( const uint8_t *p )
+{
+    uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    return (v * 2654435761U) >> (32 - PF_LZ_HASH_BITS);
+}
+
+static uint8_t *LzPutCount( uint8_t *op, uint32_t Count )
+{
+    while( Count >= 255 )
+    {
+        *op++ = 255;
+        Count -= 255;
+    }
+    *op++ = (uint8_t) Count;
+    return op;
+}
+
+static uint8_t *LzPutSequence( uint8_t *op, const uint8_t *Literals, uint32_t NumLiterals,
+                               uint32_t Offset, uint32_t MatchLen )
+{
+    uint32_t Extra = (MatchLen > 0) ? (MatchLen - PF_LZ_MIN_MATCH) : 0;
+    *op++ = (uint8_t) ((MIN( NumLiterals, 15 ) << 4) | MIN( Extra, 15 ));
+    if( NumLiterals >= 15 ) op = LzPutCount( op, NumLiterals - 15 );
+    pfCopyMemory( op, Literals, NumLiterals );
+    op += NumLiterals;
+    if( MatchLen > 0 )
+    {
+        *op++ = (uint8_t) Offset;
+        *op++ = (uint8_t) (Offset >> 8);
+        if( Extra >= 15 ) op = LzPutCount( op, Extra - 15 );
+    }
+    return op;
+}
+
+/* Compress into Dst, which must hold PF_LZ_BOUND(SrcSize) bytes. Returns compressed size. */
+static uint32_t LzCompress( const uint8_t *Src, uint32_t SrcSize, uint8_t *Dst )
+{
+    uint32_t Table[1 << PF_LZ_HASH_BITS];  /* Position + 1 of last match candidate, 0 if none */
+    uint32_t ip = 0;
+    uint32_t Anchor = 0;
+    uint8_t *op = Dst;
+
+    pfSetMemory( Table, 0, sizeof(Table) );
+    while( (ip + PF_LZ_MIN_MATCH) <= SrcSize )
+    {
+        uint32_t h = LzHash( &Src[ip] );
+        uint32_t Ref = Table[h];
+        Table[h] = ip + 1;
+        if( (Ref > 0) && ((ip - (Ref - 1)) <= PF_LZ_MAX_OFFSET) &&
+            (memcmp( &Src[Ref - 1], &Src[ip], PF_LZ_MIN_MATCH ) == 0) )
+        {
+            uint32_t MatchLen = PF_LZ_MIN_MATCH;
+            Ref -= 1;
+            while( ((ip + MatchLen) < SrcSize) && (Src[Ref + MatchLen] == Src[ip + MatchLen]) ) MatchLen++;
+            op = LzPutSequence( op, &Src[Anchor], ip - Anchor, ip - Ref, MatchLen );
+            ip += MatchLen;
+            Anchor = ip;
+        }
+        else
+        {
+            ip++;
+        }
+    }
+    op = LzPutSequence( op, &Src[Anchor], SrcSize - Anchor, 0, 0 );
+    return (uint32_t) (op - Dst);
+}
+
+/* Decompress into Dst. Returns the number of bytes written or -1 if the stream is bad. */
+static cell_t LzDecompress( const uint8_t *Src, uint32_t SrcSize, uint8_t *Dst, uint32_t DstSize )
+{
+    const uint8_t *ip = Src;
+    const uint8_t *End = Src + SrcSize;
+    uint32_t op = 0;
+
+    for(;;)
+    {
+        uint32_t Token, Count, Offset;
+        uint8_t b;
+
+        if( ip >= End ) return -1;
+        Token = *ip++;
+        Count = Token >> 4;
+        if( Count == 15 )
+        {
+            do {
+                if( ip >= End ) return -1;
+                b = *ip++;
+                Count += b;
+            } while( b == 255 );
+        }
+        if( (Count > (uint32_t)(End - ip)) || (Count > (DstSize - op)) ) return -1;
+        pfCopyMemory( &Dst[op], ip, Count );
+        ip += Count;
+        op += Count;
+        if( ip == End ) break;  /* Last sequence has no match. */
+
+        if( (End - ip) < 2 ) return -1;
+        Offset = (uint32_t)ip[0] | ((uint32_t)ip[1] << 8);
+        ip += 2;
+        if( (Offset == 0) || (Offset > op) ) return -1;
+        Count = Token & 15;
+        if( Count == 15 )
+        {
+            do {
+                if( ip >= End ) return -1;
+                b = *ip++;
+                Count += b;
+            } while( b == 255 );
+        }
+        Count += PF_LZ_MIN_MATCH;
+        if( Count > (DstSize - op) ) return -1;
+        while( Count-- > 0 )  /* Byte by byte because the match may overlap. */
+        {
+            Dst[op] = Dst[op - Offset];
+            op++;
+        }
+    }
+    return (cell_t) op;
+}
+
+/***************************************************************
+** Read a whole dictionary file so that a delta can be checked against it.
+** Returns NULL if the file cannot be read. Free with pfFreeMem().
+*/
+static uint8_t *ReadBaseFile( const char *FileName, uint32_t *SizePtr )
+{
+    FileStream *fid;
+    file_offset_t Size;
+    uint8_t *Data = NULL;
+
+    fid = sdOpenFile( FileName, "rb" );
+    if( fid == NULL ) return NULL;
+    if( sdSeekFile( fid, 0, PF_SEEK_END ) != 0 ) goto done;
+    Size = sdTellFile( fid );
+    if( (Size < 12) || (Size > (file_offset_t) 0x7FFFFFFF) ) goto done;
+    if( sdSeekFile( fid, 0, PF_SEEK_SET ) != 0 ) goto done;
+
+    Data = (uint8_t *) pfAllocMem( (cell_t) Size );
+    if( Data == NULL ) goto done;
+    if( sdReadFile( Data, 1, (cell_t) Size, fid ) != (cell_t) Size )
+    {
+        pfFreeMem( Data );
+        Data = NULL;
+        goto done;
+    }
+    *SizePtr = (uint32_t) Size;
+done:
+    sdCloseFile( fid );
+    return Data;
+}
+
+/***************************************************************
+** Find a chunk in a dictionary file that is in memory.
+** Returns 0 if found, 1 if missing, or -1 if the file is not a full dictionary.
+*/
+static int FindBaseChunk( const uint8_t *Data, uint32_t Size, uint32_t ID,
+                          const uint8_t **ChunkPtr, uint32_t *ChunkSizePtr )
+{
+    uint32_t Offset = 12;
+    uint32_t ChunkSize;
+    int Result = 1;
+
+    if( (Read32BigEndian( Data ) != ID_FORM) ||
+        (Read32BigEndian( Data + 8 ) != ID_P4TH) ) return -1;
+    while( (Offset + 8) <= Size )
+    {
+        uint32_t ChunkID = Read32BigEndian( Data + Offset );
+        ChunkSize = Read32BigEndian( Data + Offset + 4 );
+        Offset += 8;
+        if( ChunkSize > (Size - Offset) ) return -1;
+        if( ChunkID == ID_P4BS ) return -1;  /* A delta cannot be a base. */
+        if( ChunkID == ID )
+        {
+            *ChunkPtr = Data + Offset;
+            *ChunkSizePtr = ChunkSize;
+            Result = 0;
+        }
+        Offset += ChunkSize;
+    }
+    return Result;
+}
+
+/***************************************************************
+** Find the names or code in a dictionary file that is in memory,
+** decompressing them if needed. *UnpackedPtr is set to memory that
+** the caller must free with pfFreeMem(), or NULL.
+*/
+static int FindBaseSegment( const uint8_t *Data, uint32_t Size, uint32_t RawID, uint32_t PackedID,
+                            const uint8_t **SegmentPtr, uint32_t *SegmentSizePtr, uint8_t **UnpackedPtr )
+{
+    const uint8_t *Chunk;
+    uint32_t ChunkSize, RawSize, PackedSize;
+    uint8_t *Unpacked;
+    int Result;
+
+    *UnpackedPtr = NULL;
+    Result = FindBaseChunk( Data, Size, RawID, SegmentPtr, SegmentSizePtr );
+    if( Result != 1 ) return Result;
+    Result = FindBaseChunk( Data, Size, PackedID, &Chunk, &ChunkSize );
+    if( Result != 0 ) return Result;
+
+    if( ChunkSize < 8 ) return -1;
+    RawSize = Read32BigEndian( Chunk );
+    PackedSize = Read32BigEndian( Chunk + 4 );
+    if( PackedSize > (ChunkSize - 8) ) return -1;
+    Unpacked = (uint8_t *) pfAllocMem( RawSize + 1 );
+    if( Unpacked == NULL ) return -1;
+    if( LzDecompress( Chunk + 8, PackedSize, Unpacked, RawSize ) != (cell_t) RawSize )
+    {
+        pfFreeMem( Unpacked );
+        return -1;
+    }
+    *UnpackedPtr = Unpacked;
+    *SegmentPtr = Unpacked;
+    *SegmentSizePtr = RawSize;
+    return 0;
+}
+
+#endif /* !PF_NO_FILEIO */
+
 #if defined(PF_NO_FILEIO) || defined(PF_NO_SHELL)
 
 cell_t ffSaveForth( const char *FileName, ExecToken EntryPoint, cell_t NameSize, cell_t CodeSize)
@@ -313,6 +579,18 @@ cell_t ffSaveForth( const char *FileName, ExecToken EntryPoint, cell_t NameSize,
     return -1;
 }
 
+cell_t ffSaveDelta( const char *BaseName, const char *FileName, ExecToken EntryPoint, cell_t NameSize, cell_t CodeSize)
+{
+    TOUCH(BaseName);
+    TOUCH(FileName);
+    TOUCH(EntryPoint);
+    TOUCH(NameSize);
+    TOUCH(CodeSize);
+
+    pfReportError("ffSaveDelta", PF_ERR_NOT_SUPPORTED);
+    return -1;
+}
+
 #else /* PF_NO_FILEIO or PF_NO_SHELL */
 
 /***************************************************************/
@@ -348,6 +626,28 @@ error:
     return -1;
 }
 
+/***************************************************************/
+static cell_t WriteCompressedChunkToFile( FileStream *fid, cell_t ID, const uint8_t *Data, uint32_t NumBytes )
+{
+    uint8_t *Packed;
+    uint32_t PackedSize;
+    cell_t Result;
+
+    Packed = (uint8_t *) pfAllocMem( 8 + PF_LZ_BOUND(NumBytes) + 1 );
+    if( Packed == NULL )
+    {
+        pfReportError("WriteCompressedChunkToFile", PF_ERR_NO_MEM);
+        return -1;
+    }
+    PackedSize = LzCompress( Data, NumBytes, Packed + 8 );
+    Write32BigEndian( Packed, NumBytes );
+    Write32BigEndian( Packed + 4, PackedSize );
+    Packed[8 + PackedSize] = 0;  /* Pad for EVENUP */
+    Result = WriteChunkToFile( fid, ID, (char *) Packed, (int32_t) (8 + PackedSize) );
+    pfFreeMem( Packed );
+    return Result;
+}
+
 /* Convert dictionary info chunk between native and on-disk (big-endian). */
 static void
 convertDictionaryInfoWrite (DictionaryInfoChunk *sd)
@@ -375,12 +675,71 @@ convertDictionaryInfoRead (DictionaryInfoChunk *sd)
     }
 }
 
+/****************************************************************
+** Write the parts of the dictionary that differ from the base as
+** a list of patches. Each patch is a 32 bit offset, a 32 bit length,
+** then the bytes padded to a multiple of 4.
+** Patches cover whole cells so that a cell holding an address is
+** always written in one piece.
+*/
+#define PF_DELTA_GAP   (16)  /* Join patches separated by fewer equal bytes. */
+
+static cell_t WritePatchChunk( FileStream *fid, cell_t ID, uint8_t *Current, uint32_t CurrentSize,
+                               const uint8_t *Base, uint32_t BaseSize )
+{
+    static uint8_t Zeros[4] = { 0, 0, 0, 0 };
+    file_offset_t ChunkStart;
+    uint32_t ChunkSize;
+    uint32_t Start, End, i;
+
+    assert(ID <= UINT32_MAX);
+    if( Write32ToFile( fid, (uint32_t)ID ) < 0 ) goto error;
+    ChunkStart = sdTellFile( fid );
+    if( Write32ToFile( fid, 0 ) < 0 ) goto error;
+
+    i = 0;
+    while( i < CurrentSize )
+    {
+        if( (i < BaseSize) && (Current[i] == Base[i]) )
+        {
+            i++;
+            continue;
+        }
+/* Extend the patch until a long enough run of unchanged bytes. */
+        Start = i & ~(uint32_t)(sizeof(cell_t) - 1);
+        End = i + 1;
+        for( i = End; (i < CurrentSize) && ((i - End) < PF_DELTA_GAP); i++ )
+        {
+            if( (i >= BaseSize) || (Current[i] != Base[i]) ) End = i + 1;
+        }
+        End = (End + sizeof(cell_t) - 1) & ~(uint32_t)(sizeof(cell_t) - 1);
+        if( End > CurrentSize ) End = CurrentSize;
+        if( Write32ToFile( fid, Start ) < 0 ) goto error;
+        if( Write32ToFile( fid, End - Start ) < 0 ) goto error;
+        if( sdWriteFile( Current + Start, 1, End - Start, fid ) != (cell_t)(End - Start) ) goto error;
+        if( sdWriteFile( Zeros, 1, QUADUP(End - Start) - (End - Start), fid ) !=
+            (cell_t)(QUADUP(End - Start) - (End - Start)) ) goto error;
+        i = End;
+    }
+
+    ChunkSize = (uint32_t) (sdTellFile( fid ) - ChunkStart - 4);
+    if( sdSeekFile( fid, ChunkStart, PF_SEEK_SET ) != 0 ) goto error;
+    if( Write32ToFile( fid, ChunkSize ) < 0 ) goto error;
+    if( sdSeekFile( fid, 0, PF_SEEK_END ) != 0 ) goto error;
+    return 0;
+error:
+    pfReportError("WritePatchChunk", PF_ERR_WRITE_FILE);
+    return -1;
+}
+
 /****************************************************************
 ** Save Dictionary in File.
 ** If EntryPoint is NULL, save as development environment.
 ** If EntryPoint is non-NULL, save as turnKey environment with no names.
+** If BaseName is not NULL then only save what differs from that file.
 */
-cell_t ffSaveForth( const char *FileName, ExecToken EntryPoint, cell_t NameSize, cell_t CodeSize)
+static cell_t SaveDictionary( const char *BaseName, const char *FileName, ExecToken EntryPoint,
+                              cell_t NameSize, cell_t CodeSize)
 {
     FileStream *fid;
     DictionaryInfoChunk SD;
@@ -388,12 +747,43 @@ cell_t ffSaveForth( const char *FileName, ExecToken EntryPoint, cell_t NameSize,
     uint32_t NameChunkSize = 0;
     uint32_t CodeChunkSize;
     uint32_t relativeCodePtr;
+    uint8_t *BaseData = NULL;
+    uint32_t BaseSize = 0;
+    const uint8_t *BaseNames = NULL;
+    const uint8_t *BaseCode = NULL;
+    uint32_t BaseNamesSize = 0;
+    uint32_t BaseCodeSize = 0;
+    uint8_t *UnpackedNames = NULL;
+    uint8_t *UnpackedCode = NULL;
+
+    if( BaseName != NULL )
+    {
+        if( strcmp( BaseName, FileName ) == 0 )
+        {
+            pfReportError("ffSaveDelta", PF_ERR_BASE_CONFLICT);
+            return -1;
+        }
+        BaseData = ReadBaseFile( BaseName, &BaseSize );
+        if( BaseData == NULL )
+        {
+            pfReportError("ffSaveDelta", PF_ERR_READ_FILE);
+            return -1;
+        }
+        if( (FindBaseSegment( BaseData, BaseSize, ID_P4CD, ID_P4CZ,
+                &BaseCode, &BaseCodeSize, &UnpackedCode ) != 0) ||
+            (FindBaseSegment( BaseData, BaseSize, ID_P4NM, ID_P4NZ,
+                &BaseNames, &BaseNamesSize, &UnpackedNames ) < 0) )
+        {
+            pfReportError("ffSaveDelta", PF_ERR_WRONG_FILE);
+            goto base_error;
+        }
+    }
 
     fid = sdOpenFile( FileName, "wb" );
     if( fid == NULL )
     {
         pfReportError("pfSaveDictionary", PF_ERR_OPEN_FILE);
-        return -1;
+        goto base_error;
     }
 
 /* Save in uninitialized form. */
@@ -420,6 +810,7 @@ cell_t ffSaveForth( const char *FileName, ExecToken EntryPoint, cell_t NameSize,
 #endif
 
     SD.sd_CellSize = sizeof(cell_t);
+    SD.sd_RaylibHash = PF_RAYLIB_API_HASH;  /* Must match compiled dictionary. */
 
 /* Set bit that specifies whether dictionary is BIG or LITTLE Endian. */
     {
@@ -480,22 +871,64 @@ cell_t ffSaveForth( const char *FileName, ExecToken EntryPoint, cell_t NameSize,
 
     if( WriteChunkToFile( fid, ID_P4DI, (char *) &SD, sizeof(DictionaryInfoChunk) ) < 0 ) goto error;
 
-/* Write Name Fields if NameSize non-zero ------- */
-    if( NameSize > 0 )
+    if( BaseData != NULL )
     {
-        if( WriteChunkToFile( fid, ID_P4NM, (char *) NAME_BASE,
-            NameChunkSize ) < 0 ) goto error;
+/* Write P4BS Base file hash and name, then only the changes. */
+        uint64_t BaseHash = HashBytes( PF_HASH_START, BaseData, BaseSize );
+        cell_t NameLen = (cell_t) strlen( BaseName ) + 1;
+        uint8_t *Chunk = (uint8_t *) pfAllocMem( 8 + NameLen + 1 );
+        if( Chunk == NULL ) goto error;
+        Write32BigEndian( Chunk, (uint32_t) (BaseHash >> 32) );
+        Write32BigEndian( Chunk + 4, (uint32_t) BaseHash );
+        pfCopyMemory( Chunk + 8, BaseName, NameLen );
+        Chunk[8 + NameLen] = 0;  /* Pad for EVENUP */
+        if( WriteChunkToFile( fid, ID_P4BS, (char *) Chunk, (int32_t)(8 + NameLen) ) < 0 )
+        {
+            pfFreeMem( Chunk );
+            goto error;
+        }
+        pfFreeMem( Chunk );
+
+        if( NameSize > 0 )
+        {
+            if( WritePatchChunk( fid, ID_P4NP, (uint8_t *) NAME_BASE, NameChunkSize,
+                BaseNames, BaseNamesSize ) < 0 ) goto error;
+        }
+        if( WritePatchChunk( fid, ID_P4CP, (uint8_t *) CODE_BASE, CodeChunkSize,
+            BaseCode, BaseCodeSize ) < 0 ) goto error;
+    }
+    else if( gVarDicCompress )
+    {
+        if( NameSize > 0 )
+        {
+            if( WriteCompressedChunkToFile( fid, ID_P4NZ, (const uint8_t *) NAME_BASE,
+                NameChunkSize ) < 0 ) goto error;
+        }
+        if( WriteCompressedChunkToFile( fid, ID_P4CZ, (const uint8_t *) CODE_BASE,
+            CodeChunkSize ) < 0 ) goto error;
     }
+    else
+    {
+/* Write Name Fields if NameSize non-zero ------- */
+        if( NameSize > 0 )
+        {
+            if( WriteChunkToFile( fid, ID_P4NM, (char *) NAME_BASE,
+                NameChunkSize ) < 0 ) goto error;
+        }
 
 /* Write Code Fields ---------------------------- */
-    if( WriteChunkToFile( fid, ID_P4CD, (char *) CODE_BASE,
-        CodeChunkSize ) < 0 ) goto error;
+        if( WriteChunkToFile( fid, ID_P4CD, (char *) CODE_BASE,
+            CodeChunkSize ) < 0 ) goto error;
+    }
 
     FormSize = (uint32_t) sdTellFile( fid ) - 8;
     sdSeekFile( fid, 4, PF_SEEK_SET );
     if( Write32ToFile( fid, FormSize ) < 0 ) goto error;
 
     sdCloseFile( fid );
+    if( BaseData != NULL ) pfFreeMem( BaseData );
+    if( UnpackedNames != NULL ) pfFreeMem( UnpackedNames );
+    if( UnpackedCode != NULL ) pfFreeMem( UnpackedCode );
 
 /* Restore initialization. */
     pfExecIfDefined("AUTO.INIT");
@@ -509,9 +942,27 @@ error:
 /* Restore initialization. */
     pfExecIfDefined("AUTO.INIT");
 
+base_error:
+    if( BaseData != NULL ) pfFreeMem( BaseData );
+    if( UnpackedNames != NULL ) pfFreeMem( UnpackedNames );
+    if( UnpackedCode != NULL ) pfFreeMem( UnpackedCode );
     return -1;
 }
 
+cell_t ffSaveForth( const char *FileName, ExecToken EntryPoint, cell_t NameSize, cell_t CodeSize)
+{
+    return SaveDictionary( NULL, FileName, EntryPoint, NameSize, CodeSize );
+}
+
+/****************************************************************
+** Save only the differences from the dictionary file BaseName.
+** Loading the delta loads the base first, so it must not change.
+*/
+cell_t ffSaveDelta( const char *BaseName, const char *FileName, ExecToken EntryPoint, cell_t NameSize, cell_t CodeSize)
+{
+    return SaveDictionary( BaseName, FileName, EntryPoint, NameSize, CodeSize );
+}
+
 #endif /* !PF_NO_FILEIO and !PF_NO_SHELL */
 
 
@@ -528,6 +979,86 @@ static int32_t Read32FromFile( FileStream *fid, uint32_t *ValPtr )
     return 0;
 }
 
+/***************************************************************
+** Load the names and code from the base file of a delta dictionary.
+** The base is looked for as named, then next to the delta file.
+*/
+static cell_t LoadDeltaBase( const char *DeltaName, const uint8_t *Chunk, uint32_t ChunkSize )
+{
+    char Path[TIB_SIZE];
+    const char *Name = (const char *) (Chunk + 8);
+    const char *Slash;
+    uint8_t *BaseData;
+    uint32_t BaseSize;
+    const uint8_t *BaseNames = NULL;
+    const uint8_t *BaseCode = NULL;
+    uint32_t BaseNamesSize = 0;
+    uint32_t BaseCodeSize = 0;
+    uint8_t *UnpackedNames = NULL;
+    uint8_t *UnpackedCode = NULL;
+    uint64_t Hash;
+    cell_t Result = PF_ERR_BAD_FILE;
+
+    if( (ChunkSize < 10) || (Chunk[ChunkSize-1] != 0) ) return PF_ERR_BAD_FILE;
+    Hash = ((uint64_t) Read32BigEndian( Chunk ) << 32) | Read32BigEndian( Chunk + 4 );
+
+    BaseData = ReadBaseFile( Name, &BaseSize );
+    Slash = strrchr( DeltaName, '/' );
+    if( (BaseData == NULL) && (Name[0] != '/') && (Slash != NULL) &&
+        (((Slash - DeltaName) + 1 + strlen( Name )) < sizeof(Path)) )
+    {
+        pfCopyMemory( Path, DeltaName, (ucell_t) (Slash - DeltaName) + 1 );
+        strcpy( &Path[(Slash - DeltaName) + 1], Name );
+        BaseData = ReadBaseFile( Path, &BaseSize );
+    }
+    if( BaseData == NULL ) return PF_ERR_OPEN_FILE;
+
+    if( HashBytes( PF_HASH_START, BaseData, BaseSize ) != Hash )
+    {
+        Result = PF_ERR_BASE_CONFLICT;
+        goto done;
+    }
+    if( (FindBaseSegment( BaseData, BaseSize, ID_P4CD, ID_P4CZ,
+            &BaseCode, &BaseCodeSize, &UnpackedCode ) != 0) ||
+        (FindBaseSegment( BaseData, BaseSize, ID_P4NM, ID_P4NZ,
+            &BaseNames, &BaseNamesSize, &UnpackedNames ) < 0) ) goto done;
+
+    if( (BaseCodeSize > CODE_SIZE) || ((NAME_BASE != 0) && (BaseNamesSize > NAME_SIZE)) )
+    {
+        Result = PF_ERR_TOO_BIG;
+        goto done;
+    }
+    pfCopyMemory( (uint8_t *) CODE_BASE, BaseCode, BaseCodeSize );
+    if( NAME_BASE != 0 ) pfCopyMemory( (uint8_t *) NAME_BASE, BaseNames, BaseNamesSize );
+    Result = 0;
+done:
+    pfFreeMem( BaseData );
+    if( UnpackedNames != NULL ) pfFreeMem( UnpackedNames );
+    if( UnpackedCode != NULL ) pfFreeMem( UnpackedCode );
+    return Result;
+}
+
+/***************************************************************
+** Read patches written by WritePatchChunk() into a dictionary segment.
+*/
+static cell_t ReadPatchChunk( FileStream *fid, uint32_t ChunkSize, uint8_t *Segment, ucell_t SegmentSize )
+{
+    uint32_t Offset, NumBytes;
+
+    while( ChunkSize >= 8 )
+    {
+        if( Read32FromFile( fid, &Offset ) < 0 ) return PF_ERR_READ_FILE;
+        if( Read32FromFile( fid, &NumBytes ) < 0 ) return PF_ERR_READ_FILE;
+        ChunkSize -= 8;
+        if( (NumBytes > ChunkSize) || (QUADUP(NumBytes) > ChunkSize) ) return PF_ERR_BAD_FILE;
+        if( (Offset > SegmentSize) || (NumBytes > (SegmentSize - Offset)) ) return PF_ERR_TOO_BIG;
+        if( sdReadFile( Segment + Offset, 1, NumBytes, fid ) != (cell_t) NumBytes ) return PF_ERR_READ_FILE;
+        if( sdSeekFile( fid, QUADUP(NumBytes) - NumBytes, PF_SEEK_CUR ) != 0 ) return PF_ERR_READ_FILE;
+        ChunkSize -= QUADUP(NumBytes);
+    }
+    return (ChunkSize == 0) ? 0 : PF_ERR_BAD_FILE;
+}
+
 /***************************************************************/
 PForthDictionary pfLoadDictionary( const char *FileName, ExecToken *EntryPointPtr )
 {
@@ -540,6 +1071,8 @@ PForthDictionary pfLoadDictionary( const char *FileName, ExecToken *EntryPointPt
     uint32_t BytesLeft;
     cell_t numr;
     int   isDicBigEndian;
+    int   hasBase = 0;
+    cell_t Result;
 
 DBUG(("pfLoadDictionary( %s )\n", FileName ));
 
@@ -582,6 +1115,11 @@ DBUG(("pfLoadDictionary( %s )\n", FileName ));
         switch( ChunkID )
         {
         case ID_P4DI:
+            if( ChunkSize < sizeof(DictionaryInfoChunk) )
+            {
+                pfReportError("pfLoadDictionary", PF_ERR_VERSION_PAST );
+                goto error;
+            }
             sd = (DictionaryInfoChunk *) pfAllocMem( ChunkSize );
             if( sd == NULL ) goto nomem_error;
 
@@ -653,6 +1191,13 @@ DBUG(("pfLoadDictionary( %s )\n", FileName ));
                 goto error;
             }
 
+/* The primitive IDs of the raylib words come from raylib.h. */
+            if( sd->sd_RaylibHash != PF_RAYLIB_API_HASH )
+            {
+                pfReportError("pfLoadDictionary", PF_ERR_RAYLIB_CONFLICT );
+                goto error;
+            }
+
             dic = pfCreateDictionary( sd->sd_NameSize, sd->sd_CodeSize );
             if( dic == NULL ) goto nomem_error;
             gCurrentDictionary = dic;
@@ -716,6 +1261,135 @@ DBUG(("pfLoadDictionary( %s )\n", FileName ));
             BytesLeft -= ChunkSize;
             break;
 
+/* Compressed names or code. Decompress straight into the dictionary. */
+        case ID_P4NZ:
+        case ID_P4CZ:
+            {
+                uint8_t *Packed;
+                uint8_t *Segment;
+                ucell_t SegmentSize;
+                uint32_t RawSize, PackedSize;
+
+                if( dic == NULL )
+                {
+                    pfReportError("pfLoadDictionary", PF_ERR_BAD_FILE );
+                    goto error;
+                }
+                if( ChunkID == ID_P4NZ )
+                {
+#ifdef PF_NO_SHELL
+                    pfReportError("pfLoadDictionary", PF_ERR_NO_SHELL );
+                    goto error;
+#else
+                    if( NAME_BASE == 0 )
+                    {
+                        pfReportError("pfLoadDictionary", PF_ERR_NO_NAMES );
+                        goto error;
+                    }
+                    Segment = (uint8_t *) NAME_BASE;
+                    SegmentSize = NAME_SIZE;
+#endif /* PF_NO_SHELL */
+                }
+                else
+                {
+                    Segment = (uint8_t *) CODE_BASE;
+                    SegmentSize = CODE_SIZE;
+                }
+                if( ChunkSize < 8 )
+                {
+                    pfReportError("pfLoadDictionary", PF_ERR_BAD_FILE );
+                    goto error;
+                }
+                Packed = (uint8_t *) pfAllocMem( ChunkSize );
+                if( Packed == NULL ) goto nomem_error;
+                numr = sdReadFile( Packed, 1, ChunkSize, fid );
+                if( numr != ChunkSize )
+                {
+                    pfFreeMem( Packed );
+                    goto read_error;
+                }
+                BytesLeft -= ChunkSize;
+                RawSize = Read32BigEndian( Packed );
+                PackedSize = Read32BigEndian( Packed + 4 );
+                if( RawSize > SegmentSize )
+                {
+                    pfFreeMem( Packed );
+                    pfReportError("pfLoadDictionary", PF_ERR_TOO_BIG);
+                    goto error;
+                }
+                if( (PackedSize > (ChunkSize - 8)) ||
+                    (LzDecompress( Packed + 8, PackedSize, Segment, RawSize ) != (cell_t) RawSize) )
+                {
+                    pfFreeMem( Packed );
+                    pfReportError("pfLoadDictionary", PF_ERR_CORRUPT_DIC );
+                    goto error;
+                }
+                pfFreeMem( Packed );
+            }
+            break;
+
+/* Delta dictionary. Load the base then patch it. */
+        case ID_P4BS:
+            {
+                uint8_t *Chunk;
+                if( (dic == NULL) || hasBase )
+                {
+                    pfReportError("pfLoadDictionary", PF_ERR_BAD_FILE );
+                    goto error;
+                }
+                Chunk = (uint8_t *) pfAllocMem( ChunkSize );
+                if( Chunk == NULL ) goto nomem_error;
+                numr = sdReadFile( Chunk, 1, ChunkSize, fid );
+                if( numr != ChunkSize )
+                {
+                    pfFreeMem( Chunk );
+                    goto read_error;
+                }
+                BytesLeft -= ChunkSize;
+                Result = LoadDeltaBase( FileName, Chunk, ChunkSize );
+                pfFreeMem( Chunk );
+                if( Result != 0 )
+                {
+                    pfReportError("pfLoadDictionary", (Err) Result );
+                    goto error;
+                }
+                hasBase = 1;
+            }
+            break;
+
+        case ID_P4NP:
+        case ID_P4CP:
+            if( !hasBase )
+            {
+                pfReportError("pfLoadDictionary", PF_ERR_BAD_FILE );
+                goto error;
+            }
+            if( ChunkID == ID_P4NP )
+            {
+#ifdef PF_NO_SHELL
+                pfReportError("pfLoadDictionary", PF_ERR_NO_SHELL );
+                goto error;
+#else
+                if( NAME_BASE == 0 )
+                {
+                    pfReportError("pfLoadDictionary", PF_ERR_NO_NAMES );
+                    goto error;
+                }
+                Result = ReadPatchChunk( fid, ChunkSize, (uint8_t *) NAME_BASE, NAME_SIZE );
+#endif /* PF_NO_SHELL */
+            }
+            else
+            {
+                Result = ReadPatchChunk( fid, ChunkSize, (uint8_t *) CODE_BASE, CODE_SIZE );
+            }
+            if( Result != 0 )
+            {
+                pfReportError("pfLoadDictionary", (Err) Result );
+                goto error;
+            }
+            BytesLeft -= ChunkSize;
+            break;
+
         default:
             pfReportError("pfLoadDictionary", PF_ERR_BAD_FILE );
             sdSeekFile( fid, ChunkSize, PF_SEEK_CUR );
@@ -727,7 +1401,6 @@ DBUG(("pfLoadDictionary( %s )\n", FileName ));
 
     if( NAME_BASE != 0)
     {
-        cell_t Result;
 /* Find special words in dictionary for global XTs. */
         if( (Result = FindSpecialXTs()) < 0 )
         {
@@ -847,3 +1520,400 @@ nomem_error:
     return NULL;
 }
 
+
+/***************************************************************
+** Include Cache
+**
+** INCLUDE-CACHE names a directory where the headers and code added
+** by each INCLUDE are saved. The cache file is named after a hash of
+** the source text and of the dictionary that it was compiled into.
+** When the same text is included into the same dictionary again, the
+** saved bytes are read back instead of interpreting the source.
+**
+** Variables in the dictionary hold addresses that change from run to
+** run, so the dictionary is identified by its headers, the text of
+** every file included since INCLUDE-CACHE, and any code compiled
+** between those files.
+**
+** The saved bytes may hold addresses in the dictionary, and there is
+** no way to tell them from numbers. So a file is only loaded from the
+** cache when the headers and code are at the same addresses as when it
+** was saved. Otherwise it is included from the source and saved again.
+** Cells of older words that the file changed, eg. with IS or !, are
+** saved as patches and written again when it is loaded.
+**
+** A file is only saved if it did not include other files, did not
+** print anything, and left the stack depth, BASE and STATE alone.
+** Loading from the cache only changes the dictionary. Files that
+** ALLOCATE memory, open files or call C code that keeps state when
+** they are loaded should not be cached.
+**
+** Each thread has its own cache directory. A new thread starts with
+** the cache turned off.
+***************************************************************/
+#if defined(PF_NO_FILEIO) || defined(PF_NO_SHELL)
+
+cell_t ffSetIncludeCache( const char *DirName, cell_t Len )
+{
+    TOUCH(DirName);
+    TOUCH(Len);
+    return -1;
+}
+
+cell_t ffBeginCachedInclude( FileStream *InputFile, IncludeCacheState *ics )
+{
+    TOUCH(InputFile);
+    ics->ics_Active = 0;
+    return 0;
+}
+
+void ffEndCachedInclude( IncludeCacheState *ics, ThrowCode Result )
+{
+    TOUCH(ics);
+    TOUCH(Result);
+}
+
+#else /* PF_NO_FILEIO or PF_NO_SHELL */
+
+#define PF_MAX_CACHE_DIR   (200)
+
+static PF_THREAD_LOCAL char gIncludeCacheDir[PF_MAX_CACHE_DIR+1];
+/* Counts calls to ffBeginCachedInclude() so we can tell if a file included another. */
+static PF_THREAD_LOCAL cell_t gIncludeCount;
+/* Hash of the files included so far, and where the last one ended. */
+static PF_THREAD_LOCAL uint64_t gIncludeChain;
+static PF_THREAD_LOCAL cell_t   gIncludeChainCode;
+
+static uint64_t HashCell( uint64_t Hash, cell_t Value )
+{
+    return HashBytes( Hash, (const uint8_t *) &Value, sizeof(cell_t) );
+}
+
+/***************************************************************
+** Set the directory for the include cache.
+** An empty name turns the cache off. Return -2 if the name is too long.
+*/
+cell_t ffSetIncludeCache( const char *DirName, cell_t Len )
+{
+    if( Len > PF_MAX_CACHE_DIR ) return -2;
+    pfCopyMemory( gIncludeCacheDir, DirName, (ucell_t) Len );
+    gIncludeCacheDir[Len] = '\0';
+
+/* Start a new chain. The build time stands in for the code compiled before now. */
+    gIncludeChain = HashBytes( PF_HASH_START, (const uint8_t *) __DATE__ __TIME__,
+        sizeof(__DATE__ __TIME__) );
+    gIncludeChainCode = ABS_TO_CODEREL( gCurrentDictionary->dic_CodePtr.Byte );
+    return 0;
+}
+
+/* Build "DIR/0123456789ABCDEF.p4c" from the key. */
+static void BuildCacheFileName( char *FileName, uint64_t Key )
+{
+    cell_t Len = (cell_t) pfCStringLength( gIncludeCacheDir );
+    int i;
+
+    pfCopyMemory( FileName, gIncludeCacheDir, (ucell_t) Len );
+    FileName[Len++] = '/';
+    for( i=60; i>=0; i-=4 )
+    {
+        FileName[Len++] = "0123456789ABCDEF"[ (Key >> i) & 0xF ];
+    }
+    pfCopyMemory( &FileName[Len], ".p4c", 5 );
+}
+
+/***************************************************************
+** Read the cache file for ics and add it to the dictionary.
+** The size of the file is checked first so it is not read in part.
+** Return 0 if loaded.
+*/
+static cell_t LoadIncludeCache( const IncludeCacheState *ics )
+{
+    char FileName[PF_MAX_CACHE_DIR + 32];
+    FileStream *fid;
+    IncludeCacheChunk IC;
+    uint32_t ChunkID;
+    uint32_t ChunkSize;
+    uint32_t BytesLeft;
+    ucell_t Start = 0;
+    ucell_t Limit;
+    ucell_t NameEnd = 0;
+    ucell_t CodeEnd = 0;
+    int GotInfo = 0;
+    uint32_t *p;
+    int i;
+
+    BuildCacheFileName( FileName, ics->ics_Key );
+    fid = sdOpenFile( FileName, "rb" );
+    if( fid == NULL ) return -1;
+
+    if( Read32FromFile( fid, &ChunkID ) < 0 || ChunkID != ID_FORM ) goto error;
+    if( Read32FromFile( fid, &BytesLeft ) < 0 ) goto error;
+    if( sdSeekFile( fid, 0, PF_SEEK_END ) != 0 ) goto error;
+    if( sdTellFile( fid ) != (file_offset_t) BytesLeft + 8 ) goto error;
+    if( sdSeekFile( fid, 8, PF_SEEK_SET ) != 0 ) goto error;
+    if( Read32FromFile( fid, &ChunkID ) < 0 || ChunkID != ID_P4IC ) goto error;
+    BytesLeft -= 4;
+
+    while( BytesLeft > 0 )
+    {
+        if( Read32FromFile( fid, &ChunkID ) < 0 ) goto error;
+        if( Read32FromFile( fid, &ChunkSize ) < 0 ) goto error;
+        BytesLeft -= 8;
+        if( ChunkSize > BytesLeft ) goto error;
+
+        switch( ChunkID )
+        {
+        case ID_P4IH:
+            if( ChunkSize != sizeof(IC) ) goto error;
+            if( sdReadFile( &IC, 1, ChunkSize, fid ) != ChunkSize ) goto error;
+            p = (uint32_t *) &IC;
+            for( i=0; i<((int)(sizeof(IC)/sizeof(uint32_t))); i++ )
+            {
+                p[i] = Read32BigEndian( (uint8_t *)&p[i] );
+            }
+/* The key should match but check everything we rely on. */
+            if( (IC.ic_Version != PF_FILE_VERSION) ||
+                (IC.ic_CellSize != sizeof(cell_t)) ||
+                (IC.ic_KeyHigh != (uint32_t)(ics->ics_Key >> 32)) ||
+                (IC.ic_KeyLow != (uint32_t) ics->ics_Key) ||
+                (IC.ic_RelHeaderStart != ABS_TO_NAMEREL(ics->ics_HeaderPtr)) ||
+                (IC.ic_RelCodeStart != ABS_TO_CODEREL(ics->ics_CodePtr)) ||
+                (IC.ic_RelHeaderEnd < IC.ic_RelHeaderStart) ||
+                (IC.ic_RelCodeEnd < IC.ic_RelCodeStart) ) goto error;
+/* Addresses in the saved bytes are only right at the same place. */
+            if( (IC.ic_NameBaseHigh != (uint32_t) ((NAME_BASE >> 16) >> 16)) ||
+                (IC.ic_NameBaseLow != (uint32_t) NAME_BASE) ||
+                (IC.ic_CodeBaseHigh != (uint32_t) ((CODE_BASE >> 16) >> 16)) ||
+                (IC.ic_CodeBaseLow != (uint32_t) CODE_BASE) ) goto error;
+            NameEnd = (ucell_t) NAMEREL_TO_ABS( IC.ic_RelHeaderEnd );
+            CodeEnd = (ucell_t) CODEREL_TO_ABS( IC.ic_RelCodeEnd );
+            GotInfo = 1;
+            break;
+
+        case ID_P4NM:
+        case ID_P4CD:
+            if( !GotInfo ) goto error;
+            if( ChunkID == ID_P4NM )
+            {
+                Start = ics->ics_HeaderPtr;
+                Limit = gCurrentDictionary->dic_HeaderLimit;
+            }
+            else
+            {
+                Start = ics->ics_CodePtr;
+                Limit = gCurrentDictionary->dic_CodeLimit;
+            }
+            if( ChunkSize > (Limit - Start) )
+            {
+                pfReportError("LoadIncludeCache", PF_ERR_TOO_BIG);
+                goto error;
+            }
+            if( sdReadFile( (void *) Start, 1, ChunkSize, fid ) != ChunkSize ) goto error;
+            break;
+
+/* Changes to older words. */
+        case ID_P4NP:
+        case ID_P4CP:
+            if( !GotInfo ) goto error;
+            if( ChunkID == ID_P4NP )
+            {
+                if( ReadPatchChunk( fid, ChunkSize, (uint8_t *) NAME_BASE, ics->ics_HeaderPtr - NAME_BASE ) != 0 ) goto error;
+            }
+            else
+            {
+                if( ReadPatchChunk( fid, ChunkSize, (uint8_t *) CODE_BASE, ics->ics_CodePtr - CODE_BASE ) != 0 ) goto error;
+            }
+            break;
+
+        default:
+            goto error;
+        }
+        BytesLeft -= ChunkSize;
+    }
+    sdCloseFile( fid );
+    if( !GotInfo ) return -1;
+
+    gCurrentDictionary->dic_HeaderPtr = NameEnd;
+    gCurrentDictionary->dic_CodePtr.Byte = (uint8_t *) CodeEnd;
+    gVarContext = NAMEREL_TO_ABS( IC.ic_RelContext );
+    return 0;
+
+error:
+    sdCloseFile( fid );
+    return -1;
+}
+
+/***************************************************************
+** Save what was added to the dictionary since ffBeginCachedInclude(),
+** and what changed in the part that was there before.
+*/
+static void SaveIncludeCache( const IncludeCacheState *ics )
+{
+    char FileName[PF_MAX_CACHE_DIR + 32];
+    FileStream *fid;
+    IncludeCacheChunk IC;
+    uint32_t FormSize;
+    uint32_t *p;
+    int i;
+
+    IC.ic_Version = PF_FILE_VERSION;
+    IC.ic_CellSize = sizeof(cell_t);
+    IC.ic_KeyHigh = (uint32_t)(ics->ics_Key >> 32);
+    IC.ic_KeyLow = (uint32_t) ics->ics_Key;
+    IC.ic_RelHeaderStart = ABS_TO_NAMEREL( ics->ics_HeaderPtr );
+    IC.ic_RelCodeStart = ABS_TO_CODEREL( ics->ics_CodePtr );
+    IC.ic_RelHeaderEnd = ABS_TO_NAMEREL( gCurrentDictionary->dic_HeaderPtr );
+    IC.ic_RelCodeEnd = ABS_TO_CODEREL( gCurrentDictionary->dic_CodePtr.Byte );
+    IC.ic_RelContext = ABS_TO_NAMEREL( gVarContext );
+    IC.ic_NameBaseHigh = (uint32_t) ((NAME_BASE >> 16) >> 16);
+    IC.ic_NameBaseLow = (uint32_t) NAME_BASE;
+    IC.ic_CodeBaseHigh = (uint32_t) ((CODE_BASE >> 16) >> 16);
+    IC.ic_CodeBaseLow = (uint32_t) CODE_BASE;
+    p = (uint32_t *) &IC;
+    for( i=0; i<((int)(sizeof(IC)/sizeof(uint32_t))); i++ )
+    {
+        Write32BigEndian( (uint8_t *)&p[i], p[i] );
+    }
+
+    BuildCacheFileName( FileName, ics->ics_Key );
+    fid = sdOpenFile( FileName, "wb" );
+    if( fid == NULL ) return;  /* No cache directory, run normally. */
+
+    if( Write32ToFile( fid, ID_FORM ) < 0 ) goto error;
+    if( Write32ToFile( fid, 0 ) < 0 ) goto error;
+    if( Write32ToFile( fid, ID_P4IC ) < 0 ) goto error;
+    if( WriteChunkToFile( fid, ID_P4IH, (char *) &IC, sizeof(IC) ) < 0 ) goto error;
+    if( WriteChunkToFile( fid, ID_P4NM, (char *) ics->ics_HeaderPtr,
+        (int32_t) (gCurrentDictionary->dic_HeaderPtr - ics->ics_HeaderPtr) ) < 0 ) goto error;
+    if( WriteChunkToFile( fid, ID_P4CD, (char *) ics->ics_CodePtr,
+        (int32_t) (gCurrentDictionary->dic_CodePtr.Byte - (uint8_t *) ics->ics_CodePtr) ) < 0 ) goto error;
+    if( WritePatchChunk( fid, ID_P4NP, (uint8_t *) NAME_BASE, (uint32_t) (ics->ics_HeaderPtr - NAME_BASE),
+        ics->ics_OldNames, (uint32_t) (ics->ics_HeaderPtr - NAME_BASE) ) < 0 ) goto error;
+    if( WritePatchChunk( fid, ID_P4CP, (uint8_t *) CODE_BASE, (uint32_t) (ics->ics_CodePtr - CODE_BASE),
+        ics->ics_OldCode, (uint32_t) (ics->ics_CodePtr - CODE_BASE) ) < 0 ) goto error;
+
+    FormSize = (uint32_t) sdTellFile( fid ) - 8;
+    sdSeekFile( fid, 4, PF_SEEK_SET );
+    if( Write32ToFile( fid, FormSize ) < 0 ) goto error;
+    sdCloseFile( fid );
+    return;
+
+error:
+    sdSeekFile( fid, 0, PF_SEEK_SET );
+    Write32ToFile( fid, ID_BADF ); /* Mark file as bad. */
+    sdCloseFile( fid );
+}
+
+/* Free the copy of the dictionary made by ffBeginCachedInclude(). */
+static void FreeIncludeCopy( IncludeCacheState *ics )
+{
+    if( ics->ics_OldNames != NULL ) pfFreeMem( ics->ics_OldNames );
+    if( ics->ics_OldCode != NULL ) pfFreeMem( ics->ics_OldCode );
+    ics->ics_OldNames = NULL;
+    ics->ics_OldCode = NULL;
+}
+
+/***************************************************************
+** Called before interpreting an include file.
+** Return 1 if the file was loaded from the cache and should be skipped.
+*/
+cell_t ffBeginCachedInclude( FileStream *InputFile, IncludeCacheState *ics )
+{
+    uint8_t Buffer[512];
+    cell_t numr;
+    file_offset_t Position;
+    uint64_t Key;
+
+    ics->ics_Active = 0;
+    ics->ics_Hit = 0;
+    ics->ics_Key = 0;
+    ics->ics_OldNames = NULL;
+    ics->ics_OldCode = NULL;
+    ics->ics_IncludeCount = ++gIncludeCount;
+    if( (gIncludeCacheDir[0] == '\0') || (NAME_BASE == 0) ) return 0;
+
+/* Hash the rest of the source file then go back. */
+    Position = sdTellFile( InputFile );
+    if( Position < 0 ) return 0;
+    Key = PF_HASH_START;
+    while( (numr = sdReadFile( Buffer, 1, sizeof(Buffer), InputFile )) > 0 )
+    {
+        Key = HashBytes( Key, Buffer, (ucell_t) numr );
+    }
+    if( sdSeekFile( InputFile, Position, PF_SEEK_SET ) != 0 ) return 0;
+
+    ics->ics_HeaderPtr = gCurrentDictionary->dic_HeaderPtr;
+    ics->ics_CodePtr = (ucell_t) gCurrentDictionary->dic_CodePtr.Byte;
+    ics->ics_Depth = gCurrentTask->td_StackBase - gCurrentTask->td_StackPtr;
+#ifdef PF_SUPPORT_FP
+    ics->ics_FloatDepth = gCurrentTask->td_FloatStackBase - gCurrentTask->td_FloatStackPtr;
+#endif
+    ics->ics_Base = gVarBase;
+
+/* The same source compiled into the same dictionary gives the same result. */
+    Key = HashBytes( Key, (const uint8_t *) &gIncludeChain, sizeof(gIncludeChain) );
+    Key = HashBytes( Key, (const uint8_t *) NAME_BASE, ics->ics_HeaderPtr - NAME_BASE );
+    if( (gIncludeChainCode >= 0) && (gIncludeChainCode <= ABS_TO_CODEREL( ics->ics_CodePtr )) )
+    {
+        Key = HashBytes( Key, (const uint8_t *) CODEREL_TO_ABS( gIncludeChainCode ),
+            ABS_TO_CODEREL( ics->ics_CodePtr ) - gIncludeChainCode );
+    }
+    Key = HashCell( Key, ABS_TO_NAMEREL( ics->ics_HeaderPtr ) );
+    Key = HashCell( Key, ABS_TO_CODEREL( ics->ics_CodePtr ) );
+    Key = HashCell( Key, ABS_TO_NAMEREL( gVarContext ) );
+    Key = HashCell( Key, gVarBase );
+    Key = HashCell( Key, PF_FILE_VERSION );
+    Key = HashCell( Key, PF_RAYLIB_API_HASH );
+    ics->ics_Key = Key;
+
+    if( LoadIncludeCache( ics ) == 0 )
+    {
+        ics->ics_Hit = 1;
+        return 1;
+    }
+
+/* Keep a copy of the dictionary to see what the file changes. */
+    ics->ics_OldNames = (uint8_t *) pfAllocMem( ics->ics_HeaderPtr - NAME_BASE + 1 );
+    ics->ics_OldCode = (uint8_t *) pfAllocMem( ics->ics_CodePtr - CODE_BASE + 1 );
+    if( (ics->ics_OldNames == NULL) || (ics->ics_OldCode == NULL) )
+    {
+        FreeIncludeCopy( ics );
+        return 0;
+    }
+    pfCopyMemory( ics->ics_OldNames, (void *) NAME_BASE, ics->ics_HeaderPtr - NAME_BASE );
+    pfCopyMemory( ics->ics_OldCode, (void *) CODE_BASE, ics->ics_CodePtr - CODE_BASE );
+    ics->ics_Output = ioOutputCount();
+    ics->ics_Active = 1;
+    return 0;
+}
+
+/***************************************************************
+** Called after an include file was loaded or interpreted.
+** Save the new words if there was no error and nothing else was changed.
+*/
+void ffEndCachedInclude( IncludeCacheState *ics, ThrowCode Result )
+{
+    if( ics->ics_Key == 0 ) return;
+
+    if( ics->ics_Active && (Result == 0) &&
+        (gIncludeCount == ics->ics_IncludeCount) &&  /* Did not include other files. */
+        (ioOutputCount() == ics->ics_Output) &&      /* Did not print, eg. with .( */
+        !gVarState && (gVarBase == ics->ics_Base) &&
+        (gCurrentDictionary->dic_HeaderPtr >= ics->ics_HeaderPtr) &&
+        ((ucell_t) gCurrentDictionary->dic_CodePtr.Byte >= ics->ics_CodePtr) &&
+        (ics->ics_Depth == (gCurrentTask->td_StackBase - gCurrentTask->td_StackPtr))
+#ifdef PF_SUPPORT_FP
+        && (ics->ics_FloatDepth == (gCurrentTask->td_FloatStackBase - gCurrentTask->td_FloatStackPtr))
+#endif
+        )
+    {
+        SaveIncludeCache( ics );
+    }
+    FreeIncludeCopy( ics );
+
+/* Files included after this one depend on it. */
+    gIncludeChain = HashBytes( gIncludeChain, (const uint8_t *) &ics->ics_Key, sizeof(ics->ics_Key) );
+    gIncludeChainCode = ABS_TO_CODEREL( gCurrentDictionary->dic_CodePtr.Byte );
+}
+
+#endif /* PF_NO_FILEIO or PF_NO_SHELL */
@@ -44,8 +44,44 @@ typedef struct DictionaryInfoChunk
     uint32_t sd_Flags;
     int32_t  sd_FloatSize;       /* In bytes. Must match code. 0 means no floats. */
     int32_t  sd_CellSize;        /* In bytes. Must match code. */
+    uint32_t sd_RaylibHash;      /* PF_RAYLIB_API_HASH. Must match code. */
 } DictionaryInfoChunk;
 
+/* Header of a cached INCLUDE file. Stored like DictionaryInfoChunk. */
+typedef struct IncludeCacheChunk
+{
+    int32_t  ic_Version;
+    int32_t  ic_CellSize;
+    uint32_t ic_KeyHigh;         /* Hash of source text and dictionary */
+    uint32_t ic_KeyLow;
+    int32_t  ic_RelHeaderStart;  /* relative Header Ptr before the include */
+    int32_t  ic_RelCodeStart;    /* relative Code Ptr before the include */
+    int32_t  ic_RelHeaderEnd;    /* and after */
+    int32_t  ic_RelCodeEnd;
+    int32_t  ic_RelContext;      /* relative ptr to Dictionary Context after */
+    uint32_t ic_NameBaseHigh;    /* Where the dictionary was when it was saved. Must match. */
+    uint32_t ic_NameBaseLow;
+    uint32_t ic_CodeBaseHigh;
+    uint32_t ic_CodeBaseLow;
+} IncludeCacheChunk;
+
+/* State saved by ffBeginCachedInclude() for ffEndCachedInclude(). */
+typedef struct IncludeCacheState
+{
+    uint64_t ics_Key;
+    uint8_t *ics_OldNames;       /* Copy of the dictionary before the include. */
+    uint8_t *ics_OldCode;
+    ucell_t  ics_Output;         /* ioOutputCount() before the include. */
+    ucell_t  ics_HeaderPtr;
+    ucell_t  ics_CodePtr;
+    cell_t   ics_Depth;
+    cell_t   ics_FloatDepth;
+    cell_t   ics_Base;
+    cell_t   ics_IncludeCount;
+    int      ics_Active;         /* True if the result should be saved. */
+    int      ics_Hit;            /* True if loaded from the cache. */
+} IncludeCacheState;
+
 /* Bits in sd_Flags */
 #define SD_F_BIG_ENDIAN_DIC    (1<<0)
 
@@ -59,6 +95,13 @@ typedef struct DictionaryInfoChunk
 #define ID_P4NM MAKE_ID('P','4','N','M')
 #define ID_P4CD MAKE_ID('P','4','C','D')
 #define ID_BADF MAKE_ID('B','A','D','F')
+#define ID_P4IC MAKE_ID('P','4','I','C')
+#define ID_P4IH MAKE_ID('P','4','I','H')
+#define ID_P4BS MAKE_ID('P','4','B','S')  /* Base file hash and name of a delta */
+#define ID_P4NP MAKE_ID('P','4','N','P')  /* Name patches of a delta */
+#define ID_P4CP MAKE_ID('P','4','C','P')  /* Code patches of a delta */
+#define ID_P4NZ MAKE_ID('P','4','N','Z')  /* Compressed names */
+#define ID_P4CZ MAKE_ID('P','4','C','Z')  /* Compressed code */
 
 #ifndef EVENUP
 #define EVENUP(n) ((n+1)&(~1))
@@ -69,6 +112,12 @@ extern "C" {
 #endif
 
 cell_t ffSaveForth( const char *FileName, ExecToken EntryPoint, cell_t NameSize, cell_t CodeSize );
+cell_t ffSaveDelta( const char *BaseName, const char *FileName, ExecToken EntryPoint, cell_t NameSize, cell_t CodeSize );
+
+/* Include cache. */
+cell_t ffSetIncludeCache( const char *DirName, cell_t Len );
+cell_t ffBeginCachedInclude( FileStream *InputFile, IncludeCacheState *ics );
+void   ffEndCachedInclude( IncludeCacheState *ics, ThrowCode Result );
 
 /* Endian-ness tools. */
 int    IsHostLittleEndian( void );
@@ -87,6 +87,10 @@ void pfReportError( const char *FunctionName, Err ErrCode )
         s = "float support mismatch between .dic file and code";  break;
     case PF_ERR_CELL_SIZE_CONFLICT & 0xFF:
         s = "cell size mismatch between .dic file and code";  break;
+    case PF_ERR_BASE_CONFLICT & 0xFF:
+        s = "delta .dic file does not match its base file";  break;
+    case PF_ERR_RAYLIB_CONFLICT & 0xFF:
+        s = "raylib.h mismatch between .dic file and code";  break;
     default:
         s = "unrecognized error code!"; break;
     }
@@ -106,8 +110,12 @@ void pfReportThrow( ThrowCode code )
         s = "Stack overflow!"; break;
     case THROW_STACK_UNDERFLOW:
         s = "Stack underflow!"; break;
+    case THROW_DIVIDE_BY_ZERO:
+        s = "Division by zero!"; break;
     case THROW_EXECUTING:
         s = "Executing a compile-only word!"; break;
+    case THROW_UNSUPPORTED:
+        s = "Not supported by this version of pForth!"; break;
     case THROW_FLOAT_STACK_UNDERFLOW:
         s = "Float Stack underflow!"; break;
     case THROW_UNDEFINED_WORD:
@@ -121,6 +129,10 @@ void pfReportThrow( ThrowCode code )
         s = "Stack depth changed between : and ; . Probably unbalanced conditional!"; break;
     case THROW_DEFERRED:
         s = "Not a DEFERred word!"; break;
+    case THROW_PAUSE:
+        s = "Task cannot PAUSE inside CATCH or a C callback!"; break;
+    case THROW_RAYLIB_HANDLE:
+        s = "Invalid raylib handle, it was unloaded or is the wrong type!"; break;
     default:
         s = "Unrecognized throw code!"; break;
     }
@@ -180,17 +192,12 @@ char *CStringToForth( char *dst, const char *CString, cell_t dstSize )
 */
 cell_t ffCompareText( const char *s1, const char *s2, cell_t len )
 {
-    cell_t i, Result;
+    cell_t Result;
 
     Result = TRUE;
-    for( i=0; i<len; i++ )
+    if( (len > 0) && (pfMatchChars( s1, s2, (ucell_t) len ) != (ucell_t) len) )
     {
-DBUGX(("ffCompareText: *s1 = 0x%x, *s2 = 0x%x\n", *s1, *s2 ));
-        if( *s1++ != *s2++ )
-        {
-            Result = FALSE;
-            break;
-        }
+        Result = FALSE;
     }
 DBUGX(("ffCompareText: return 0x%x\n", Result ));
     return Result;
@@ -206,16 +213,21 @@ cell_t ffCompareTextCaseN( const char *s1, const char *s2, cell_t len )
     char  c1,c2;
 
     Result = TRUE;
-    for( i=0; i<len; i++ )
+    i = 0;
+    while( i < len )
     {
-        c1 = pfCharToLower(*s1++);
-        c2 = pfCharToLower(*s2++);
+    /* Skip characters that match exactly, then fold case at the first difference. */
+        i += (cell_t) pfMatchChars( s1 + i, s2 + i, (ucell_t) (len - i) );
+        if( i >= len ) break;
+        c1 = pfCharToLower(s1[i]);
+        c2 = pfCharToLower(s2[i]);
 DBUGX(("ffCompareText: c1 = 0x%x, c2 = 0x%x\n", c1, c2 ));
         if( c1 != c2 )
         {
             Result = FALSE;
             break;
         }
+        i++;
     }
 DBUGX(("ffCompareText: return 0x%x\n", Result ));
     return Result;
@@ -231,13 +243,11 @@ cell_t ffCompare( const char *s1, cell_t len1, const char *s2, cell_t len2 )
 
     result = 0;
     n = MIN(len1,len2);
-    for( i=0; i<n; i++ )
+    i = (n > 0) ? (cell_t) pfMatchChars( s1, s2, (ucell_t) n ) : 0;
+    if( i < n )
     {
-        if( (diff = (*s2++ - *s1++)) != 0 )
-        {
-            result = (diff > 0) ? -1 : 1 ;
-            break;
-        }
+        diff = s2[i] - s1[i];
+        result = (diff > 0) ? -1 : 1 ;
     }
     if( result == 0 )  /* Match up to MIN(len1,len2) */
     {
@@ -257,7 +267,7 @@ cell_t ffCompare( const char *s1, cell_t len1, const char *s2, cell_t len2 )
 ** Convert number to text.
 */
 #define CNTT_PAD_SIZE ((sizeof(cell_t)*8)+2)  /* PLB 19980522 - Expand PAD so "-1 binary .s" doesn't crash. */
-static char cnttPad[CNTT_PAD_SIZE];
+static PF_THREAD_LOCAL char cnttPad[CNTT_PAD_SIZE];
 
 char *ConvertNumberToText( cell_t Num, cell_t Base, int32_t IfSigned, int32_t MinChars )
 {
@@ -45,6 +45,8 @@
 #define PF_ERR_ENDIAN_CONFLICT (PF_ERR_BASE | 19)
 #define PF_ERR_FLOAT_CONFLICT  (PF_ERR_BASE | 20)
 #define PF_ERR_CELL_SIZE_CONFLICT (PF_ERR_BASE | 21)
+#define PF_ERR_BASE_CONFLICT   (PF_ERR_BASE | 22)
+#define PF_ERR_RAYLIB_CONFLICT (PF_ERR_BASE | 23)
 /* If you add an error code here, also add a text message in "pf_text.c". */
 
 #ifdef __cplusplus
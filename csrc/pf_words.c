@@ -78,6 +78,7 @@ void ffDotS( void )
 cell_t ffSkip( char *AddrIn, cell_t Cnt, char c, char **AddrOut )
 {
     char *s;
+    cell_t Skipped;
 
     s = AddrIn;
 
@@ -91,14 +92,12 @@ DBUGX(("ffSkip EMPTY_SPACE: %c, %d\n", *s, Cnt ));
             Cnt--;
         }
     }
-    else
+    else if( Cnt > 0 )
     {
-        while(( Cnt > 0 ) && ( *s == c ))
-        {
-DBUGX(("ffSkip: %c=0x%x, %d\n", *s, Cnt ));
-        s++;
-        Cnt--;
-        }
+        Skipped = (cell_t) pfSkipChar( s, (ucell_t) Cnt, c );
+DBUGX(("ffSkip: %c=0x%x, %d\n", c, Skipped ));
+        s += Skipped;
+        Cnt -= Skipped;
     }
     *AddrOut = s;
     return Cnt;
@@ -108,30 +107,24 @@ DBUGX(("ffSkip: %c=0x%x, %d\n", *s, Cnt ));
 cell_t ffScan( char *AddrIn, cell_t Cnt, char c, char **AddrOut )
 {
     char *s;
+    cell_t Scanned;
 
     s = AddrIn;
 
-    if( c == SPACE_CHARACTER )
+    if( Cnt > 0 )
     {
-        while(( Cnt > 0 ) &&
-            ( *s != SPACE_CHARACTER) &&
-            ( *s != '\r') &&
-            ( *s != '\n') &&
-            ( *s != '\t'))
+        if( c == SPACE_CHARACTER )
         {
-DBUGX(("ffScan EMPTY_SPACE: %c, %d\n", *s, Cnt ));
-            s++;
-            Cnt--;
+        /* Stops on space, tab, CR or LF. */
+            Scanned = (cell_t) pfFindBlank( s, (ucell_t) Cnt );
         }
-    }
-    else
-    {
-        while(( Cnt > 0 ) && ( *s != c ))
+        else
         {
-DBUGX(("ffScan: %c, %d\n", *s, Cnt ));
-            s++;
-            Cnt--;
+            Scanned = (cell_t) pfFindChar( s, (ucell_t) Cnt, c );
         }
+DBUGX(("ffScan: %c, %d\n", c, Scanned ));
+        s += Scanned;
+        Cnt -= Scanned;
     }
     *AddrOut = s;
     return Cnt;
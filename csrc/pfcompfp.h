@@ -78,4 +78,53 @@
     CreateDicEntryC( ID_FP_FTANH, "FTANH", 0 );
     CreateDicEntryC( ID_FP_FPICK, "FPICK", 0 );
 
+/* Typed array words, ( addr ... n -- ) on float64, float32 and int32 arrays. */
+    CreateDicEntryC( ID_FP_DFV_PLUS, "DFV+", 0 );
+    CreateDicEntryC( ID_FP_DFV_MINUS, "DFV-", 0 );
+    CreateDicEntryC( ID_FP_DFV_TIMES, "DFV*", 0 );
+    CreateDicEntryC( ID_FP_DFV_PLUS_S, "DFV+S", 0 );
+    CreateDicEntryC( ID_FP_DFV_MINUS_S, "DFV-S", 0 );
+    CreateDicEntryC( ID_FP_DFV_TIMES_S, "DFV*S", 0 );
+    CreateDicEntryC( ID_FP_DFV_FMA, "DFV-FMA", 0 );
+    CreateDicEntryC( ID_FP_DFV_FMA_S, "DFV-FMAS", 0 );
+    CreateDicEntryC( ID_FP_DFV_DOT, "DFV-DOT", 0 );
+    CreateDicEntryC( ID_FP_DFV_SUM, "DFV-SUM", 0 );
+    CreateDicEntryC( ID_FP_DFV_MIN, "DFV-MIN", 0 );
+    CreateDicEntryC( ID_FP_DFV_MAX, "DFV-MAX", 0 );
+    CreateDicEntryC( ID_FP_DFV_CLAMP, "DFV-CLAMP", 0 );
+    CreateDicEntryC( ID_FP_SFV_PLUS, "SFV+", 0 );
+    CreateDicEntryC( ID_FP_SFV_MINUS, "SFV-", 0 );
+    CreateDicEntryC( ID_FP_SFV_TIMES, "SFV*", 0 );
+    CreateDicEntryC( ID_FP_SFV_PLUS_S, "SFV+S", 0 );
+    CreateDicEntryC( ID_FP_SFV_MINUS_S, "SFV-S", 0 );
+    CreateDicEntryC( ID_FP_SFV_TIMES_S, "SFV*S", 0 );
+    CreateDicEntryC( ID_FP_SFV_FMA, "SFV-FMA", 0 );
+    CreateDicEntryC( ID_FP_SFV_FMA_S, "SFV-FMAS", 0 );
+    CreateDicEntryC( ID_FP_SFV_DOT, "SFV-DOT", 0 );
+    CreateDicEntryC( ID_FP_SFV_SUM, "SFV-SUM", 0 );
+    CreateDicEntryC( ID_FP_SFV_MIN, "SFV-MIN", 0 );
+    CreateDicEntryC( ID_FP_SFV_MAX, "SFV-MAX", 0 );
+    CreateDicEntryC( ID_FP_SFV_CLAMP, "SFV-CLAMP", 0 );
+    CreateDicEntryC( ID_FP_IV_PLUS, "IV+", 0 );
+    CreateDicEntryC( ID_FP_IV_MINUS, "IV-", 0 );
+    CreateDicEntryC( ID_FP_IV_TIMES, "IV*", 0 );
+    CreateDicEntryC( ID_FP_IV_PLUS_S, "IV+S", 0 );
+    CreateDicEntryC( ID_FP_IV_MINUS_S, "IV-S", 0 );
+    CreateDicEntryC( ID_FP_IV_TIMES_S, "IV*S", 0 );
+    CreateDicEntryC( ID_FP_IV_FMA, "IV-FMA", 0 );
+    CreateDicEntryC( ID_FP_IV_FMA_S, "IV-FMAS", 0 );
+    CreateDicEntryC( ID_FP_IV_DOT, "IV-DOT", 0 );
+    CreateDicEntryC( ID_FP_IV_SUM, "IV-SUM", 0 );
+    CreateDicEntryC( ID_FP_IV_MIN, "IV-MIN", 0 );
+    CreateDicEntryC( ID_FP_IV_MAX, "IV-MAX", 0 );
+    CreateDicEntryC( ID_FP_IV_CLAMP, "IV-CLAMP", 0 );
+    CreateDicEntryC( ID_FP_CELLS_TO_DFV, "CELLS>DFV", 0 );
+    CreateDicEntryC( ID_FP_DFV_TO_CELLS, "DFV>CELLS", 0 );
+    CreateDicEntryC( ID_FP_CELLS_TO_SFV, "CELLS>SFV", 0 );
+    CreateDicEntryC( ID_FP_SFV_TO_CELLS, "SFV>CELLS", 0 );
+    CreateDicEntryC( ID_FP_CELLS_TO_IV, "CELLS>IV", 0 );
+    CreateDicEntryC( ID_FP_IV_TO_CELLS, "IV>CELLS", 0 );
+    CreateDicEntryC( ID_FP_SFV_TO_DFV, "SFV>DFV", 0 );
+    CreateDicEntryC( ID_FP_DFV_TO_SFV, "DFV>SFV", 0 );
+
 #endif
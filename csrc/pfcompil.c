@@ -42,6 +42,7 @@ static cell_t ffCheckDicRoom( void );
 
 #ifndef PF_NO_INIT
     static void CreateDeferredC( ExecToken DefaultXT, const char *CName );
+    static void CreateConstantC( const char *CName, cell_t Value );
 #endif
 
 cell_t NotCompiled( const char *FunctionName )
@@ -52,6 +53,41 @@ cell_t NotCompiled( const char *FunctionName )
     return -1;
 }
 
+#ifdef PF_SUPPORT_THREADS
+/***************************************************************
+** The dictionary is shared by all threads.
+** A thread holds the lock from : to ; and while CREATE or DEFER
+** build a word or FIND searches. HERE, ALLOT, ALIGN, "," C, and W,
+** also take it, so they wait for a definition on another thread
+** to be finished. Nested calls are counted so
+** ffStringCreate() can lock inside a colon definition.
+*/
+static PF_THREAD_LOCAL cell_t gDictionaryLockDepth;
+
+void pfLockDictionary( void )
+{
+    if( gDictionaryLockDepth++ == 0 ) sdLock( PF_LOCK_DICTIONARY );
+}
+
+void pfUnlockDictionary( void )
+{
+    if( gDictionaryLockDepth > 0 )
+    {
+        if( --gDictionaryLockDepth == 0 ) sdUnlock( PF_LOCK_DICTIONARY );
+    }
+}
+
+/* Give up the lock however deeply it is held, eg. after ABORT. */
+void pfReleaseDictionary( void )
+{
+    if( gDictionaryLockDepth > 0 )
+    {
+        gDictionaryLockDepth = 0;
+        sdUnlock( PF_LOCK_DICTIONARY );
+    }
+}
+#endif /* PF_SUPPORT_THREADS */
+
 #ifndef PF_NO_SHELL
 /***************************************************************
 ** Create an entry in the Dictionary for the given ExecutionToken.
@@ -193,15 +229,23 @@ PForthDictionary pfBuildDictionary( cell_t HeaderSize, cell_t CodeSize )
     CreateDicEntryC( ID_ALITERAL_P, "(ALITERAL)", 0 );
     CreateDicEntryC( ID_ALLOCATE, "ALLOCATE", 0 );
     pfDebugMessage("pfBuildDictionary: added ALLOCATE\n");
+    CreateDicEntryC( ID_ARENA, "ARENA", 0 );
+    CreateDicEntryC( ID_ARENA_ALLOT, "ARENA-ALLOT", 0 );
+    CreateDicEntryC( ID_ARENA_MARK, "ARENA-MARK", 0 );
+    CreateDicEntryC( ID_ARENA_RELEASE, "ARENA-RELEASE", 0 );
+    CreateDicEntryC( ID_ARENA_RESET, "ARENA-RESET", 0 );
     CreateDicEntryC( ID_ARSHIFT, "ARSHIFT", 0 );
     CreateDicEntryC( ID_AND, "AND", 0 );
     CreateDicEntryC( ID_BAIL, "BAIL", 0 );
     CreateDicEntryC( ID_BRANCH, "BRANCH", 0 );
     CreateDicEntryC( ID_BODY_OFFSET, "BODY_OFFSET", 0 );
+    CreateDicEntryC( ID_BUFFER_P, "(BUFFER)", 0 );
+    CreateDicEntryC( ID_BUFFER_COLON_P, "(BUFFER:)", 0 );
     CreateDicEntryC( ID_BYE, "BYE", 0 );
     CreateDicEntryC( ID_CATCH, "CATCH", 0 );
     CreateDicEntryC( ID_CELL, "CELL", 0 );
     CreateDicEntryC( ID_CELLS, "CELLS", 0 );
+    CreateDicEntryC( ID_CHANNEL, "CHANNEL", 0 );
     CreateDicEntryC( ID_CFETCH, "C@", 0 );
     CreateDicEntryC( ID_CMOVE, "CMOVE", 0 );
     CreateDicEntryC( ID_CMOVE_UP, "CMOVE>", 0 );
@@ -226,6 +270,10 @@ PForthDictionary pfBuildDictionary( cell_t HeaderSize, cell_t CodeSize )
     CreateDicEntryC( ID_D_MINUS, "D-", 0 );
     CreateDicEntryC( ID_D_UMSMOD, "UM/MOD", 0 );
     CreateDicEntryC( ID_D_MUSMOD, "MU/MOD", 0 );
+    CreateDicEntryC( ID_D_MUSMOD, "UD/MOD", 0 );
+    CreateDicEntryC( ID_D_STAR, "D*", 0 );
+    CreateDicEntryC( ID_D_MSTARSLASH, "M*/", 0 );
+    CreateDicEntryC( ID_D_SLASHMOD, "D/MOD", 0 );
     CreateDicEntryC( ID_D_MTIMES, "M*", 0 );
     pfDebugMessage("pfBuildDictionary: added M*\n");
     CreateDicEntryC( ID_D_UMTIMES, "UM*", 0 );
@@ -257,8 +305,13 @@ PForthDictionary pfBuildDictionary( cell_t HeaderSize, cell_t CodeSize )
     CreateDicEntryC( ID_FILE_OPEN, "OPEN-FILE",  0 );
     CreateDicEntryC( ID_FILE_CLOSE, "CLOSE-FILE",  0 );
     CreateDicEntryC( ID_FILE_READ, "READ-FILE",  0 );
+    CreateDicEntryC( ID_FILE_READ_ASYNC, "READ-FILE-ASYNC",  0 );
     CreateDicEntryC( ID_FILE_SIZE, "FILE-SIZE",  0 );
+    CreateDicEntryC( ID_FILE_MAP, "MAP-FILE",  0 );
+    CreateDicEntryC( ID_FILE_UNMAP, "UNMAP-FILE",  0 );
+    CreateDicEntryC( ID_FILE_SYNC_MAPPED, "SYNC-MAPPED",  0 );
     CreateDicEntryC( ID_FILE_WRITE, "WRITE-FILE",  0 );
+    CreateDicEntryC( ID_FILE_WRITE_ASYNC, "WRITE-FILE-ASYNC",  0 );
     CreateDicEntryC( ID_FILE_POSITION, "FILE-POSITION",  0 );
     CreateDicEntryC( ID_FILE_REPOSITION, "REPOSITION-FILE",  0 );
     CreateDicEntryC( ID_FILE_FLUSH, "FLUSH-FILE",  0 );
@@ -272,11 +325,23 @@ PForthDictionary pfBuildDictionary( cell_t HeaderSize, cell_t CodeSize )
     CreateDicEntryC( ID_FLUSHEMIT, "FLUSHEMIT",  0 );
     CreateDicEntryC( ID_FREE, "FREE",  0 );
 #include "pfcompfp.h"
+    CreateDicEntryC( ID_HANDLE_TO_ADDR, "HANDLE>ADDR",  0 );
+    CreateDicEntryC( ID_HEAP_DUMP, "HEAP-DUMP",  0 );
+    CreateDicEntryC( ID_HEAP_LEAKS, "HEAP-LEAKS",  0 );
+    CreateDicEntryC( ID_HEAP_STATS, "HEAP-STATS",  0 );
+    CreateDicEntryC( ID_VAR_HEAP_TRACK, "HEAP-TRACK",  0 );
     CreateDicEntryC( ID_HERE, "HERE",  0 );
+    CreateDicEntryC( ID_ALLOT, "ALLOT",  0 );
+    CreateDicEntryC( ID_ALIGN, "ALIGN",  0 );
+    CreateDicEntryC( ID_COMMA, ",",  0 );
+    CreateDicEntryC( ID_C_COMMA, "C,",  0 );
+    CreateDicEntryC( ID_W_COMMA, "W,",  0 );
     CreateDicEntryC( ID_NUMBERQ_P, "(SNUMBER?)",  0 );
     CreateDicEntryC( ID_I, "I",  0 );
     CreateDicEntryC( ID_INTERPRET, "INTERPRET", 0 );
+    CreateDicEntryC( ID_JOIN_THREAD, "JOIN-THREAD", 0 );
     CreateDicEntryC( ID_J, "J",  0 );
+    CreateDicEntryC( ID_INCLUDE_CACHE, "INCLUDE-CACHE",  0 );
     CreateDicEntryC( ID_INCLUDE_FILE, "INCLUDE-FILE",  0 );
     CreateDicEntryC( ID_KEY, "KEY",  0 );
     CreateDicEntryC( ID_LEAVE_P, "(LEAVE)", 0 );
@@ -317,7 +382,24 @@ PForthDictionary pfBuildDictionary( cell_t HeaderSize, cell_t CodeSize )
     CreateDicEntryC( ID_OR, "OR", 0 );
     CreateDicEntryC( ID_OVER, "OVER", 0 );
     pfDebugMessage("pfBuildDictionary: added OVER\n");
+    CreateDicEntryC( ID_PAD, "PAD",  0 );
+    CreateDicEntryC( ID_PAR_DO, "PAR-DO",  0 );
+    CreateDicEntryC( ID_PAR_MAP, "PAR-MAP",  0 );
+    CreateDicEntryC( ID_VAR_PAR_GRAIN, "PAR-GRAIN",  0 );
+    CreateDicEntryC( ID_PAUSE, "PAUSE",  0 );
+    CreateDicEntryC( ID_PHEAP_ABS, "PHEAP-ABS",  0 );
+    CreateDicEntryC( ID_VAR_PHEAP_ACTIVE, "PHEAP-ACTIVE",  0 );
+    CreateDicEntryC( ID_PHEAP_CLOSE, "PHEAP-CLOSE",  0 );
+    CreateDicEntryC( ID_PHEAP_OPEN, "PHEAP-OPEN",  0 );
+    CreateDicEntryC( ID_PHEAP_REL, "PHEAP-REL",  0 );
+    CreateDicEntryC( ID_PHEAP_ROOT_FETCH, "PHEAP-ROOT@",  0 );
+    CreateDicEntryC( ID_PHEAP_ROOT_STORE, "PHEAP-ROOT!",  0 );
+    CreateDicEntryC( ID_PHEAP_SYNC, "PHEAP-SYNC",  0 );
     CreateDicEntryC( ID_PICK, "PICK",  0 );
+    CreateDicEntryC( ID_POOL, "POOL",  0 );
+    CreateDicEntryC( ID_POOL_EACH, "POOL-EACH",  0 );
+    CreateDicEntryC( ID_POOL_GET, "POOL-GET",  0 );
+    CreateDicEntryC( ID_POOL_PUT, "POOL-PUT",  0 );
     CreateDicEntryC( ID_PLUS, "+",  0 );
     CreateDicEntryC( ID_PLUSLOOP_P, "(+LOOP)", 0 );
     CreateDicEntryC( ID_PLUS_STORE, "+!",  0 );
@@ -328,6 +410,8 @@ PForthDictionary pfBuildDictionary( cell_t HeaderSize, cell_t CodeSize )
     CreateDicEntryC( ID_QTERMINAL, "?TERMINAL",  0 );
     CreateDicEntryC( ID_QTERMINAL, "KEY?",  0 );
     CreateDicEntryC( ID_REFILL, "REFILL",  0 );
+    CreateDicEntryC( ID_REQ_DONEQ, "REQ-DONE?",  0 );
+    CreateDicEntryC( ID_REQ_WAIT, "REQ-WAIT",  0 );
     CreateDicEntryC( ID_RESIZE, "RESIZE",  0 );
     CreateDicEntryC( ID_ROLL, "ROLL",  0 );
     CreateDicEntryC( ID_ROT, "ROT",  0 );
@@ -342,9 +426,11 @@ PForthDictionary pfBuildDictionary( cell_t HeaderSize, cell_t CodeSize )
     CreateDicEntryC( ID_SP_STORE, "SP!",  0 );
     CreateDicEntryC( ID_STORE, "!",  0 );
     CreateDicEntryC( ID_SAVE_FORTH_P, "(SAVE-FORTH)",  0 );
+    CreateDicEntryC( ID_SAVE_DELTA_P, "(SAVE-DELTA)",  0 );
     CreateDicEntryC( ID_SCAN, "SCAN",  0 );
     CreateDicEntryC( ID_SKIP, "SKIP",  0 );
     CreateDicEntryC( ID_SLEEP_P, "(SLEEP)", 0 );
+    CreateDicEntryC( ID_UTIME, "UTIME", 0 );
     CreateDicEntryC( ID_SOURCE, "SOURCE",  0 );
     CreateDicEntryC( ID_SOURCE_SET, "SET-SOURCE",  0 );
     CreateDicEntryC( ID_SOURCE_ID, "SOURCE-ID",  0 );
@@ -353,23 +439,35 @@ PForthDictionary pfBuildDictionary( cell_t HeaderSize, cell_t CodeSize )
     CreateDicEntryC( ID_SOURCE_LINE_NUMBER_FETCH, "SOURCE-LINE-NUMBER@",  0 );
     CreateDicEntryC( ID_SOURCE_LINE_NUMBER_STORE, "SOURCE-LINE-NUMBER!",  0 );
     CreateDicEntryC( ID_SWAP, "SWAP",  0 );
+    CreateDicEntryC( ID_TASK_CREATE, "(TASK)",  0 );
+    CreateDicEntryC( ID_TASK_SLEEP, "SLEEP",  0 );
+    CreateDicEntryC( ID_TASK_WAKE, "WAKE",  0 );
+    CreateDicEntryC( ID_THREAD, "THREAD",  0 );
     CreateDicEntryC( ID_TEST1, "TEST1",  0 );
     CreateDicEntryC( ID_TEST2, "TEST2",  0 );
     CreateDicEntryC( ID_TICK, "'", 0 );
     CreateDicEntryC( ID_TIMES, "*", 0 );
     CreateDicEntryC( ID_THROW, "THROW", 0 );
     CreateDicEntryC( ID_TO_R, ">R", 0 );
+    CreateDicEntryC( ID_TO_ZSTRING, ">ZSTRING", 0 );
+    CreateDicEntryC( ID_TRY_RECV, "TRY-RECV", 0 );
+    CreateDicEntryC( ID_TRY_RECV_N, "TRY-RECV-N", 0 );
+    CreateDicEntryC( ID_TRY_SEND, "TRY-SEND", 0 );
+    CreateDicEntryC( ID_TRY_SEND_N, "TRY-SEND-N", 0 );
     CreateDicEntryC( ID_TYPE, "TYPE", 0 );
     CreateDicEntryC( ID_VAR_BASE, "BASE", 0 );
+    CreateDicEntryC( ID_VAR_BATCH, "BATCH", 0 );
     CreateDicEntryC( ID_VAR_BYE_CODE, "BYE-CODE", 0 );
     CreateDicEntryC( ID_VAR_CODE_BASE, "CODE-BASE", 0 );
     CreateDicEntryC( ID_VAR_CODE_LIMIT, "CODE-LIMIT", 0 );
     CreateDicEntryC( ID_VAR_CONTEXT, "CONTEXT", 0 );
+    CreateDicEntryC( ID_VAR_DIC_COMPRESS, "DIC-COMPRESS", 0 );
     CreateDicEntryC( ID_VAR_DP, "DP", 0 );
     CreateDicEntryC( ID_VAR_ECHO, "ECHO", 0 );
     CreateDicEntryC( ID_VAR_HEADERS_PTR, "HEADERS-PTR", 0 );
     CreateDicEntryC( ID_VAR_HEADERS_BASE, "HEADERS-BASE", 0 );
     CreateDicEntryC( ID_VAR_HEADERS_LIMIT, "HEADERS-LIMIT", 0 );
+    CreateDicEntryC( ID_VAR_HLD, "HLD", 0 );
     CreateDicEntryC( ID_VAR_NUM_TIB, "#TIB", 0 );
     CreateDicEntryC( ID_VAR_RETURN_CODE, "RETURN-CODE", 0 );
     CreateDicEntryC( ID_VAR_TRACE_FLAGS, "TRACE-FLAGS", 0 );
@@ -379,14 +477,17 @@ PForthDictionary pfBuildDictionary( cell_t HeaderSize, cell_t CodeSize )
     CreateDicEntryC( ID_VAR_STATE, "STATE", 0 );
     CreateDicEntryC( ID_VAR_TO_IN, ">IN", 0 );
     CreateDicEntryC( ID_VERSION_CODE, "VERSION_CODE", 0 );
+    CreateDicEntryC( ID_WAIT_FRAMES, "WAIT-FRAMES", 0 );
     CreateDicEntryC( ID_WORD, "WORD", 0 );
     CreateDicEntryC( ID_WORD_FETCH, "W@", 0 );
     CreateDicEntryC( ID_WORD_STORE, "W!", 0 );
     CreateDicEntryC( ID_XOR, "XOR", 0 );
     CreateDicEntryC( ID_ZERO_BRANCH, "0BRANCH", 0 );
 
-    /* Add the raylib words */
-    ADD_RAYLIB_WORDS_TO_DICTIONARY
+/* raylib words and constants, see "mkraylib.c". */
+#define PF_RAYLIB_ENTRIES
+#include "pf_raylib_api.h"
+#undef PF_RAYLIB_ENTRIES
 
     pfDebugMessage("pfBuildDictionary: FindSpecialXTs\n");
     if( FindSpecialXTs() < 0 ) goto error;
@@ -466,6 +567,7 @@ cell_t ffFindNFA( const ForthString *WordName, const ForthString **NFAPtr )
     WordLen = (uint8_t) ((ucell_t)*WordName & 0x1F);
     WordChar = WordName+1;
 
+    pfLockDictionary();  /* Do not read a header while it is being written. */
     NameField = (ForthString *) gVarContext;
 DBUG(("\nffFindNFA: WordLen = %d, WordName = %*s\n", WordLen, WordLen, WordChar ));
 DBUG(("\nffFindNFA: gVarContext = 0x%x\n", gVarContext));
@@ -493,6 +595,7 @@ DBUG(("ffFindNFA: found it at NFA = 0x%x\n", NameField));
             }
         }
     } while ( Searching);
+    pfUnlockDictionary();
 DBUG(("ffFindNFA: returns 0x%x\n", Result));
     return Result;
 }
@@ -582,6 +685,7 @@ void ffCreateSecondaryHeader( const ForthStringPtr FName)
 */
 static void ffStringColon( const ForthStringPtr FName)
 {
+    pfLockDictionary();  /* Unlocked by ffSemiColon() */
     ffCreateSecondaryHeader( FName );
     gVarState = 1;
 }
@@ -621,11 +725,13 @@ static cell_t CheckRedefinition( const ForthStringPtr FName )
 
 void ffStringCreate( char *FName)
 {
+    pfLockDictionary();
     ffCreateSecondaryHeader( FName );
 
     CODE_COMMA( ID_CREATE_P );
     CODE_COMMA( ID_EXIT );
     ffFinishSecondary();
+    pfUnlockDictionary();
 
 }
 
@@ -644,12 +750,14 @@ void ffCreate( void )
 void ffStringDefer( const ForthStringPtr FName, ExecToken DefaultXT )
 {
     pfDebugMessage("ffStringDefer()\n");
+    pfLockDictionary();
     ffCreateSecondaryHeader( FName );
 
     CODE_COMMA( ID_DEFER_P );
     CODE_COMMA( DefaultXT );
 
     ffFinishSecondary();
+    pfUnlockDictionary();
 
 }
 #ifndef PF_NO_INIT
@@ -660,6 +768,18 @@ static void CreateDeferredC( ExecToken DefaultXT, const char *CName )
     CStringToForth( FName, CName, sizeof(FName) );
     ffStringDefer( FName, DefaultXT );
 }
+
+/* Convert name then create a word that returns Value, like CONSTANT. */
+static void CreateConstantC( const char *CName, cell_t Value )
+{
+    char FName[40];
+    CStringToForth( FName, CName, sizeof(FName) );
+    pfLockDictionary();
+    ffCreateSecondaryHeader( FName );
+    ffLiteral( Value );
+    ffFinishSecondary();
+    pfUnlockDictionary();
+}
 #endif
 
 /* Read the next token from the Source and create a word. */
@@ -696,6 +816,7 @@ ThrowCode ffSemiColon( void )
         ffFinishSecondary();
     }
     gDepthAtColon = DEPTH_AT_COLON_INVALID;
+    pfUnlockDictionary();
     return exception;
 }
 
@@ -887,7 +1008,7 @@ ThrowCode ffOK( void )
         exception = THROW_FLOAT_STACK_UNDERFLOW;
     }
 #endif
-    else if( gCurrentTask->td_InputStream == PF_STDIN)
+    else if( (gCurrentTask->td_InputStream == PF_STDIN) && !gBatchMode )
     {
         if( !gVarState )  /* executing? */
         {
@@ -947,14 +1068,23 @@ ThrowCode ffOuterInterpreterLoop( void )
 ThrowCode ffIncludeFile( FileStream *InputFile )
 {
     ThrowCode exception;
+    IncludeCacheState Cache;
 
 /* Push file stream. */
     exception = ffPushInputStream( InputFile );
     if( exception < 0 ) return exception;
 
-/* Run outer interpreter for stream. */
-    exception = ffOuterInterpreterLoop();
-    if( exception )
+/* Load from the include cache, or run outer interpreter for stream. */
+    if( ffBeginCachedInclude( InputFile, &Cache ) > 0 )
+    {
+        exception = 0;
+    }
+    else
+    {
+        exception = ffOuterInterpreterLoop();
+    }
+    ffEndCachedInclude( &Cache, exception );
+    if( exception && (exception != THROW_BYE) )
     {
         int i;
 /* Report line number and nesting level. */
@@ -998,11 +1128,17 @@ Err ffPushInputStream( FileStream *InputFile )
     {
         inf = &gIncludeStack[gIncludeIndex++];
         inf->inf_FileID = gCurrentTask->td_InputStream;
+        inf->inf_SourcePtr = gCurrentTask->td_SourcePtr;
         inf->inf_IN = gCurrentTask->td_IN;
         inf->inf_LineNumber = gCurrentTask->td_LineNumber;
         inf->inf_SourceNum = gCurrentTask->td_SourceNum;
-/* Copy TIB plus any NUL terminator into saved area. */
-        if( (inf->inf_SourceNum > 0) && (inf->inf_SourceNum < (TIB_SIZE-1)) )
+/* Copy TIB plus any NUL terminator into saved area.
+** During EVALUATE the TIB holds a longer line than SOURCE so save all of it. */
+        if( gCurrentTask->td_SourcePtr != &gCurrentTask->td_TIB[0] )
+        {
+            pfCopyMemory( inf->inf_SaveTIB, gCurrentTask->td_TIB, TIB_SIZE );
+        }
+        else if( (inf->inf_SourceNum > 0) && (inf->inf_SourceNum < (TIB_SIZE-1)) )
         {
             pfCopyMemory( inf->inf_SaveTIB, gCurrentTask->td_TIB, inf->inf_SourceNum+1 );
         }
@@ -1010,6 +1146,8 @@ Err ffPushInputStream( FileStream *InputFile )
 /* Set new current input. */
         DBUG(( "ffPushInputStream: InputFile = 0x%x\n", InputFile ));
         gCurrentTask->td_InputStream = InputFile;
+/* Files are read into the TIB. EVALUATE pushes NULL after setting SOURCE. */
+        if( InputFile != NULL ) gCurrentTask->td_SourcePtr = &gCurrentTask->td_TIB[0];
         gCurrentTask->td_LineNumber = 0;
     }
     else
@@ -1039,12 +1177,17 @@ DBUG(("ffPopInputStream: gIncludeIndex = %d\n", gIncludeIndex));
     {
         inf = &gIncludeStack[--gIncludeIndex];
         gCurrentTask->td_InputStream = inf->inf_FileID;
+        gCurrentTask->td_SourcePtr = inf->inf_SourcePtr;
         DBUG(("ffPopInputStream: stream = 0x%x\n", gCurrentTask->td_InputStream ));
         gCurrentTask->td_IN = inf->inf_IN;
         gCurrentTask->td_LineNumber = inf->inf_LineNumber;
         gCurrentTask->td_SourceNum = inf->inf_SourceNum;
 /* Copy TIB plus any NUL terminator into saved area. */
-        if( (inf->inf_SourceNum > 0) && (inf->inf_SourceNum < (TIB_SIZE-1)) )
+        if( gCurrentTask->td_SourcePtr != &gCurrentTask->td_TIB[0] )
+        {
+            pfCopyMemory( gCurrentTask->td_TIB, inf->inf_SaveTIB, TIB_SIZE );
+        }
+        else if( (inf->inf_SourceNum > 0) && (inf->inf_SourceNum < (TIB_SIZE-1)) )
         {
             pfCopyMemory( gCurrentTask->td_TIB, inf->inf_SaveTIB, inf->inf_SourceNum+1 );
         }
@@ -1103,15 +1246,15 @@ FileStream * ffConvertSourceIDToStream( cell_t id )
 ** Return length, or -1 for EOF.
 */
 #define BACKSPACE  (8)
-static cell_t readLineFromStream( char *buffer, cell_t maxChars, FileStream *stream )
+cell_t ffReadLine( char *buffer, cell_t maxChars, FileStream *stream )
 {
     int   c;
     int   len;
     char *p;
-    static int lastChar = 0;
+    static PF_THREAD_LOCAL int lastChar = 0;
     int   done = 0;
 
-DBUGX(("readLineFromStream(0x%x, 0x%x, 0x%x)\n", buffer, len, stream ));
+DBUGX(("ffReadLine(0x%x, 0x%x, 0x%x)\n", buffer, len, stream ));
     p = buffer;
     len = 0;
     while( (len < maxChars) && !done )
@@ -1158,11 +1301,14 @@ cell_t ffRefill( void )
     cell_t Num;
     cell_t Result = 1;
 
+/* Nothing more to read during EVALUATE. */
+    if( gCurrentTask->td_InputStream == NULL ) return 0;
+
 /* reset >IN for parser */
     gCurrentTask->td_IN = 0;
 
-/* get line from current stream */
-    if( gCurrentTask->td_InputStream == PF_STDIN )
+/* get line from current stream, in batch mode stdin is read like a file */
+    if( (gCurrentTask->td_InputStream == PF_STDIN) && !gBatchMode )
     {
     /* ACCEPT is deferred so we call it through the dictionary. */
         ThrowCode throwCode;
@@ -1182,7 +1328,7 @@ cell_t ffRefill( void )
     }
     else
     {
-        Num = readLineFromStream( gCurrentTask->td_SourcePtr, TIB_SIZE,
+        Num = ffReadLine( gCurrentTask->td_SourcePtr, TIB_SIZE,
             gCurrentTask->td_InputStream );
         if( Num == EOF )
         {
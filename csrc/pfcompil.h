@@ -36,6 +36,7 @@ cell_t  ffFind( const ForthString *WordName, ExecToken *pXT );
 cell_t  ffFindC( const char *WordName, ExecToken *pXT );
 cell_t  ffFindNFA( const ForthString *WordName, const ForthString **NFAPtr );
 cell_t  ffNumberQ( const char *FWord, cell_t *Num );
+cell_t  ffReadLine( char *buffer, cell_t maxChars, FileStream *stream );
 cell_t  ffRefill( void );
 cell_t  ffTokenToName( ExecToken XT, const ForthString **NFAPtr );
 cell_t *NameToCode( ForthString *NFA );
@@ -66,6 +67,17 @@ ThrowCode ffInterpret( void );
 ThrowCode ffOuterInterpreterLoop( void );
 ThrowCode ffIncludeFile( FileStream *InputFile );
 
+/* Only one thread may compile at a time. */
+#ifdef PF_SUPPORT_THREADS
+void pfLockDictionary( void );
+void pfUnlockDictionary( void );
+void pfReleaseDictionary( void );
+#else
+#define pfLockDictionary()    /* noop */
+#define pfUnlockDictionary()  /* noop */
+#define pfReleaseDictionary() /* noop */
+#endif
+
 #ifdef PF_SUPPORT_FP
 void ffFPLiteral( PF_FLOAT fnum );
 #endif
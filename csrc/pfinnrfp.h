@@ -52,7 +52,7 @@
         break;
 
     case ID_FP_FSTORE: /* ( addr -- ) ( F: r -- ) */
-#if (defined(PF_BIG_ENDIAN_DIC) || defined(PF_LITTLE_ENDIAN_DIC))
+#ifdef PF_DIC_CONVERT
         if( IN_CODE_DIC(TOS) )
         {
             WRITE_FLOAT_DIC( (PF_FLOAT *) TOS, FP_TOS );
@@ -140,7 +140,7 @@
 
     case ID_FP_FFETCH:  /* ( addr -- ) ( F: -- r ) */
         PUSH_FP_TOS;
-#if (defined(PF_BIG_ENDIAN_DIC) || defined(PF_LITTLE_ENDIAN_DIC))
+#ifdef PF_DIC_CONVERT
         if( IN_CODE_DIC(TOS) )
         {
             FP_TOS = READ_FLOAT_DIC( (PF_FLOAT *) TOS );
@@ -339,5 +339,329 @@
         M_DROP;
         break;
 
+/* Typed array words. The loops are in "pf_array.c".
+** DFV arrays hold PF_FLOATs, SFV arrays hold 32-bit floats and IV arrays hold 32-bit integers.
+*/
+    case ID_FP_DFV_PLUS: /* ( a b dst n -- ) */
+        Scratch = M_POP; /* dst */
+        Temp = M_POP; /* b */
+        pfArrayOpDF( PF_ARRAY_ADD, (const PF_FLOAT *) M_POP, (const PF_FLOAT *) Temp, (PF_FLOAT *) Scratch, TOS );
+        M_DROP;
+        break;
+
+    case ID_FP_DFV_MINUS: /* ( a b dst n -- ) */
+        Scratch = M_POP; /* dst */
+        Temp = M_POP; /* b */
+        pfArrayOpDF( PF_ARRAY_SUB, (const PF_FLOAT *) M_POP, (const PF_FLOAT *) Temp, (PF_FLOAT *) Scratch, TOS );
+        M_DROP;
+        break;
+
+    case ID_FP_DFV_TIMES: /* ( a b dst n -- ) */
+        Scratch = M_POP; /* dst */
+        Temp = M_POP; /* b */
+        pfArrayOpDF( PF_ARRAY_MUL, (const PF_FLOAT *) M_POP, (const PF_FLOAT *) Temp, (PF_FLOAT *) Scratch, TOS );
+        M_DROP;
+        break;
+
+    case ID_FP_DFV_PLUS_S: /* ( a dst n -- ) ( F: r -- ) */
+        Scratch = M_POP; /* dst */
+        pfArrayOpScalarDF( PF_ARRAY_ADD, (const PF_FLOAT *) M_POP, (PF_FLOAT) FP_TOS, (PF_FLOAT *) Scratch, TOS );
+        M_FP_DROP;
+        M_DROP;
+        break;
+
+    case ID_FP_DFV_MINUS_S: /* ( a dst n -- ) ( F: r -- ) */
+        Scratch = M_POP; /* dst */
+        pfArrayOpScalarDF( PF_ARRAY_SUB, (const PF_FLOAT *) M_POP, (PF_FLOAT) FP_TOS, (PF_FLOAT *) Scratch, TOS );
+        M_FP_DROP;
+        M_DROP;
+        break;
+
+    case ID_FP_DFV_TIMES_S: /* ( a dst n -- ) ( F: r -- ) */
+        Scratch = M_POP; /* dst */
+        pfArrayOpScalarDF( PF_ARRAY_MUL, (const PF_FLOAT *) M_POP, (PF_FLOAT) FP_TOS, (PF_FLOAT *) Scratch, TOS );
+        M_FP_DROP;
+        M_DROP;
+        break;
+
+    case ID_FP_DFV_FMA: /* ( a b c dst n -- ) */
+        Scratch = M_POP; /* dst */
+        Temp = M_POP; /* c */
+        CharPtr = (char *) M_POP; /* b */
+        pfArrayFmaDF( (const PF_FLOAT *) M_POP, (const PF_FLOAT *) CharPtr, (const PF_FLOAT *) Temp, (PF_FLOAT *) Scratch, TOS );
+        M_DROP;
+        break;
+
+    case ID_FP_DFV_FMA_S: /* ( a b dst n -- ) ( F: r -- ) */
+        Scratch = M_POP; /* dst */
+        Temp = M_POP; /* b */
+        pfArrayAxpyDF( (const PF_FLOAT *) M_POP, (PF_FLOAT) FP_TOS, (const PF_FLOAT *) Temp, (PF_FLOAT *) Scratch, TOS );
+        M_FP_DROP;
+        M_DROP;
+        break;
+
+    case ID_FP_DFV_DOT: /* ( a b n -- ) ( F: -- r ) */
+        Temp = M_POP; /* b */
+        fpScratch = pfArrayDotDF( (const PF_FLOAT *) M_POP, (const PF_FLOAT *) Temp, TOS );
+        M_DROP;
+        PUSH_FP_TOS;
+        FP_TOS = fpScratch;
+        break;
+
+    case ID_FP_DFV_SUM: /* ( a n -- ) ( F: -- r ) */
+        fpScratch = pfArraySumDF( (const PF_FLOAT *) M_POP, TOS );
+        M_DROP;
+        PUSH_FP_TOS;
+        FP_TOS = fpScratch;
+        break;
+
+    case ID_FP_DFV_MIN: /* ( a n -- ) ( F: -- r ) */
+        fpScratch = pfArrayMinDF( (const PF_FLOAT *) M_POP, TOS );
+        M_DROP;
+        PUSH_FP_TOS;
+        FP_TOS = fpScratch;
+        break;
+
+    case ID_FP_DFV_MAX: /* ( a n -- ) ( F: -- r ) */
+        fpScratch = pfArrayMaxDF( (const PF_FLOAT *) M_POP, TOS );
+        M_DROP;
+        PUSH_FP_TOS;
+        FP_TOS = fpScratch;
+        break;
+
+    case ID_FP_DFV_CLAMP: /* ( a dst n -- ) ( F: lo hi -- ) */
+        Scratch = M_POP; /* dst */
+        fpTemp = M_FP_POP; /* lo */
+        pfArrayClampDF( (const PF_FLOAT *) M_POP, (PF_FLOAT) fpTemp, (PF_FLOAT) FP_TOS, (PF_FLOAT *) Scratch, TOS );
+        M_FP_DROP;
+        M_DROP;
+        break;
+
+    case ID_FP_SFV_PLUS: /* ( a b dst n -- ) */
+        Scratch = M_POP; /* dst */
+        Temp = M_POP; /* b */
+        pfArrayOpSF( PF_ARRAY_ADD, (const float *) M_POP, (const float *) Temp, (float *) Scratch, TOS );
+        M_DROP;
+        break;
+
+    case ID_FP_SFV_MINUS: /* ( a b dst n -- ) */
+        Scratch = M_POP; /* dst */
+        Temp = M_POP; /* b */
+        pfArrayOpSF( PF_ARRAY_SUB, (const float *) M_POP, (const float *) Temp, (float *) Scratch, TOS );
+        M_DROP;
+        break;
+
+    case ID_FP_SFV_TIMES: /* ( a b dst n -- ) */
+        Scratch = M_POP; /* dst */
+        Temp = M_POP; /* b */
+        pfArrayOpSF( PF_ARRAY_MUL, (const float *) M_POP, (const float *) Temp, (float *) Scratch, TOS );
+        M_DROP;
+        break;
+
+    case ID_FP_SFV_PLUS_S: /* ( a dst n -- ) ( F: r -- ) */
+        Scratch = M_POP; /* dst */
+        pfArrayOpScalarSF( PF_ARRAY_ADD, (const float *) M_POP, (float) FP_TOS, (float *) Scratch, TOS );
+        M_FP_DROP;
+        M_DROP;
+        break;
+
+    case ID_FP_SFV_MINUS_S: /* ( a dst n -- ) ( F: r -- ) */
+        Scratch = M_POP; /* dst */
+        pfArrayOpScalarSF( PF_ARRAY_SUB, (const float *) M_POP, (float) FP_TOS, (float *) Scratch, TOS );
+        M_FP_DROP;
+        M_DROP;
+        break;
+
+    case ID_FP_SFV_TIMES_S: /* ( a dst n -- ) ( F: r -- ) */
+        Scratch = M_POP; /* dst */
+        pfArrayOpScalarSF( PF_ARRAY_MUL, (const float *) M_POP, (float) FP_TOS, (float *) Scratch, TOS );
+        M_FP_DROP;
+        M_DROP;
+        break;
+
+    case ID_FP_SFV_FMA: /* ( a b c dst n -- ) */
+        Scratch = M_POP; /* dst */
+        Temp = M_POP; /* c */
+        CharPtr = (char *) M_POP; /* b */
+        pfArrayFmaSF( (const float *) M_POP, (const float *) CharPtr, (const float *) Temp, (float *) Scratch, TOS );
+        M_DROP;
+        break;
+
+    case ID_FP_SFV_FMA_S: /* ( a b dst n -- ) ( F: r -- ) */
+        Scratch = M_POP; /* dst */
+        Temp = M_POP; /* b */
+        pfArrayAxpySF( (const float *) M_POP, (float) FP_TOS, (const float *) Temp, (float *) Scratch, TOS );
+        M_FP_DROP;
+        M_DROP;
+        break;
+
+    case ID_FP_SFV_DOT: /* ( a b n -- ) ( F: -- r ) */
+        Temp = M_POP; /* b */
+        fpScratch = pfArrayDotSF( (const float *) M_POP, (const float *) Temp, TOS );
+        M_DROP;
+        PUSH_FP_TOS;
+        FP_TOS = fpScratch;
+        break;
+
+    case ID_FP_SFV_SUM: /* ( a n -- ) ( F: -- r ) */
+        fpScratch = pfArraySumSF( (const float *) M_POP, TOS );
+        M_DROP;
+        PUSH_FP_TOS;
+        FP_TOS = fpScratch;
+        break;
+
+    case ID_FP_SFV_MIN: /* ( a n -- ) ( F: -- r ) */
+        fpScratch = pfArrayMinSF( (const float *) M_POP, TOS );
+        M_DROP;
+        PUSH_FP_TOS;
+        FP_TOS = fpScratch;
+        break;
+
+    case ID_FP_SFV_MAX: /* ( a n -- ) ( F: -- r ) */
+        fpScratch = pfArrayMaxSF( (const float *) M_POP, TOS );
+        M_DROP;
+        PUSH_FP_TOS;
+        FP_TOS = fpScratch;
+        break;
+
+    case ID_FP_SFV_CLAMP: /* ( a dst n -- ) ( F: lo hi -- ) */
+        Scratch = M_POP; /* dst */
+        fpTemp = M_FP_POP; /* lo */
+        pfArrayClampSF( (const float *) M_POP, (float) fpTemp, (float) FP_TOS, (float *) Scratch, TOS );
+        M_FP_DROP;
+        M_DROP;
+        break;
+
+    case ID_FP_IV_PLUS: /* ( a b dst n -- ) */
+        Scratch = M_POP; /* dst */
+        Temp = M_POP; /* b */
+        pfArrayOpI32( PF_ARRAY_ADD, (const int32_t *) M_POP, (const int32_t *) Temp, (int32_t *) Scratch, TOS );
+        M_DROP;
+        break;
+
+    case ID_FP_IV_MINUS: /* ( a b dst n -- ) */
+        Scratch = M_POP; /* dst */
+        Temp = M_POP; /* b */
+        pfArrayOpI32( PF_ARRAY_SUB, (const int32_t *) M_POP, (const int32_t *) Temp, (int32_t *) Scratch, TOS );
+        M_DROP;
+        break;
+
+    case ID_FP_IV_TIMES: /* ( a b dst n -- ) */
+        Scratch = M_POP; /* dst */
+        Temp = M_POP; /* b */
+        pfArrayOpI32( PF_ARRAY_MUL, (const int32_t *) M_POP, (const int32_t *) Temp, (int32_t *) Scratch, TOS );
+        M_DROP;
+        break;
+
+    case ID_FP_IV_PLUS_S: /* ( a dst n x -- ) */
+        Scratch = M_POP; /* n */
+        Temp = M_POP; /* dst */
+        pfArrayOpScalarI32( PF_ARRAY_ADD, (const int32_t *) M_POP, (int32_t) TOS, (int32_t *) Temp, Scratch );
+        M_DROP;
+        break;
+
+    case ID_FP_IV_MINUS_S: /* ( a dst n x -- ) */
+        Scratch = M_POP; /* n */
+        Temp = M_POP; /* dst */
+        pfArrayOpScalarI32( PF_ARRAY_SUB, (const int32_t *) M_POP, (int32_t) TOS, (int32_t *) Temp, Scratch );
+        M_DROP;
+        break;
+
+    case ID_FP_IV_TIMES_S: /* ( a dst n x -- ) */
+        Scratch = M_POP; /* n */
+        Temp = M_POP; /* dst */
+        pfArrayOpScalarI32( PF_ARRAY_MUL, (const int32_t *) M_POP, (int32_t) TOS, (int32_t *) Temp, Scratch );
+        M_DROP;
+        break;
+
+    case ID_FP_IV_FMA: /* ( a b c dst n -- ) */
+        Scratch = M_POP; /* dst */
+        Temp = M_POP; /* c */
+        CharPtr = (char *) M_POP; /* b */
+        pfArrayFmaI32( (const int32_t *) M_POP, (const int32_t *) CharPtr, (const int32_t *) Temp, (int32_t *) Scratch, TOS );
+        M_DROP;
+        break;
+
+    case ID_FP_IV_FMA_S: /* ( a b dst n x -- ) */
+        Scratch = M_POP; /* n */
+        Temp = M_POP; /* dst */
+        CharPtr = (char *) M_POP; /* b */
+        pfArrayAxpyI32( (const int32_t *) M_POP, (int32_t) TOS, (const int32_t *) CharPtr, (int32_t *) Temp, Scratch );
+        M_DROP;
+        break;
+
+    case ID_FP_IV_DOT: /* ( a b n -- x ) */
+        Temp = M_POP; /* b */
+        TOS = pfArrayDotI32( (const int32_t *) M_POP, (const int32_t *) Temp, TOS );
+        break;
+
+    case ID_FP_IV_SUM: /* ( a n -- x ) */
+        TOS = pfArraySumI32( (const int32_t *) M_POP, TOS );
+        break;
+
+    case ID_FP_IV_MIN: /* ( a n -- x ) */
+        TOS = pfArrayMinI32( (const int32_t *) M_POP, TOS );
+        break;
+
+    case ID_FP_IV_MAX: /* ( a n -- x ) */
+        TOS = pfArrayMaxI32( (const int32_t *) M_POP, TOS );
+        break;
+
+    case ID_FP_IV_CLAMP: /* ( a dst n lo hi -- ) */
+        Temp = M_POP; /* lo */
+        Scratch = M_POP; /* n */
+        CellPtr = (cell_t *) M_POP; /* dst */
+        pfArrayClampI32( (const int32_t *) M_POP, (int32_t) Temp, (int32_t) TOS, (int32_t *) CellPtr, Scratch );
+        M_DROP;
+        break;
+
+    case ID_FP_CELLS_TO_DFV: /* ( src dst n -- ) */
+        Scratch = M_POP; /* dst */
+        pfArrayCellsToDF( (const cell_t *) M_POP, (PF_FLOAT *) Scratch, TOS );
+        M_DROP;
+        break;
+
+    case ID_FP_DFV_TO_CELLS: /* ( src dst n -- ) */
+        Scratch = M_POP; /* dst */
+        pfArrayDFToCells( (const PF_FLOAT *) M_POP, (cell_t *) Scratch, TOS );
+        M_DROP;
+        break;
+
+    case ID_FP_CELLS_TO_SFV: /* ( src dst n -- ) */
+        Scratch = M_POP; /* dst */
+        pfArrayCellsToSF( (const cell_t *) M_POP, (float *) Scratch, TOS );
+        M_DROP;
+        break;
+
+    case ID_FP_SFV_TO_CELLS: /* ( src dst n -- ) */
+        Scratch = M_POP; /* dst */
+        pfArraySFToCells( (const float *) M_POP, (cell_t *) Scratch, TOS );
+        M_DROP;
+        break;
+
+    case ID_FP_CELLS_TO_IV: /* ( src dst n -- ) */
+        Scratch = M_POP; /* dst */
+        pfArrayCellsToI32( (const cell_t *) M_POP, (int32_t *) Scratch, TOS );
+        M_DROP;
+        break;
+
+    case ID_FP_IV_TO_CELLS: /* ( src dst n -- ) */
+        Scratch = M_POP; /* dst */
+        pfArrayI32ToCells( (const int32_t *) M_POP, (cell_t *) Scratch, TOS );
+        M_DROP;
+        break;
+
+    case ID_FP_SFV_TO_DFV: /* ( src dst n -- ) */
+        Scratch = M_POP; /* dst */
+        pfArraySFToDF( (const float *) M_POP, (PF_FLOAT *) Scratch, TOS );
+        M_DROP;
+        break;
+
+    case ID_FP_DFV_TO_SFV: /* ( src dst n -- ) */
+        Scratch = M_POP; /* dst */
+        pfArrayDFToSF( (const PF_FLOAT *) M_POP, (float *) Scratch, TOS );
+        M_DROP;
+        break;
+
 
 #endif
@@ -51,6 +51,15 @@ void  pfSetQuiet( cell_t IfQuiet );
 /* Query message status. */
 cell_t  pfQueryQuiet( void );
 
+/* Batch mode for running as a filter. No terminal setup or prompts.
+** Stdin is read a line at a time like a file and Forth stops at the
+** end of it, or at the first uncaught error. */
+void  pfSetBatch( cell_t IfBatch );
+
+/* Interpret this line after the source file, eg. from -e on the command line.
+** The string is not copied. Returns -1 if there are too many lines. */
+cell_t  pfAddEvaluate( const char *Line );
+
 /* Send a message using low level I/O of pForth */
 void  pfMessage( const char *CString );
 
@@ -30,11 +30,19 @@
 
 #include <unistd.h>
 #include <sys/time.h>
+#include <time.h>
 #ifdef sun
 #include <sys/int_types.h> /* Needed on Solaris for uint32_t in termio.h */
 #endif
 #include <termios.h>
 #include <sys/poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#ifdef PF_SUPPORT_THREADS
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 static struct termios save_termios;
 static int stdin_is_tty;
@@ -131,10 +139,8 @@ void sdTerminalInit(void)
         {
             perror("sdTerminalInit: tcsetattr");
         }
-        if (setvbuf(stdout, NULL, _IONBF, (size_t) 0) != 0)
-        {
-            perror("sdTerminalInit: setvbuf");
-        }
+/* Leave stdout buffered. ioFlush() calls sdTerminalFlush() before
+ * reading the keyboard so the prompt and echo still appear. */
     }
 }
 
@@ -166,3 +172,160 @@ cell_t sdSleepMillis(cell_t msec)
     }
     return 0;
 }
+
+uint64_t sdMicroseconds( void )
+{
+#ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+    if( clock_gettime( CLOCK_MONOTONIC, &ts ) == 0 )
+    {
+        return ((uint64_t) ts.tv_sec * 1000000) + ((uint64_t) ts.tv_nsec / 1000);
+    }
+#endif
+    {
+        struct timeval tv;
+        gettimeofday( &tv, NULL );
+        return ((uint64_t) tv.tv_sec * 1000000) + (uint64_t) tv.tv_usec;
+    }
+}
+
+/****************************************************/
+void *sdMapFile( const char *FileName, int Writable, cell_t *LenPtr )
+{
+    struct stat info;
+    void *addr = NULL;
+    int fd = open( FileName, Writable ? O_RDWR : O_RDONLY );
+    *LenPtr = -1;
+    if( fd < 0 ) return NULL;
+    if( fstat( fd, &info ) == 0 )
+    {
+        *LenPtr = (cell_t) info.st_size;
+        if( info.st_size > 0 )
+        {
+            addr = mmap( NULL, (size_t) info.st_size,
+                         Writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                         MAP_SHARED, fd, 0 );
+            if( addr == MAP_FAILED )
+            {
+                addr = NULL;
+                *LenPtr = -1;
+            }
+        }
+    }
+    close( fd ); /* The map keeps the file open. */
+    return addr;
+}
+
+cell_t sdUnmapFile( void *Address, cell_t Length )
+{
+    if( Length == 0 ) return 0;
+    return munmap( Address, (size_t) Length );
+}
+
+/* Part of a map may be synced so round the start down to a page. */
+cell_t sdSyncMapped( void *Address, cell_t Length )
+{
+    ucell_t pageMask = (ucell_t) sysconf( _SC_PAGESIZE ) - 1;
+    ucell_t start = ((ucell_t) Address) & ~pageMask;
+    if( Length == 0 ) return 0;
+    return msync( (void *) start, (size_t) (((ucell_t) Address - start) + Length), MS_SYNC );
+}
+
+#ifdef PF_SUPPORT_THREADS
+/****************************************************/
+static pthread_mutex_t gLocks[PF_NUM_LOCKS] = {
+    PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_MUTEX_INITIALIZER
+};
+static pthread_cond_t gConditions[PF_NUM_LOCKS] = {
+    PTHREAD_COND_INITIALIZER,
+    PTHREAD_COND_INITIALIZER,
+    PTHREAD_COND_INITIALIZER,
+    PTHREAD_COND_INITIALIZER,
+    PTHREAD_COND_INITIALIZER
+};
+
+void sdLock( int Which )
+{
+    pthread_mutex_lock( &gLocks[Which] );
+}
+
+void sdUnlock( int Which )
+{
+    pthread_mutex_unlock( &gLocks[Which] );
+}
+
+void sdWaitCondition( int Which )
+{
+    pthread_cond_wait( &gConditions[Which], &gLocks[Which] );
+}
+
+/* Wake every thread waiting on the condition. */
+void sdSignalCondition( int Which )
+{
+    pthread_cond_broadcast( &gConditions[Which] );
+}
+
+void sdYieldThread( void )
+{
+    sched_yield();
+}
+
+cell_t sdNumProcessors( void )
+{
+    long num = sysconf( _SC_NPROCESSORS_ONLN );
+    return (num < 1) ? 1 : (cell_t) num;
+}
+
+cell_t sdCreateThread( void *(*Func)( void * ), void *Arg )
+{
+    pthread_t *thread = (pthread_t *) pfAllocMem( sizeof(pthread_t) );
+    if( thread == NULL ) return 0;
+    if( pthread_create( thread, NULL, Func, Arg ) != 0 )
+    {
+        pfFreeMem( thread );
+        return 0;
+    }
+    return (cell_t) thread;
+}
+
+cell_t sdJoinThread( cell_t Thread )
+{
+    pthread_t *thread = (pthread_t *) Thread;
+    int err = pthread_join( *thread, NULL );
+    pfFreeMem( thread );
+    return err ? -1 : 0;
+}
+#ifndef PF_NO_FILEIO
+/* Loop because pread() and pwrite() may transfer less than asked for. */
+cell_t sdReadFileAt( FileStream *Stream, void *Buffer, cell_t NumBytes, file_offset_t Offset )
+{
+    cell_t done = 0;
+    ssize_t num;
+    while( done < NumBytes )
+    {
+        num = pread( fileno( Stream ), (char *) Buffer + done, NumBytes - done, Offset + done );
+        if( num < 0 ) return -1;
+        if( num == 0 ) break; /* End of file. */
+        done += num;
+    }
+    return done;
+}
+
+cell_t sdWriteFileAt( FileStream *Stream, const void *Buffer, cell_t NumBytes, file_offset_t Offset )
+{
+    cell_t done = 0;
+    ssize_t num;
+    while( done < NumBytes )
+    {
+        num = pwrite( fileno( Stream ), (const char *) Buffer + done, NumBytes - done, Offset + done );
+        if( num <= 0 ) return -1;
+        done += num;
+    }
+    return done;
+}
+#endif /* PF_NO_FILEIO */
+#endif /* PF_SUPPORT_THREADS */
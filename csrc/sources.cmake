@@ -1,5 +1,8 @@
 sources.cmake
 pf_all.h
+pf_array.h
+pf_aio.h
+pf_chan.h
 pf_cglue.h
 pf_clib.h
 pf_core.h
@@ -9,6 +12,7 @@ pf_host.h
 pf_inc1.h
 pf_io.h
 pf_mem.h
+pf_pheap.h
 pf_save.h
 pf_text.h
 pf_types.h
@@ -18,12 +22,16 @@ pfcompfp.h
 pfcompil.h
 pfinnrfp.h
 pforth.h
+pf_array.c
+pf_aio.c
+pf_chan.c
 pf_cglue.c
 pf_clib.c
 pf_core.c
 pf_inner.c
 pf_io.c
 pf_mem.c
+pf_pheap.c
 pf_save.c
 pf_text.c
 pf_words.c
@@ -58,3 +58,30 @@ void sdTerminalTerm( void )
 {
 }
 
+/* Processor time is the best portable clock there is. */
+uint64_t sdMicroseconds( void )
+{
+    return (uint64_t) clock() * 1000000 / CLOCKS_PER_SEC;
+}
+
+/* ANSI C cannot map files. */
+void *sdMapFile( const char *FileName, int Writable, cell_t *LenPtr )
+{
+    (void) FileName;
+    (void) Writable;
+    *LenPtr = -1;
+    return NULL;
+}
+cell_t sdUnmapFile( void *Address, cell_t Length )
+{
+    (void) Address;
+    (void) Length;
+    return -1;
+}
+cell_t sdSyncMapped( void *Address, cell_t Length )
+{
+    (void) Address;
+    (void) Length;
+    return -1;
+}
+
@@ -25,6 +25,7 @@
 
 #include <conio.h>
 #include <synchapi.h>   /* for Sleep() */
+#include <windows.h>    /* for MapViewOfFile() */
 
 /* Use console mode I/O so that KEY and ?TERMINAL will work. */
 #if defined(WIN32) || defined(__NT__)
@@ -81,4 +82,54 @@ cell_t sdSleepMillis(cell_t msec)
     return 0;
 }
 
+uint64_t sdMicroseconds( void )
+{
+    LARGE_INTEGER count, freq;
+    QueryPerformanceCounter( &count );
+    QueryPerformanceFrequency( &freq );
+    return (uint64_t) ((count.QuadPart / freq.QuadPart) * 1000000 +
+                       ((count.QuadPart % freq.QuadPart) * 1000000) / freq.QuadPart);
+}
+
+/* Map a whole file with a file mapping object. */
+void *sdMapFile( const char *FileName, int Writable, cell_t *LenPtr )
+{
+    HANDLE file, mapping;
+    LARGE_INTEGER size;
+    void *addr = NULL;
+
+    *LenPtr = -1;
+    file = CreateFileA( FileName, Writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                        FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    if( file == INVALID_HANDLE_VALUE ) return NULL;
+    if( GetFileSizeEx( file, &size ) )
+    {
+        *LenPtr = (cell_t) size.QuadPart;
+        if( size.QuadPart > 0 )
+        {
+            mapping = CreateFileMappingA( file, NULL, Writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, NULL );
+            if( mapping != NULL )
+            {
+                addr = MapViewOfFile( mapping, Writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0 );
+                CloseHandle( mapping ); /* The view keeps the mapping open. */
+            }
+            if( addr == NULL ) *LenPtr = -1;
+        }
+    }
+    CloseHandle( file );
+    return addr;
+}
+
+cell_t sdUnmapFile( void *Address, cell_t Length )
+{
+    if( Length == 0 ) return 0;
+    return UnmapViewOfFile( Address ) ? 0 : -1;
+}
+
+cell_t sdSyncMapped( void *Address, cell_t Length )
+{
+    if( Length == 0 ) return 0;
+    return FlushViewOfFile( Address, (SIZE_T) Length ) ? 0 : -1;
+}
+
 #endif